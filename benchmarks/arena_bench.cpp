@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_opengles2.h>
+
+#include "benchmarks/arena_bench.hpp"
+#include "engine/buffer_arena.hpp"
+#include "engine/engine.hpp"
+#include "engine/gl_functions.hpp"
+#include "engine/vertex_layout.hpp"
+#include "engine/window.hpp"
+
+namespace arena_bench {
+    const std::string bench_name("arena");
+
+    // Small blocks, so a few thousand meshes spread over many of them.
+    const size_t block_size = 64 * 1024;
+
+    struct mesh {
+        std::vector<uint8_t> bytes;
+        arena_handle handle;
+        bool live;
+    };
+
+    double ticks_to_ms(uint64_t ticks) {
+        return ticks * 1000.0 / SDL_GetPerformanceFrequency();
+    }
+
+    // The space the arena sets aside; even an empty allocation takes one
+    // alignment unit.
+    size_t get_arena_size(size_t size) {
+        return (std::max(size, (size_t) 1) + buffer_arena::alignment - 1) & ~(buffer_arena::alignment - 1);
+    }
+
+    // Interleaved like square_grid's squares, with a vertex count and
+    // contents that differ per mesh so a misplaced copy can't go unnoticed.
+    // Every 31st mesh is empty, which packs to no bytes at all.
+    std::vector<uint8_t> make_mesh(const vertex_layout &layout, int index) {
+        int vertex_count = index % 31;
+        std::vector<float> positions;
+        std::vector<float> colors;
+        for (int v = 0; v < vertex_count; v++) {
+            positions.push_back(sinf(index * 0.1f + v));
+            positions.push_back(cosf(index * 0.1f + v));
+            for (int c = 0; c < 4; c++) {
+                colors.push_back(fmodf(index * 0.01f + v * 0.1f + c * 0.25f, 1.0f));
+            }
+        }
+        return layout.pack({positions, colors}, vertex_count);
+    }
+
+    void print_stats(const std::string &label, const arena_stats &stats) {
+        std::cout << std::left << std::setw(8) << label << std::right << "  " << stats.blocks << " blocks, "
+            << stats.allocations << " allocations, " << stats.used_bytes << " of " << stats.reserved_bytes
+            << " bytes used, " << stats.free_ranges << " free ranges (largest " << stats.largest_free_range
+            << " bytes)" << std::endl;
+    }
+
+    // Every live mesh must read back unchanged, at an aligned offset, and
+    // no two may overlap in the same buffer. With packed set, each buffer's
+    // allocations must also sit back to back from offset 0, as defragment()
+    // leaves them. Returns what went wrong, or an empty string.
+    std::string check(const buffer_arena &arena, const std::vector<mesh> &meshes, bool packed) {
+        std::map<uint32_t, std::vector<std::pair<size_t, size_t>>> ranges;
+        for (size_t i = 0; i < meshes.size(); i++) {
+            const mesh &m = meshes[i];
+            if (!m.live) {
+                continue;
+            }
+            size_t offset = arena.get_offset(m.handle);
+            if (offset % buffer_arena::alignment != 0) {
+                return "mesh " + std::to_string(i) + " is at unaligned offset " + std::to_string(offset);
+            }
+            if (memcmp(arena.get_data(m.handle), m.bytes.data(), m.bytes.size()) != 0) {
+                return "mesh " + std::to_string(i) + " doesn't read back what was written";
+            }
+            ranges[arena.get_buffer_id(m.handle)].push_back({offset, get_arena_size(m.bytes.size())});
+        }
+
+        for (auto &buffer : ranges) {
+            std::sort(buffer.second.begin(), buffer.second.end());
+            size_t end = 0;
+            for (const auto &range : buffer.second) {
+                if (range.first < end || (packed && range.first != end)) {
+                    return "buffer " + std::to_string(buffer.first) + " has an allocation at " + std::to_string(range.first)
+                        + " where the previous one ends at " + std::to_string(end);
+                }
+                end = range.first + range.second;
+            }
+        }
+        return "";
+    }
+
+    int run(int argc, char **argv) {
+        int count = 20000;
+        for (int i = 2; i < argc; i++) {
+            std::string arg(argv[i]);
+            if (arg == "--count" && i + 1 < argc) {
+                count = atoi(argv[++i]);
+            }
+        }
+        if (count <= 0) {
+            std::cerr << "error: --count needs a positive value" << std::endl;
+            return 2;
+        }
+
+        engine e(argc, argv);
+        window main_window;
+
+        vertex_layout layout;
+        layout.append("position", 2, GL_SHORT, GL_TRUE);
+        layout.append("color", 4, GL_UNSIGNED_BYTE, GL_TRUE);
+
+        if (!make_mesh(layout, 0).empty()) {
+            std::cerr << "error: packing no vertices gave " << make_mesh(layout, 0).size() << " bytes" << std::endl;
+            return 1;
+        }
+
+        buffer_arena arena(GL_ARRAY_BUFFER, block_size);
+        std::vector<mesh> meshes(count);
+        uint64_t start = SDL_GetPerformanceCounter();
+        for (int i = 0; i < count; i++) {
+            meshes[i].bytes = make_mesh(layout, i);
+            meshes[i].handle = arena.allocate(meshes[i].bytes.data(), meshes[i].bytes.size());
+            meshes[i].live = true;
+        }
+        glFinish();
+        double allocate_ms = ticks_to_ms(SDL_GetPerformanceCounter() - start);
+
+        // Every other mesh leaves holes in each block; the whole last
+        // quarter going away leaves blocks with nothing in them.
+        for (int i = 0; i < count; i++) {
+            if (i % 2 == 1 || i >= count - count / 4) {
+                arena.free(meshes[i].handle);
+                meshes[i].live = false;
+            }
+        }
+
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "benchmark:  " << bench_name << " (" << count << " meshes, " << block_size << " byte blocks)" << std::endl;
+        std::cout << "allocate:   " << allocate_ms << " ms" << std::endl;
+        print_stats("before", arena.get_stats());
+        std::string error = check(arena, meshes, false);
+        if (!error.empty()) {
+            std::cerr << "error: arena check failed before defragmenting: " << error << std::endl;
+            return 1;
+        }
+
+        start = SDL_GetPerformanceCounter();
+        arena.defragment();
+        glFinish();
+        double defragment_ms = ticks_to_ms(SDL_GetPerformanceCounter() - start);
+        print_stats("after", arena.get_stats());
+        std::cout << "defragment: " << defragment_ms << " ms" << std::endl;
+        error = check(arena, meshes, true);
+        if (!error.empty()) {
+            std::cerr << "error: arena check failed after defragmenting: " << error << std::endl;
+            return 1;
+        }
+
+        // The freed meshes go back into the space defragment() gathered.
+        for (int i = 0; i < count; i++) {
+            if (!meshes[i].live) {
+                meshes[i].handle = arena.allocate(meshes[i].bytes.data(), meshes[i].bytes.size());
+                meshes[i].live = true;
+            }
+        }
+        print_stats("refilled", arena.get_stats());
+        error = check(arena, meshes, false);
+        if (!error.empty()) {
+            std::cerr << "error: arena check failed after refilling: " << error << std::endl;
+            return 1;
+        }
+        std::cout << "check:      ok" << std::endl;
+
+        return 0;
+    }
+}
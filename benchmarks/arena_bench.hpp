@@ -0,0 +1,11 @@
+#ifndef ARENA_BENCH_HPP_
+#define ARENA_BENCH_HPP_
+
+#include <string>
+
+namespace arena_bench {
+    extern const std::string bench_name;
+    int run(int argc, char **argv);
+}
+
+#endif // ARENA_BENCH_HPP_
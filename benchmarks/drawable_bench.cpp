@@ -0,0 +1,226 @@
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <SDL2/SDL.h>
+
+#include "benchmarks/drawable_bench.hpp"
+#include "engine/drawable.hpp"
+#include "engine/drawable_store.hpp"
+
+namespace drawable_bench {
+    const std::string bench_name("drawables");
+
+    const float wobble = 0.001f;
+
+    // Stands in for a drawable in the old std::list<std::shared_ptr<drawable>>,
+    // back when drawables held their own offsets: everything the drawable
+    // carries, with the offsets behind it, so touching them pulls in a cache
+    // line per entry.
+    struct legacy_entry {
+        uint8_t payload[sizeof(drawable)];
+        float offset_x;
+        float offset_y;
+        float offset_z;
+    };
+
+    // Counts last-level cache misses of this thread through perf_event_open;
+    // reports -1 where the counter isn't available (other platforms,
+    // containers, perf_event_paranoid).
+    class miss_counter {
+    protected:
+        int fd;
+    public:
+        miss_counter() : fd(-1) {
+#ifdef __linux__
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            this->fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+        }
+        miss_counter(miss_counter const &) = delete;
+        ~miss_counter() {
+#ifdef __linux__
+            if (this->fd >= 0) {
+                close(this->fd);
+            }
+#endif
+        }
+        void operator=(miss_counter const &) = delete;
+
+        bool is_available() const {
+            return this->fd >= 0;
+        }
+
+        void start() {
+#ifdef __linux__
+            if (this->fd >= 0) {
+                ioctl(this->fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(this->fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+        }
+
+        int64_t stop() {
+#ifdef __linux__
+            int64_t misses;
+            if (this->fd >= 0) {
+                ioctl(this->fd, PERF_EVENT_IOC_DISABLE, 0);
+                if (read(this->fd, &misses, sizeof(misses)) == sizeof(misses)) {
+                    return misses;
+                }
+            }
+#endif
+            return -1;
+        }
+    };
+
+    struct result {
+        double ns_per_entry;
+        double misses_per_entry;
+    };
+
+    template<typename F>
+    result measure(miss_counter &counter, size_t count, int passes, F pass) {
+        counter.start();
+        uint64_t start = SDL_GetPerformanceCounter();
+        for (int i = 0; i < passes; i++) {
+            pass();
+        }
+        uint64_t ticks = SDL_GetPerformanceCounter() - start;
+        int64_t misses = counter.stop();
+
+        double entries = (double) count * passes;
+        result r;
+        r.ns_per_entry = ticks * 1e9 / SDL_GetPerformanceFrequency() / entries;
+        r.misses_per_entry = misses >= 0 ? misses / entries : -1.0;
+        return r;
+    }
+
+    std::string format_misses(double misses_per_entry) {
+        return misses_per_entry >= 0.0 ? std::to_string(misses_per_entry) : "n/a";
+    }
+
+    std::string format_json_misses(double misses_per_entry) {
+        return misses_per_entry >= 0.0 ? std::to_string(misses_per_entry) : "null";
+    }
+
+    int run(int argc, char **argv) {
+        int count = 1000000;
+        int passes = 10;
+        for (int i = 2; i < argc; i++) {
+            std::string arg(argv[i]);
+            if (arg == "--count" && i + 1 < argc) {
+                count = atoi(argv[++i]);
+            } else if (arg == "--passes" && i + 1 < argc) {
+                passes = atoi(argv[++i]);
+            }
+        }
+        if (count <= 0 || passes <= 0) {
+            std::cerr << "error: --count and --passes need positive values" << std::endl;
+            return 2;
+        }
+
+        // The list is linked in shuffled allocation order, as it ends up
+        // after drawables have come and gone for a while.
+        std::vector<std::shared_ptr<legacy_entry>> entries;
+        entries.reserve(count);
+        for (int i = 0; i < count; i++) {
+            entries.push_back(std::make_shared<legacy_entry>());
+            entries.back()->offset_x = i * 1e-6f;
+            entries.back()->offset_y = 0.0f;
+            entries.back()->offset_z = 0.0f;
+        }
+        std::shuffle(entries.begin(), entries.end(), std::mt19937(1));
+        std::list<std::shared_ptr<legacy_entry>> legacy_list(entries.begin(), entries.end());
+        entries.clear();
+
+        // Entries without drawables: the benchmark only walks the dense
+        // arrays, which needs no GL context.
+        drawable_store store;
+        store.reserve(count);
+        for (int i = 0; i < count; i++) {
+            store.add(nullptr, {i * 1e-6f, 0.0f, 0.0f});
+        }
+
+        miss_counter counter;
+        float sink = 0.0f;
+
+        result list_iterate = measure(counter, count, passes, [&]() {
+            float sum = 0.0f;
+            for (const auto &e : legacy_list) {
+                sum += e->offset_x + e->offset_y + e->offset_z;
+            }
+            sink += sum;
+        });
+        result store_iterate = measure(counter, count, passes, [&]() {
+            const float *x = store.get_offset_x();
+            const float *y = store.get_offset_y();
+            const float *z = store.get_offset_z();
+            float sum = 0.0f;
+            for (size_t i = 0; i < store.size(); i++) {
+                sum += x[i] + y[i] + z[i];
+            }
+            sink += sum;
+        });
+        result list_update = measure(counter, count, passes, [&]() {
+            for (const auto &e : legacy_list) {
+                e->offset_y += wobble;
+            }
+        });
+        result store_update = measure(counter, count, passes, [&]() {
+            float *y = store.get_offset_y();
+            for (size_t i = 0; i < store.size(); i++) {
+                y[i] += wobble;
+            }
+        });
+        sink += legacy_list.front()->offset_y + store.get_offset_y()[0];
+
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "benchmark:  " << bench_name << " (" << count << " entries, " << passes << " passes, "
+            << sizeof(legacy_entry) << " bytes per list entry)" << std::endl;
+        if (!counter.is_available()) {
+            std::cout << "cache misses: unavailable (needs perf_event_open on Linux)" << std::endl;
+        }
+        std::cout << "iterate:    list " << list_iterate.ns_per_entry << " ns, " << format_misses(list_iterate.misses_per_entry)
+            << " misses; store " << store_iterate.ns_per_entry << " ns, " << format_misses(store_iterate.misses_per_entry)
+            << " misses (per entry)" << std::endl;
+        std::cout << "update:     list " << list_update.ns_per_entry << " ns, " << format_misses(list_update.misses_per_entry)
+            << " misses; store " << store_update.ns_per_entry << " ns, " << format_misses(store_update.misses_per_entry)
+            << " misses (per entry)" << std::endl;
+        std::cout << "{\"benchmark\": \"" << bench_name << "\", \"count\": " << count << ", \"passes\": " << passes
+            << ", \"iterate\": {\"list_ns\": " << list_iterate.ns_per_entry
+            << ", \"list_misses\": " << format_json_misses(list_iterate.misses_per_entry)
+            << ", \"store_ns\": " << store_iterate.ns_per_entry
+            << ", \"store_misses\": " << format_json_misses(store_iterate.misses_per_entry) << "}"
+            << ", \"update\": {\"list_ns\": " << list_update.ns_per_entry
+            << ", \"list_misses\": " << format_json_misses(list_update.misses_per_entry)
+            << ", \"store_ns\": " << store_update.ns_per_entry
+            << ", \"store_misses\": " << format_json_misses(store_update.misses_per_entry) << "}"
+            << ", \"checksum\": " << sink << "}" << std::endl;
+
+        return 0;
+    }
+}
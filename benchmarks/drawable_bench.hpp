@@ -0,0 +1,11 @@
+#ifndef DRAWABLE_BENCH_HPP_
+#define DRAWABLE_BENCH_HPP_
+
+#include <string>
+
+namespace drawable_bench {
+    extern const std::string bench_name;
+    int run(int argc, char **argv);
+}
+
+#endif // DRAWABLE_BENCH_HPP_
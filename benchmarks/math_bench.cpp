@@ -0,0 +1,158 @@
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <SDL2/SDL.h>
+
+#include "benchmarks/math_bench.hpp"
+#include "engine/math.hpp"
+
+namespace math_bench {
+    const std::string bench_name("math");
+
+    // Multiply-adds per vertex in perspective_cube's vertex shader: three
+    // mat4 * vec4 products (16 mul + 12 add each) plus two vec4 offset
+    // additions before the MVP uniform, one product after.
+    const int chained_flops_per_vertex = 3 * 28 + 2 * 4;
+    const int composed_flops_per_vertex = 28;
+
+    const size_t vertex_count = 4096;
+
+    struct timer {
+        uint64_t start = SDL_GetPerformanceCounter();
+
+        double elapsed_ns() const {
+            uint64_t ticks = SDL_GetPerformanceCounter() - this->start;
+            return ticks * 1e9 / SDL_GetPerformanceFrequency();
+        }
+    };
+
+    // Folded into the output so the compiler can't drop the measured loops.
+    float checksum(const vec4 *v, size_t count) {
+        float sum = 0.0f;
+        for (size_t i = 0; i < count; i++) {
+            sum += v[i].x + v[i].y + v[i].z + v[i].w;
+        }
+        return sum;
+    }
+
+    double time_multiply(bool simd, int iterations, float *sink) {
+        mat4 rotation = mat4_rotation_y(0.001f) * mat4_rotation_z(0.002f);
+        mat4 m = mat4_identity();
+        timer t;
+        for (int i = 0; i < iterations; i++) {
+            m = simd ? m * rotation : mat4_multiply_scalar(m, rotation);
+        }
+        double ns = t.elapsed_ns();
+        *sink += checksum(m.columns, 4);
+        return ns / iterations;
+    }
+
+    double time_transform(bool simd, int iterations, const std::vector<vec4> &in, std::vector<vec4> &out, float *sink) {
+        mat4 m = mat4_perspective(2.0f, 0.1f, 10.0f) * mat4_translation(0.0f, 0.0f, -2.0f);
+        timer t;
+        for (int i = 0; i < iterations; i++) {
+            if (simd) {
+                transform_vec4s(m, in.data(), out.data(), in.size());
+            } else {
+                transform_vec4s_scalar(m, in.data(), out.data(), in.size());
+            }
+        }
+        double ns = t.elapsed_ns();
+        *sink += checksum(out.data(), out.size());
+        return ns / iterations / in.size();
+    }
+
+    // CPU stand-in for the old vertex shader: the full matrix chain for
+    // every vertex, against one pre-composed MVP product.
+    double time_chained(int iterations, const std::vector<vec4> &in, std::vector<vec4> &out, float *sink) {
+        const mat4 perspective = mat4_perspective(2.0f, 0.1f, 10.0f);
+        const mat4 y_rotation = mat4_rotation_y(0.5f);
+        const mat4 z_rotation = mat4_rotation_z(0.25f);
+        const vec4 object_offset = {0.0f, 0.0f, -2.0f, 0.0f};
+        const vec4 camera_offset = {0.1f, 0.0f, 0.2f, 0.0f};
+        timer t;
+        for (int i = 0; i < iterations; i++) {
+            for (size_t v = 0; v < in.size(); v++) {
+                vec4 camera_position = (y_rotation * (z_rotation * in[v])) + object_offset + camera_offset;
+                out[v] = perspective * camera_position;
+            }
+        }
+        double ns = t.elapsed_ns();
+        *sink += checksum(out.data(), out.size());
+        return ns / iterations / in.size();
+    }
+
+    double time_composed(int iterations, const std::vector<vec4> &in, std::vector<vec4> &out, float *sink) {
+        const vec4 offset = vec4{0.0f, 0.0f, -2.0f, 0.0f} + vec4{0.1f, 0.0f, 0.2f, 0.0f};
+        timer t;
+        for (int i = 0; i < iterations; i++) {
+            mat4 mvp = mat4_perspective(2.0f, 0.1f, 10.0f)
+                * mat4_translation(offset.x, offset.y, offset.z)
+                * mat4_rotation_y(0.5f)
+                * mat4_rotation_z(0.25f);
+            transform_vec4s(mvp, in.data(), out.data(), in.size());
+        }
+        double ns = t.elapsed_ns();
+        *sink += checksum(out.data(), out.size());
+        return ns / iterations / in.size();
+    }
+
+    int run(int argc, char **argv) {
+        int iterations = 1000;
+        for (int i = 2; i < argc; i++) {
+            std::string arg(argv[i]);
+            if (arg == "--iterations" && i + 1 < argc) {
+                iterations = atoi(argv[++i]);
+                if (iterations <= 0) {
+                    std::cerr << "error: invalid iteration count " << argv[i] << std::endl;
+                    return 2;
+                }
+            }
+        }
+
+        std::vector<vec4> in(vertex_count);
+        std::vector<vec4> out(vertex_count);
+        for (size_t v = 0; v < vertex_count; v++) {
+            in[v] = {(v % 7) * 0.1f - 0.3f, (v % 5) * 0.1f - 0.2f, (v % 3) * 0.1f - 0.1f, 1.0f};
+        }
+
+        float sink = 0.0f;
+        double multiply_scalar = time_multiply(false, iterations * 1000, &sink);
+        double multiply_simd = time_multiply(true, iterations * 1000, &sink);
+        double transform_scalar = time_transform(false, iterations, in, out, &sink);
+        double transform_simd = time_transform(true, iterations, in, out, &sink);
+        double chained = time_chained(iterations, in, out, &sink);
+        double composed = time_composed(iterations, in, out, &sink);
+
+#if defined(ENGINE_MATH_SSE2)
+        const char *simd_name = "sse2";
+#elif defined(ENGINE_MATH_NEON)
+        const char *simd_name = "neon";
+#else
+        const char *simd_name = "none (scalar fallback)";
+#endif
+
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "benchmark:  " << bench_name << " (simd " << simd_name << ")" << std::endl;
+        std::cout << "mat4 * mat4: scalar " << multiply_scalar << " ns, simd " << multiply_simd << " ns ("
+            << multiply_scalar / multiply_simd << "x)" << std::endl;
+        std::cout << "mat4 * vec4: scalar " << transform_scalar << " ns, simd " << transform_simd << " ns ("
+            << transform_scalar / transform_simd << "x)" << std::endl;
+        std::cout << "per vertex:  chained " << chained << " ns (" << chained_flops_per_vertex << " flops), composed "
+            << composed << " ns (" << composed_flops_per_vertex << " flops)" << std::endl;
+        std::cout << "{\"benchmark\": \"" << bench_name << "\", \"simd\": \"" << simd_name << "\""
+            << ", \"mat4_multiply_ns\": {\"scalar\": " << multiply_scalar << ", \"simd\": " << multiply_simd << "}"
+            << ", \"mat4_transform_ns\": {\"scalar\": " << transform_scalar << ", \"simd\": " << transform_simd << "}"
+            << ", \"per_vertex_ns\": {\"chained\": " << chained << ", \"composed\": " << composed << "}"
+            << ", \"per_vertex_flops\": {\"chained\": " << chained_flops_per_vertex
+            << ", \"composed\": " << composed_flops_per_vertex << "}"
+            << ", \"checksum\": " << sink << "}" << std::endl;
+
+        return 0;
+    }
+}
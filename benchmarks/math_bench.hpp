@@ -0,0 +1,11 @@
+#ifndef MATH_BENCH_HPP_
+#define MATH_BENCH_HPP_
+
+#include <string>
+
+namespace math_bench {
+    extern const std::string bench_name;
+    int run(int argc, char **argv);
+}
+
+#endif // MATH_BENCH_HPP_
@@ -0,0 +1,170 @@
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_opengles2.h>
+
+#include "benchmarks/mesh_bench.hpp"
+#include "engine/engine.hpp"
+#include "engine/gl_functions.hpp"
+#include "engine/index_buffer.hpp"
+#include "engine/mesh_file.hpp"
+#include "engine/obj_parser.hpp"
+#include "engine/vertex_buffer.hpp"
+#include "engine/window.hpp"
+
+namespace mesh_bench {
+    const std::string bench_name("mesh");
+
+    struct result {
+        double load_ms;
+        double upload_ms;
+    };
+
+    double ticks_to_ms(uint64_t ticks) {
+        return ticks * 1000.0 / SDL_GetPerformanceFrequency();
+    }
+
+    // A wavy grid of quads, two triangles each, with normals so the parser
+    // goes through the same position/normal welding as real exports.
+    void write_grid_obj(const std::string &path, int triangles) {
+        const int side = (int) ceilf(sqrtf(triangles / 2.0f));
+        std::ofstream out(path);
+        if (!out) {
+            throw std::runtime_error("couldn't open \"" + path + "\"");
+        }
+        out << std::fixed << std::setprecision(6);
+        for (int y = 0; y <= side; y++) {
+            for (int x = 0; x <= side; x++) {
+                float u = (float) x / side * 2.0f - 1.0f;
+                float v = (float) y / side * 2.0f - 1.0f;
+                out << "v " << u << " " << v << " " << 0.1f * sinf(u * 8.0f) * cosf(v * 8.0f) << "\n";
+            }
+        }
+        out << "vn 0 0 1\n";
+        int written = 0;
+        for (int y = 0; y < side && written < triangles; y++) {
+            for (int x = 0; x < side && written < triangles; x++) {
+                int a = y * (side + 1) + x + 1;
+                int b = a + 1;
+                int c = a + side + 1;
+                int d = c + 1;
+                out << "f " << a << "//1 " << b << "//1 " << d << "//1\n";
+                written++;
+                if (written < triangles) {
+                    out << "f " << a << "//1 " << d << "//1 " << c << "//1\n";
+                    written++;
+                }
+            }
+        }
+        if (!out) {
+            throw std::runtime_error("couldn't write \"" + path + "\"");
+        }
+    }
+
+    result measure_text(const std::string &path) {
+        result r;
+        uint64_t start = SDL_GetPerformanceCounter();
+        obj_mesh mesh = parse_obj(path);
+        uint64_t loaded = SDL_GetPerformanceCounter();
+        vertex_buffer vertices(mesh.vertices.data(), mesh.vertices.size());
+        index_buffer indices(mesh.indices);
+        glFinish();
+        uint64_t uploaded = SDL_GetPerformanceCounter();
+        r.load_ms = ticks_to_ms(loaded - start);
+        r.upload_ms = ticks_to_ms(uploaded - loaded);
+        return r;
+    }
+
+    result measure_binary(const std::string &path) {
+        result r;
+        uint64_t start = SDL_GetPerformanceCounter();
+        mapped_mesh mesh(path);
+        uint64_t loaded = SDL_GetPerformanceCounter();
+        vertex_buffer vertices(mesh.get_vertex_data(), mesh.get_vertex_bytes());
+        index_buffer indices(mesh.get_index_data(), mesh.get_index_type(), mesh.get_index_count());
+        glFinish();
+        uint64_t uploaded = SDL_GetPerformanceCounter();
+        r.load_ms = ticks_to_ms(loaded - start);
+        r.upload_ms = ticks_to_ms(uploaded - loaded);
+        return r;
+    }
+
+    // The best of several runs; both files are in the page cache by then,
+    // so this compares parsing against mapping rather than disk speed.
+    template <typename F>
+    result best_of(int runs, F measure) {
+        result best = measure();
+        for (int i = 1; i < runs; i++) {
+            result r = measure();
+            if (r.load_ms + r.upload_ms < best.load_ms + best.upload_ms) {
+                best = r;
+            }
+        }
+        return best;
+    }
+
+    int run(int argc, char **argv) {
+        int triangles = 1000000;
+        int runs = 3;
+        const char *tmpdir = getenv("TMPDIR");
+        std::string directory = tmpdir ? tmpdir : "/tmp";
+        for (int i = 2; i < argc; i++) {
+            std::string arg(argv[i]);
+            if (arg == "--triangles" && i + 1 < argc) {
+                triangles = atoi(argv[++i]);
+            } else if (arg == "--runs" && i + 1 < argc) {
+                runs = atoi(argv[++i]);
+            } else if (arg == "--dir" && i + 1 < argc) {
+                directory = argv[++i];
+            }
+        }
+        if (triangles <= 0 || runs <= 0) {
+            std::cerr << "error: --triangles and --runs need positive values" << std::endl;
+            return 2;
+        }
+
+        const std::string obj_path = directory + "/opengl-es-test-mesh-bench.obj";
+        const std::string mesh_path = directory + "/opengl-es-test-mesh-bench.mesh";
+        write_grid_obj(obj_path, triangles);
+        {
+            obj_mesh mesh = parse_obj(obj_path);
+            write_mesh_file(mesh_path, mesh.layout, mesh.vertices, mesh.vertex_count, mesh.indices, mesh.bounds);
+        }
+
+        engine e(argc, argv);
+        window main_window;
+
+        result text = best_of(runs, [&]() { return measure_text(obj_path); });
+        result binary = best_of(runs, [&]() { return measure_binary(mesh_path); });
+
+        std::ifstream obj_file(obj_path, std::ios::binary | std::ios::ate);
+        std::ifstream mesh_file(mesh_path, std::ios::binary | std::ios::ate);
+        double obj_mb = obj_file.tellg() / (1024.0 * 1024.0);
+        double mesh_mb = mesh_file.tellg() / (1024.0 * 1024.0);
+        remove(obj_path.c_str());
+        remove(mesh_path.c_str());
+
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "benchmark:  " << bench_name << " (" << triangles << " triangles, best of " << runs << ")" << std::endl;
+        std::cout << "obj text:   " << text.load_ms << " ms parse, " << text.upload_ms << " ms upload (" << obj_mb << " MB)"
+            << std::endl;
+        std::cout << "mesh mmap:  " << binary.load_ms << " ms map, " << binary.upload_ms << " ms upload (" << mesh_mb << " MB)"
+            << std::endl;
+        std::cout << "speedup:    " << (text.load_ms + text.upload_ms) / (binary.load_ms + binary.upload_ms) << "x" << std::endl;
+        std::cout << "{\"benchmark\": \"" << bench_name << "\", \"triangles\": " << triangles << ", \"runs\": " << runs
+            << ", \"obj\": {\"load_ms\": " << text.load_ms << ", \"upload_ms\": " << text.upload_ms << ", \"megabytes\": " << obj_mb << "}"
+            << ", \"mesh\": {\"load_ms\": " << binary.load_ms << ", \"upload_ms\": " << binary.upload_ms
+            << ", \"megabytes\": " << mesh_mb << "}}" << std::endl;
+
+        return 0;
+    }
+}
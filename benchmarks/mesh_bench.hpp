@@ -0,0 +1,11 @@
+#ifndef MESH_BENCH_HPP_
+#define MESH_BENCH_HPP_
+
+#include <string>
+
+namespace mesh_bench {
+    extern const std::string bench_name;
+    int run(int argc, char **argv);
+}
+
+#endif // MESH_BENCH_HPP_
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_opengles2.h>
+
+#include "benchmarks/stream_bench.hpp"
+#include "engine/engine.hpp"
+#include "engine/gl_functions.hpp"
+#include "engine/gl_state.hpp"
+#include "engine/shader_program.hpp"
+#include "engine/vertex_buffer.hpp"
+#include "engine/window.hpp"
+
+namespace stream_bench {
+    const std::string bench_name("stream");
+
+    const char *vertex_shader_source = R"glsl(
+#version 100
+
+attribute vec4 position;
+
+void main() {
+    gl_Position = position;
+}
+)glsl";
+
+    const char *fragment_shader_source = R"glsl(
+#version 100
+
+precision mediump float;
+
+void main() {
+   gl_FragColor = vec4(1.0, 1.0, 1.0, 1.0);
+}
+)glsl";
+
+    struct strategy {
+        const char *name;
+        buffer_update update_mode;
+        int ring_depth;
+    };
+
+    const strategy strategies[] = {
+        {"sub_data", buffer_update::sub_data, 1},
+        {"orphan", buffer_update::orphan, 1},
+        {"ring3", buffer_update::ring, 3},
+        {"map", buffer_update::map, 1},
+    };
+
+    struct result {
+        double upload_ms;
+        double frame_ms;
+        double megabytes_per_second;
+    };
+
+    double ticks_to_ms(uint64_t ticks) {
+        return ticks * 1000.0 / SDL_GetPerformanceFrequency();
+    }
+
+    // Every frame rewrites the whole buffer and then draws from it, so the
+    // GPU is still reading one frame's data when the next upload starts;
+    // that is where the strategies differ.
+    result measure(window &main_window, uint32_t position_attrib, const strategy &s, std::vector<float> &data, int frames) {
+        const size_t size = data.size() * sizeof(float);
+        vertex_buffer stream(size, buffer_usage::stream_draw, s.update_mode, s.ring_depth);
+        gl_state &state = get_gl_state();
+
+        uint64_t upload_ticks = 0;
+        glFinish();
+        uint64_t start = SDL_GetPerformanceCounter();
+        for (int frame = 0; frame < frames; frame++) {
+            SDL_Event event;
+            while (SDL_PollEvent(&event)) {
+            }
+
+            data[0] = frame * 1e-6f;
+            uint64_t upload_start = SDL_GetPerformanceCounter();
+            stream.update(data.data(), size);
+            upload_ticks += SDL_GetPerformanceCounter() - upload_start;
+
+            glClear(GL_COLOR_BUFFER_BIT);
+            state.enable_vertex_attrib(position_attrib);
+            state.vertex_attrib_pointer(position_attrib, 4, GL_FLOAT, GL_FALSE, 0, 0);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+            main_window.swap();
+        }
+        glFinish();
+        double total_ms = ticks_to_ms(SDL_GetPerformanceCounter() - start);
+
+        result r;
+        r.upload_ms = ticks_to_ms(upload_ticks) / frames;
+        r.frame_ms = total_ms / frames;
+        r.megabytes_per_second = total_ms > 0.0 ? (double) size * frames / (1024.0 * 1024.0) / (total_ms / 1000.0) : 0.0;
+        return r;
+    }
+
+    int run(int argc, char **argv) {
+        int frames = 60;
+        int megabytes = 10;
+        for (int i = 2; i < argc; i++) {
+            std::string arg(argv[i]);
+            if (arg == "--frames" && i + 1 < argc) {
+                frames = atoi(argv[++i]);
+            } else if (arg == "--megabytes" && i + 1 < argc) {
+                megabytes = atoi(argv[++i]);
+            }
+        }
+        if (frames <= 0 || megabytes <= 0) {
+            std::cerr << "error: --frames and --megabytes need positive values" << std::endl;
+            return 2;
+        }
+
+        engine e(argc, argv);
+        window main_window;
+        main_window.set_pacing(0.0, swap_mode::off);
+
+        shader_program program(vertex_shader_source, fragment_shader_source);
+        program.use();
+        uint32_t position_attrib = program.get_attrib_location("position");
+
+        // A few visible triangles at the front, the rest degenerate.
+        std::vector<float> data(megabytes * 1024 * 1024 / sizeof(float), 0.0f);
+        const float triangle[] = {-0.5f, -0.5f, 0.0f, 1.0f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.5f, 0.0f, 1.0f};
+        std::copy(triangle, triangle + 12, data.begin());
+
+        const char *gl_renderer = (const char*) glGetString(GL_RENDERER);
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "benchmark:  " << bench_name << " (" << megabytes << " MB/frame, " << frames << " frames, "
+            << (gl_renderer ? gl_renderer : "unknown") << ")" << std::endl;
+        std::cout << "mapbuffer:  " << (SDL_GL_ExtensionSupported("GL_OES_mapbuffer") ? "yes" : "no, map falls back to orphan")
+            << std::endl;
+
+        std::string json = "{\"benchmark\": \"" + bench_name + "\", \"megabytes_per_frame\": " + std::to_string(megabytes)
+            + ", \"frames\": " + std::to_string(frames) + ", \"strategies\": {";
+        bool first = true;
+        for (const auto &s : strategies) {
+            result r = measure(main_window, position_attrib, s, data, frames);
+            std::cout << std::left << std::setw(10) << s.name << std::right << "  " << r.megabytes_per_second
+                << " MB/s, " << r.frame_ms << " ms/frame (" << r.upload_ms << " ms in upload)" << std::endl;
+            json += std::string(first ? "" : ", ") + "\"" + s.name + "\": {\"mb_per_s\": "
+                + std::to_string(r.megabytes_per_second) + ", \"frame_ms\": " + std::to_string(r.frame_ms)
+                + ", \"upload_ms\": " + std::to_string(r.upload_ms) + "}";
+            first = false;
+        }
+        std::cout << json << "}}" << std::endl;
+
+        return 0;
+    }
+}
@@ -0,0 +1,11 @@
+#ifndef STREAM_BENCH_HPP_
+#define STREAM_BENCH_HPP_
+
+#include <string>
+
+namespace stream_bench {
+    extern const std::string bench_name;
+    int run(int argc, char **argv);
+}
+
+#endif // STREAM_BENCH_HPP_
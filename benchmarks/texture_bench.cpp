@@ -0,0 +1,130 @@
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <SDL2/SDL.h>
+
+#include "benchmarks/texture_bench.hpp"
+#include "engine/image.hpp"
+#include "engine/math.hpp"
+#include "engine/texture.hpp"
+#include "engine/texture_atlas.hpp"
+
+namespace texture_bench {
+    const std::string bench_name("textures");
+
+    const int atlas_page_size = 512;
+
+    struct timer {
+        uint64_t start = SDL_GetPerformanceCounter();
+        double elapsed_ms() const {
+            uint64_t ticks = SDL_GetPerformanceCounter() - this->start;
+            return ticks * 1000.0 / SDL_GetPerformanceFrequency();
+        }
+    };
+
+    image make_noise_image(int width, int height, uint32_t seed) {
+        image result = make_image(width, height, 4);
+        for (auto &channel : result.pixels) {
+            seed = seed * 1664525u + 1013904223u;
+            channel = seed >> 24;
+        }
+        return result;
+    }
+
+    // The whole chain down to 1x1, the way texture builds it.
+    double time_mip_chain(bool simd, const image &base, int iterations, std::vector<image> &levels) {
+        timer t;
+        for (int i = 0; i < iterations; i++) {
+            levels.clear();
+            const image *previous = &base;
+            while (previous->width > 1 || previous->height > 1) {
+                levels.push_back(simd ? downsample(*previous) : downsample_scalar(*previous));
+                previous = &levels.back();
+            }
+        }
+        return t.elapsed_ms() / iterations;
+    }
+
+    int run(int argc, char **argv) {
+        int size = 1024;
+        int iterations = 20;
+        int image_count = 2000;
+        for (int i = 2; i < argc; i++) {
+            std::string arg(argv[i]);
+            if (arg == "--size" && i + 1 < argc) {
+                size = atoi(argv[++i]);
+            } else if (arg == "--iterations" && i + 1 < argc) {
+                iterations = atoi(argv[++i]);
+            } else if (arg == "--images" && i + 1 < argc) {
+                image_count = atoi(argv[++i]);
+            }
+        }
+        if (size < 1 || iterations < 1 || image_count < 1) {
+            std::cerr << "error: --size, --iterations and --images need positive values" << std::endl;
+            return 2;
+        }
+
+        image base = make_noise_image(size, size, 1);
+        std::vector<image> scalar_levels;
+        std::vector<image> simd_levels;
+        double scalar_ms = time_mip_chain(false, base, iterations, scalar_levels);
+        double simd_ms = time_mip_chain(true, base, iterations, simd_levels);
+        bool identical = scalar_levels.size() == simd_levels.size();
+        for (size_t i = 0; identical && i < scalar_levels.size(); i++) {
+            identical = scalar_levels[i].pixels == simd_levels[i].pixels;
+        }
+
+        // Packing only; uploading the pages needs a GL context.
+        std::vector<image> sprites;
+        uint32_t seed = 7;
+        for (int i = 0; i < image_count; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            int width = 8 + (seed >> 16) % 57;
+            seed = seed * 1664525u + 1013904223u;
+            int height = 8 + (seed >> 16) % 57;
+            sprites.push_back(make_image(width, height, 4));
+        }
+        texture_atlas atlas(atlas_page_size, 2, mipmap_mode::none);
+        timer pack_timer;
+        for (const auto &sprite : sprites) {
+            atlas.add(sprite);
+        }
+        double pack_ms = pack_timer.elapsed_ms();
+        float occupancy = 0.0f;
+        for (int page = 0; page + 1 < atlas.get_page_count(); page++) {
+            occupancy += atlas.get_occupancy(page);
+        }
+        // The last page is only partly filled, so it is left out.
+        occupancy = atlas.get_page_count() > 1 ? occupancy / (atlas.get_page_count() - 1) : atlas.get_occupancy(0);
+
+#if defined(ENGINE_MATH_SSE2)
+        const char *simd_name = "sse2";
+#elif defined(ENGINE_MATH_NEON)
+        const char *simd_name = "neon";
+#else
+        const char *simd_name = "none (scalar fallback)";
+#endif
+        const double megapixels = (double) size * size / 1e6;
+
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "benchmark:  " << bench_name << " (simd " << simd_name << ")" << std::endl;
+        std::cout << "mip chain:  " << size << "x" << size << " scalar " << scalar_ms << " ms, simd " << simd_ms << " ms ("
+            << scalar_ms / simd_ms << "x, " << megapixels / (simd_ms / 1000.0) << " MP/s), "
+            << (identical ? "identical" : "DIFFERENT") << std::endl;
+        std::cout << "atlas:      " << image_count << " images in " << atlas.get_page_count() << " " << atlas_page_size
+            << "x" << atlas_page_size << " pages, " << pack_ms << " ms, " << occupancy * 100.0f << "% full" << std::endl;
+        std::cout << "{\"benchmark\": \"" << bench_name << "\", \"simd\": \"" << simd_name << "\""
+            << ", \"mip_chain_ms\": {\"size\": " << size << ", \"scalar\": " << scalar_ms << ", \"simd\": " << simd_ms
+            << ", \"identical\": " << (identical ? "true" : "false") << "}"
+            << ", \"atlas\": {\"images\": " << image_count << ", \"pages\": " << atlas.get_page_count()
+            << ", \"page_size\": " << atlas_page_size << ", \"pack_ms\": " << pack_ms << ", \"occupancy\": " << occupancy << "}}"
+            << std::endl;
+
+        return identical ? 0 : 1;
+    }
+}
@@ -0,0 +1,11 @@
+#ifndef TEXTURE_BENCH_HPP_
+#define TEXTURE_BENCH_HPP_
+
+#include <string>
+
+namespace texture_bench {
+    extern const std::string bench_name;
+    int run(int argc, char **argv);
+}
+
+#endif // TEXTURE_BENCH_HPP_
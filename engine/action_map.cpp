@@ -0,0 +1,88 @@
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <SDL2/SDL.h>
+
+#include "engine/action_map.hpp"
+
+action_map::action_map() {
+}
+
+// Actions are created on first lookup, so bindings for an action a module
+// doesn't know about are harmless.
+int action_map::get_action(const std::string &name) {
+    for (size_t i = 0; i < this->names.size(); i++) {
+        if (this->names[i] == name) {
+            return i;
+        }
+    }
+    this->names.push_back(name);
+    this->bindings.emplace_back();
+    return this->names.size() - 1;
+}
+
+void action_map::bind(const std::string &action, SDL_Scancode scancode) {
+    this->bindings[this->get_action(action)].push_back(scancode);
+}
+
+// Replaces the action's bindings with the comma-separated keys.
+void action_map::bind(const std::string &action, const std::string &key_names) {
+    std::vector<SDL_Scancode> scancodes;
+    std::istringstream names(key_names);
+    std::string name;
+    while (std::getline(names, name, ',')) {
+        SDL_Scancode scancode = SDL_GetScancodeFromName(name.c_str());
+        if (scancode == SDL_SCANCODE_UNKNOWN) {
+            throw std::runtime_error("unknown key \"" + name + "\" bound to " + action);
+        }
+        scancodes.push_back(scancode);
+    }
+    this->bindings[this->get_action(action)] = scancodes;
+}
+
+void action_map::parse_binding(const std::string &binding) {
+    size_t equals = binding.find('=');
+    if (equals == std::string::npos || equals == 0) {
+        throw std::runtime_error("invalid binding \"" + binding + "\", expected ACTION=KEY[,KEY...]");
+    }
+    this->bind(binding.substr(0, equals), binding.substr(equals + 1));
+}
+
+// One ACTION=KEY[,KEY...] per line; blank lines and lines starting with #
+// are skipped.
+void action_map::load(const std::string &path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("couldn't open \"" + path + "\"");
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        this->parse_binding(line);
+    }
+}
+
+void action_map::apply_options(int argc, char **argv) {
+    for (int i = 2; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == "--bindings" && i + 1 < argc) {
+            this->load(argv[++i]);
+        } else if (arg == "--bind" && i + 1 < argc) {
+            this->parse_binding(argv[++i]);
+        }
+    }
+}
+
+bool action_map::is_active(int action, const keyboard_state &keys) const {
+    for (const auto &scancode : this->bindings[action]) {
+        if (keys.is_pressed(scancode)) {
+            return true;
+        }
+    }
+    return false;
+}
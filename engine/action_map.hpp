@@ -0,0 +1,32 @@
+#ifndef ACTION_MAP_HPP_
+#define ACTION_MAP_HPP_
+
+#include <string>
+#include <vector>
+
+#include <SDL2/SDL.h>
+
+#include "engine/keyboard_state.hpp"
+
+// Named actions bound to any number of keys. Modules set their defaults
+// and look actions up once; --bind ACTION=KEY[,KEY...] and --bindings FILE
+// replace bindings without code changes. Key names are SDL's
+// (SDL_GetScancodeName), e.g. "Up", "W" or "Left Shift".
+class action_map {
+protected:
+    std::vector<std::string> names;
+    std::vector<std::vector<SDL_Scancode>> bindings;
+    void parse_binding(const std::string &binding);
+public:
+    action_map();
+    action_map(action_map const &) = delete;
+    void operator=(action_map const &) = delete;
+    int get_action(const std::string &name);
+    void bind(const std::string &action, SDL_Scancode scancode);
+    void bind(const std::string &action, const std::string &key_names);
+    void load(const std::string &path);
+    void apply_options(int argc, char **argv);
+    bool is_active(int action, const keyboard_state &keys) const;
+};
+
+#endif // ACTION_MAP_HPP_
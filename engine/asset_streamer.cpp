@@ -0,0 +1,178 @@
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <SDL2/SDL.h>
+
+#include "engine/asset_streamer.hpp"
+#include "engine/drawable.hpp"
+#include "engine/frame_stats.hpp"
+#include "engine/mesh_file.hpp"
+
+const size_t stream_queue_capacity = 256;
+const size_t default_stream_budget_bytes = 4 * 1024 * 1024;
+const double default_stream_budget_ms = 2.0;
+
+asset_streamer::asset_streamer()
+    : requests(stream_queue_capacity), loaded(stream_queue_capacity), stopping(false),
+      budget_bytes(default_stream_budget_bytes), budget_ms(default_stream_budget_ms), outstanding(0) {
+    this->io_thread = std::thread(&asset_streamer::io_loop, this);
+}
+
+// Assets still queued or loading are dropped without being uploaded.
+asset_streamer::~asset_streamer() {
+    {
+        std::lock_guard<std::mutex> lock(this->sleep_mutex);
+        this->stopping = true;
+    }
+    this->wake.notify_all();
+    this->io_thread.join();
+}
+
+void asset_streamer::set_budget(size_t bytes, double ms) {
+    this->budget_bytes = bytes;
+    this->budget_ms = ms;
+}
+
+void asset_streamer::apply_options(int argc, char **argv) {
+    for (int i = 2; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == "--stream-budget-kb" && i + 1 < argc) {
+            char *end;
+            long kilobytes = strtol(argv[++i], &end, 10);
+            if (*end != '\0' || kilobytes < 0) {
+                throw std::runtime_error("invalid --stream-budget-kb value \"" + std::string(argv[i]) + "\"");
+            }
+            this->budget_bytes = kilobytes * 1024;
+        } else if (arg == "--stream-budget-ms" && i + 1 < argc) {
+            char *end;
+            this->budget_ms = strtod(argv[++i], &end);
+            if (*end != '\0' || this->budget_ms < 0.0) {
+                throw std::runtime_error("invalid --stream-budget-ms value \"" + std::string(argv[i]) + "\"");
+            }
+        }
+    }
+}
+
+// Requests the ring had no room for wait here, in order, until it drains.
+void asset_streamer::flush_overflow() {
+    bool pushed = false;
+    while (!this->overflow.empty() && this->requests.try_push(this->overflow.front())) {
+        this->overflow.pop_front();
+        pushed = true;
+    }
+    if (pushed) {
+        // Passing through the lock orders the push against the I/O
+        // thread's check before it sleeps, so the wakeup isn't lost.
+        std::unique_lock<std::mutex> lock(this->sleep_mutex);
+        lock.unlock();
+        this->wake.notify_one();
+    }
+}
+
+void asset_streamer::request(std::function<stream_upload()> load) {
+    stream_item item;
+    item.load = std::move(load);
+    this->overflow.push_back(std::move(item));
+    this->outstanding++;
+    this->flush_overflow();
+}
+
+// The mesh is mapped and paged in on the I/O thread; the render thread
+// only creates the buffers, straight from the page cache.
+void asset_streamer::request_mesh(
+        const std::string &path,
+        const shader_program &program,
+        std::function<void(std::unique_ptr<drawable>)> on_ready) {
+    const shader_program *mesh_program = &program;
+    this->request([path, mesh_program, on_ready]() {
+        std::shared_ptr<const mapped_mesh> mesh = std::make_shared<mapped_mesh>(path);
+        mesh->prefault();
+        stream_upload upload;
+        upload.bytes = mesh->get_vertex_bytes() + mesh->get_index_bytes();
+        upload.upload = [mesh, mesh_program, on_ready]() {
+            on_ready(std::unique_ptr<drawable>(new drawable(mesh, *mesh_program)));
+        };
+        return upload;
+    });
+}
+
+// Uploads loaded assets in request order until the frame's byte or time
+// budget runs out, but always at least one so an asset larger than the
+// budget still gets through. An error from loading is rethrown here, on
+// the thread that asked for the asset.
+void asset_streamer::pump() {
+    this->flush_overflow();
+
+    const uint64_t start = SDL_GetPerformanceCounter();
+    const uint64_t budget_ticks = this->budget_ms * SDL_GetPerformanceFrequency() / 1000.0;
+    size_t bytes = 0;
+    int uploads = 0;
+    stream_item item;
+    while (stream_item *next = this->loaded.front()) {
+        if (uploads > 0 && (bytes + next->loaded.bytes > this->budget_bytes
+                || SDL_GetPerformanceCounter() - start >= budget_ticks)) {
+            break;
+        }
+        this->loaded.try_pop(item);
+        this->outstanding--;
+        if (item.error) {
+            std::rethrow_exception(item.error);
+        }
+        if (item.loaded.upload) {
+            item.loaded.upload();
+        }
+        bytes += item.loaded.bytes;
+        uploads++;
+    }
+
+    frame_stats &stats = get_frame_stats();
+    stats.count(frame_counter::stream_queue_depth, this->outstanding);
+    stats.count(frame_counter::stream_upload_us,
+            (SDL_GetPerformanceCounter() - start) * 1000000 / SDL_GetPerformanceFrequency());
+}
+
+int asset_streamer::get_outstanding() const {
+    return this->outstanding;
+}
+
+void asset_streamer::io_loop() {
+    stream_item item;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(this->sleep_mutex);
+            this->wake.wait(lock, [this]() {
+                return this->stopping || this->requests.front() != NULL;
+            });
+            if (this->stopping) {
+                return;
+            }
+        }
+
+        while (this->requests.try_pop(item)) {
+            try {
+                item.loaded = item.load();
+            } catch (...) {
+                item.error = std::current_exception();
+            }
+            item.load = nullptr;
+            // The render thread drains at most one budget per frame; back
+            // off while it catches up rather than spin.
+            while (!this->loaded.try_push(item)) {
+                if (this->stopping) {
+                    return;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+}
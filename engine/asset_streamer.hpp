@@ -0,0 +1,67 @@
+#ifndef ASSET_STREAMER_HPP_
+#define ASSET_STREAMER_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <stddef.h>
+
+#include "engine/drawable.hpp"
+#include "engine/shader_program.hpp"
+#include "engine/spsc_queue.hpp"
+
+// What's left of an asset once it has been read and decoded: the GL work
+// for the render thread and roughly how many bytes it uploads.
+struct stream_upload {
+    size_t bytes;
+    std::function<void()> upload;
+};
+
+// Loads assets on a background I/O thread and uploads them on the render
+// thread within a per-frame budget, so large scenes stream in instead of
+// stalling a frame. Requests go to the I/O thread and loaded assets come
+// back over lock-free single-producer single-consumer queues; only the
+// thread that owns the GL context may call request() and pump().
+class asset_streamer {
+protected:
+    struct stream_item {
+        std::function<stream_upload()> load;
+        stream_upload loaded;
+        std::exception_ptr error;
+    };
+    spsc_queue<stream_item> requests;
+    spsc_queue<stream_item> loaded;
+    std::deque<stream_item> overflow;
+    std::thread io_thread;
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    std::atomic<bool> stopping;
+    size_t budget_bytes;
+    double budget_ms;
+    int outstanding;
+    void flush_overflow();
+    void io_loop();
+public:
+    asset_streamer();
+    asset_streamer(asset_streamer const &) = delete;
+    ~asset_streamer();
+    void operator=(asset_streamer const &) = delete;
+    void set_budget(size_t bytes, double ms);
+    void apply_options(int argc, char **argv);
+    void request(std::function<stream_upload()> load);
+    void request_mesh(
+            const std::string &path,
+            const shader_program &program,
+            std::function<void(std::unique_ptr<drawable>)> on_ready);
+    void pump();
+    int get_outstanding() const;
+};
+
+#endif // ASSET_STREAMER_HPP_
@@ -0,0 +1,63 @@
+#include "engine/basic_shader.hpp"
+
+const char *basic_vertex_source = R"glsl(
+#version 100
+#pragma feature OFFSET
+#pragma feature MVP
+#pragma feature TEXTURE
+
+attribute vec4 position;
+attribute vec4 color;
+
+varying vec4 fragment_color;
+
+#ifdef OFFSET
+uniform vec3 offset;
+#endif
+#ifdef MVP
+uniform mat4 mvp;
+#endif
+#ifdef TEXTURE
+attribute vec2 texcoord;
+varying vec2 fragment_texcoord;
+#endif
+
+void main() {
+    fragment_color = color;
+#ifdef TEXTURE
+    fragment_texcoord = texcoord;
+#endif
+    vec4 world_position = position;
+#ifdef OFFSET
+    world_position.xyz += offset;
+#endif
+#ifdef MVP
+    gl_Position = mvp * world_position;
+#else
+    gl_Position = world_position;
+#endif
+}
+)glsl";
+
+const char *basic_fragment_source = R"glsl(
+#version 100
+#pragma feature TEXTURE
+
+precision mediump float;
+
+varying vec4 fragment_color;
+
+#ifdef TEXTURE
+varying vec2 fragment_texcoord;
+
+uniform sampler2D color_texture;
+#endif
+
+void main() {
+#ifdef TEXTURE
+    gl_FragColor = texture2D(color_texture, fragment_texcoord) * fragment_color;
+#else
+    gl_FragColor = fragment_color;
+#endif
+}
+)glsl";
@@ -0,0 +1,14 @@
+#ifndef BASIC_SHADER_HPP_
+#define BASIC_SHADER_HPP_
+
+// The shader most modules share, for shader_variants. It passes the
+// "position" attribute through and colours with the "color" attribute;
+// its features are:
+//   OFFSET   adds the vec3 "offset" uniform to the position
+//   MVP      then transforms it by the mat4 "mvp" uniform
+//   TEXTURE  multiplies the colour by "color_texture", sampled at the
+//            vec2 "texcoord" attribute
+extern const char *basic_vertex_source;
+extern const char *basic_fragment_source;
+
+#endif // BASIC_SHADER_HPP_
@@ -0,0 +1,232 @@
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/bench.hpp"
+#include "engine/frame_stats.hpp"
+#include "engine/gl_check.hpp"
+#include "engine/gl_functions.hpp"
+#include "engine/program_cache.hpp"
+
+namespace bench {
+    struct summary {
+        int frames;
+        double min_ms;
+        double p50_ms;
+        double p95_ms;
+        double p99_ms;
+        double max_ms;
+        double mean_ms;
+        double fps;
+    };
+
+    bool enabled = false;
+    int measured_frames = 0;
+    int warmup_frames = 0;
+    int swap_count = 0;
+    uint64_t last_swap = 0;
+    uint64_t configure_time = 0;
+    uint64_t startup_ticks = 0;
+    bool quit_pushed = false;
+    std::vector<uint64_t> samples;
+    std::string renderer;
+    std::string video_driver;
+
+    void configure(int frames, int warmup) {
+        enabled = true;
+        measured_frames = frames;
+        warmup_frames = warmup;
+        swap_count = 0;
+        last_swap = 0;
+        configure_time = SDL_GetPerformanceCounter();
+        startup_ticks = 0;
+        quit_pushed = false;
+        samples.clear();
+        samples.reserve(frames);
+    }
+
+    bool is_enabled() {
+        return enabled;
+    }
+
+    // The swap that ends the warmup is the baseline, every swap after it
+    // closes one measured frame. Once enough frames are recorded a quit
+    // event is queued so the module's own event loop shuts down normally.
+    void on_swap() {
+        if (!enabled || quit_pushed) {
+            return;
+        }
+
+        uint64_t now = SDL_GetPerformanceCounter();
+        if (swap_count == 0) {
+            const char *gl_renderer = (const char*) GL_CALL(glGetString(GL_RENDERER));
+            const char *driver = SDL_GetCurrentVideoDriver();
+            renderer = gl_renderer ? gl_renderer : "unknown";
+            video_driver = driver ? driver : "unknown";
+            startup_ticks = now - configure_time;
+        }
+        if (swap_count > warmup_frames) {
+            samples.push_back(now - last_swap);
+        }
+        last_swap = now;
+        swap_count++;
+
+        if ((int) samples.size() >= measured_frames) {
+            SDL_Event quit_event;
+            quit_event.type = SDL_QUIT;
+            SDL_PushEvent(&quit_event);
+            quit_pushed = true;
+        }
+    }
+
+    double percentile(const std::vector<double> &sorted, double p) {
+        if (sorted.empty()) {
+            return 0.0;
+        }
+        size_t rank = (size_t) (p / 100.0 * (sorted.size() - 1) + 0.5);
+        return sorted[std::min(rank, sorted.size() - 1)];
+    }
+
+    summary summarize() {
+        double ticks_per_ms = SDL_GetPerformanceFrequency() / 1000.0;
+        std::vector<double> frame_ms;
+        frame_ms.reserve(samples.size());
+        double total_ms = 0.0;
+        for (const auto &sample : samples) {
+            frame_ms.push_back(sample / ticks_per_ms);
+            total_ms += frame_ms.back();
+        }
+        std::sort(frame_ms.begin(), frame_ms.end());
+
+        summary s;
+        s.frames = frame_ms.size();
+        s.min_ms = frame_ms.empty() ? 0.0 : frame_ms.front();
+        s.p50_ms = percentile(frame_ms, 50.0);
+        s.p95_ms = percentile(frame_ms, 95.0);
+        s.p99_ms = percentile(frame_ms, 99.0);
+        s.max_ms = frame_ms.empty() ? 0.0 : frame_ms.back();
+        s.mean_ms = frame_ms.empty() ? 0.0 : total_ms / frame_ms.size();
+        s.fps = total_ms > 0.0 ? frame_ms.size() * 1000.0 / total_ms : 0.0;
+        return s;
+    }
+
+    double ticks_to_ms(uint64_t ticks) {
+        return ticks * 1000.0 / SDL_GetPerformanceFrequency();
+    }
+
+    std::string json_escape(const std::string &str) {
+        std::string escaped;
+        for (const auto &c : str) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    void write_text_report(const std::string &module_name, std::ostream &out) {
+        summary s = summarize();
+        out << std::fixed << std::setprecision(3);
+        out << "module:     " << module_name << std::endl;
+        out << "renderer:   " << renderer << " (" << video_driver << ")" << std::endl;
+        out << "frames:     " << s.frames << " (warmup " << warmup_frames << ")" << std::endl;
+        out << "frame time: min " << s.min_ms << " ms, p50 " << s.p50_ms << " ms, p95 " << s.p95_ms
+            << " ms, p99 " << s.p99_ms << " ms, max " << s.max_ms << " ms" << std::endl;
+        out << "mean:       " << s.mean_ms << " ms (" << s.fps << " fps)" << std::endl;
+        const program_cache_stats &cache_stats = get_program_cache().get_stats();
+        out << "startup:    " << ticks_to_ms(startup_ticks) << " ms to first frame ("
+            << (get_program_cache().is_read_enabled() ? "warm" : "cold") << "), programs built in "
+            << ticks_to_ms(cache_stats.build_ticks) << " ms, binaries " << cache_stats.binary_hits << " hit "
+            << cache_stats.binary_misses << " missed, shaders " << cache_stats.shaders_compiled << " compiled "
+            << cache_stats.shaders_reused << " reused" << std::endl;
+        out << "compile:    ";
+        if (get_program_cache().has_completion_status()) {
+            out << ticks_to_ms(cache_stats.compile_hidden_ticks) << " ms hidden behind other startup work ("
+                << cache_stats.programs_compiling_at_use << " programs still compiling at first use, "
+                << cache_stats.programs_ready_before_use << " ready before), ";
+        } else {
+            out << "hidden time unknown without GL_KHR_parallel_shader_compile, ";
+        }
+        out << ticks_to_ms(cache_stats.compile_wait_ticks) << " ms blocked on status checks" << std::endl;
+        out << "stages:    ";
+        for (int stage = 0; stage < frame_stage_count - 1; stage++) {
+            stage_summary stage_s = get_frame_stats().summarize((frame_stage) stage);
+            out << " " << get_frame_stage_name((frame_stage) stage) << " " << stage_s.mean_ms << " ms";
+        }
+        out << " (mean of last " << get_frame_stats().summarize(frame_stage::total).frames << " frames)" << std::endl;
+        out << "counters:  ";
+        for (int counter = 0; counter < frame_counter_count; counter++) {
+            out << " " << get_frame_counter_name((frame_counter) counter) << " "
+                << get_frame_stats().counter_mean((frame_counter) counter) << "/frame";
+        }
+        out << std::endl;
+        stage_summary latency = get_frame_stats().summarize_input_latency();
+        if (latency.frames > 0) {
+            out << "input:      " << latency.frames << " frames with input, latency to present p50 " << latency.p50_ms
+                << " ms, p95 " << latency.p95_ms << " ms, max " << latency.max_ms << " ms" << std::endl;
+        }
+        if (get_frame_stats().get_worker_count() > 0) {
+            out << "workers:   ";
+            for (int worker = 0; worker < get_frame_stats().get_worker_count(); worker++) {
+                out << " " << worker << ": " << get_frame_stats().worker_utilisation(worker) * 100.0 << "%";
+            }
+            out << " busy (worker 0 is the GL thread)" << std::endl;
+        }
+    }
+
+    void write_json_report(const std::string &module_name, std::ostream &out) {
+        summary s = summarize();
+        out << std::fixed << std::setprecision(3);
+        out << "{\"module\": \"" << json_escape(module_name) << "\""
+            << ", \"renderer\": \"" << json_escape(renderer) << "\""
+            << ", \"video_driver\": \"" << json_escape(video_driver) << "\""
+            << ", \"frames\": " << s.frames
+            << ", \"warmup\": " << warmup_frames
+            << ", \"min_ms\": " << s.min_ms
+            << ", \"p50_ms\": " << s.p50_ms
+            << ", \"p95_ms\": " << s.p95_ms
+            << ", \"p99_ms\": " << s.p99_ms
+            << ", \"max_ms\": " << s.max_ms
+            << ", \"mean_ms\": " << s.mean_ms
+            << ", \"fps\": " << s.fps;
+        const program_cache_stats &cache_stats = get_program_cache().get_stats();
+        out << ", \"startup_ms\": " << ticks_to_ms(startup_ticks)
+            << ", \"program_cache\": {\"mode\": \"" << (get_program_cache().is_read_enabled() ? "warm" : "cold") << "\""
+            << ", \"build_ms\": " << ticks_to_ms(cache_stats.build_ticks)
+            << ", \"binary_hits\": " << cache_stats.binary_hits
+            << ", \"binary_misses\": " << cache_stats.binary_misses
+            << ", \"shaders_compiled\": " << cache_stats.shaders_compiled
+            << ", \"shaders_reused\": " << cache_stats.shaders_reused
+            << ", \"compile_hidden_ms\": " << ticks_to_ms(cache_stats.compile_hidden_ticks)
+            << ", \"programs_compiling_at_use\": " << cache_stats.programs_compiling_at_use
+            << ", \"programs_ready_before_use\": " << cache_stats.programs_ready_before_use
+            << ", \"compile_wait_ms\": " << ticks_to_ms(cache_stats.compile_wait_ticks) << "}";
+        out << ", \"stages_mean_ms\": {";
+        for (int stage = 0; stage < frame_stage_count - 1; stage++) {
+            out << (stage ? ", " : "") << "\"" << get_frame_stage_name((frame_stage) stage) << "\": "
+                << get_frame_stats().summarize((frame_stage) stage).mean_ms;
+        }
+        out << "}, \"counters_mean\": {";
+        for (int counter = 0; counter < frame_counter_count; counter++) {
+            out << (counter ? ", " : "") << "\"" << get_frame_counter_name((frame_counter) counter) << "\": "
+                << get_frame_stats().counter_mean((frame_counter) counter);
+        }
+        out << "}, \"worker_utilisation\": [";
+        for (int worker = 0; worker < get_frame_stats().get_worker_count(); worker++) {
+            out << (worker ? ", " : "") << get_frame_stats().worker_utilisation(worker);
+        }
+        stage_summary latency = get_frame_stats().summarize_input_latency();
+        out << "], \"input_latency\": {\"frames\": " << latency.frames
+            << ", \"p50_ms\": " << latency.p50_ms
+            << ", \"p95_ms\": " << latency.p95_ms
+            << ", \"max_ms\": " << latency.max_ms << "}}" << std::endl;
+    }
+}
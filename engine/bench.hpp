@@ -0,0 +1,15 @@
+#ifndef BENCH_HPP_
+#define BENCH_HPP_
+
+#include <ostream>
+#include <string>
+
+namespace bench {
+    void configure(int frames, int warmup);
+    bool is_enabled();
+    void on_swap();
+    void write_text_report(const std::string &module_name, std::ostream &out);
+    void write_json_report(const std::string &module_name, std::ostream &out);
+}
+
+#endif // BENCH_HPP_
@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+#include <string.h>
+
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/buffer_arena.hpp"
+#include "engine/frame_stats.hpp"
+#include "engine/gl_check.hpp"
+#include "engine/gl_functions.hpp"
+#include "engine/gl_state.hpp"
+
+size_t align_size(size_t size) {
+    return (size + buffer_arena::alignment - 1) & ~(buffer_arena::alignment - 1);
+}
+
+buffer_arena::buffer_arena(GLenum target, size_t block_size)
+    : target(target), block_size(align_size(block_size)) {
+}
+
+buffer_arena::~buffer_arena() {
+    for (const auto &b : this->blocks) {
+        get_gl_state().forget_buffer(b.buffer_id);
+        glDeleteBuffers(1, &b.buffer_id);
+    }
+}
+
+void buffer_arena::add_block(size_t size) {
+    block b;
+    b.size = std::max(size, this->block_size);
+    b.shadow.resize(b.size);
+    b.free_ranges[0] = b.size;
+    GL_CALL(glGenBuffers(1, &b.buffer_id));
+    get_gl_state().bind_buffer(this->target, b.buffer_id);
+    GL_CALL(glBufferData(this->target, b.size, NULL, GL_STATIC_DRAW));
+    this->blocks.push_back(std::move(b));
+}
+
+// First fit, trying the blocks in creation order so that the older blocks
+// fill up before newer ones get used.
+bool buffer_arena::find_range(size_t size, size_t *block_index, size_t *offset) {
+    for (size_t i = 0; i < this->blocks.size(); i++) {
+        for (const auto &range : this->blocks[i].free_ranges) {
+            if (range.second >= size) {
+                *block_index = i;
+                *offset = range.first;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+arena_handle buffer_arena::allocate(const void *data, size_t data_size) {
+    size_t size = align_size(std::max(data_size, (size_t) 1));
+    size_t block_index;
+    size_t offset;
+    if (!this->find_range(size, &block_index, &offset)) {
+        this->add_block(size);
+        block_index = this->blocks.size() - 1;
+        offset = 0;
+    }
+
+    block &b = this->blocks[block_index];
+    size_t range_size = b.free_ranges[offset];
+    b.free_ranges.erase(offset);
+    if (range_size > size) {
+        b.free_ranges[offset + size] = range_size - size;
+    }
+
+    arena_handle handle;
+    if (this->free_handles.empty()) {
+        handle = this->allocations.size();
+        this->allocations.push_back(allocation());
+    } else {
+        handle = this->free_handles.back();
+        this->free_handles.pop_back();
+    }
+    this->allocations[handle] = {true, block_index, offset, size};
+
+    if (data != NULL) {
+        this->write(handle, data, data_size);
+    }
+    return handle;
+}
+
+void buffer_arena::write(arena_handle handle, const void *data, size_t size, size_t offset) {
+    const allocation &a = this->allocations.at(handle);
+    if (!a.live || offset + size > a.size) {
+        throw std::runtime_error("buffer_arena::write outside of the allocation");
+    }
+    block &b = this->blocks[a.block_index];
+    memcpy(&b.shadow[a.offset + offset], data, size);
+    get_gl_state().bind_buffer(this->target, b.buffer_id);
+    GL_CALL(glBufferSubData(this->target, a.offset + offset, size, data));
+    get_frame_stats().count(frame_counter::upload_bytes, size);
+}
+
+// Returns the range and merges it with free neighbours on either side.
+void buffer_arena::free(arena_handle handle) {
+    allocation &a = this->allocations.at(handle);
+    if (!a.live) {
+        throw std::runtime_error("buffer_arena::free of a dead allocation");
+    }
+    a.live = false;
+    this->free_handles.push_back(handle);
+
+    auto &ranges = this->blocks[a.block_index].free_ranges;
+    size_t offset = a.offset;
+    size_t size = a.size;
+    auto next = ranges.lower_bound(offset);
+    if (next != ranges.end() && offset + size == next->first) {
+        size += next->second;
+        next = ranges.erase(next);
+    }
+    if (next != ranges.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            previous->second += size;
+            return;
+        }
+    }
+    ranges[offset] = size;
+}
+
+// Slides every live allocation towards the start of its block, leaving one
+// free range at the end, and re-uploads each block that moved in one call.
+// Blocks left without allocations are deleted, which gives their memory
+// back to the driver.
+void buffer_arena::defragment() {
+    std::vector<std::vector<arena_handle>> by_block(this->blocks.size());
+    for (arena_handle handle = 0; handle < this->allocations.size(); handle++) {
+        if (this->allocations[handle].live) {
+            by_block[this->allocations[handle].block_index].push_back(handle);
+        }
+    }
+
+    for (size_t i = 0; i < this->blocks.size(); i++) {
+        block &b = this->blocks[i];
+        bool compact = b.free_ranges.empty() || (b.free_ranges.size() == 1
+            && b.free_ranges.begin()->first + b.free_ranges.begin()->second == b.size);
+        if (compact) {
+            continue;
+        }
+
+        std::sort(by_block[i].begin(), by_block[i].end(), [this](arena_handle x, arena_handle y) {
+            return this->allocations[x].offset < this->allocations[y].offset;
+        });
+        size_t end = 0;
+        for (const auto &handle : by_block[i]) {
+            allocation &a = this->allocations[handle];
+            memmove(&b.shadow[end], &b.shadow[a.offset], a.size);
+            a.offset = end;
+            end += a.size;
+        }
+
+        b.free_ranges.clear();
+        if (end < b.size) {
+            b.free_ranges[end] = b.size - end;
+        }
+        if (end == 0) {
+            continue;
+        }
+        get_gl_state().bind_buffer(this->target, b.buffer_id);
+        GL_CALL(glBufferData(this->target, b.size, b.shadow.data(), GL_STATIC_DRAW));
+        get_frame_stats().count(frame_counter::upload_bytes, end);
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < this->blocks.size(); i++) {
+        if (by_block[i].empty()) {
+            get_gl_state().forget_buffer(this->blocks[i].buffer_id);
+            glDeleteBuffers(1, &this->blocks[i].buffer_id);
+            continue;
+        }
+        for (const auto &handle : by_block[i]) {
+            this->allocations[handle].block_index = kept;
+        }
+        if (kept != i) {
+            this->blocks[kept] = std::move(this->blocks[i]);
+        }
+        kept++;
+    }
+    this->blocks.resize(kept);
+}
+
+void buffer_arena::bind(arena_handle handle) {
+    get_gl_state().bind_buffer(this->target, this->get_buffer_id(handle));
+}
+
+uint32_t buffer_arena::get_buffer_id(arena_handle handle) const {
+    return this->blocks[this->allocations.at(handle).block_index].buffer_id;
+}
+
+const uint8_t *buffer_arena::get_data(arena_handle handle) const {
+    const allocation &a = this->allocations.at(handle);
+    return &this->blocks[a.block_index].shadow[a.offset];
+}
+
+size_t buffer_arena::get_offset(arena_handle handle) const {
+    return this->allocations.at(handle).offset;
+}
+
+arena_stats buffer_arena::get_stats() const {
+    arena_stats stats = {this->blocks.size(), 0, 0, 0, 0, 0};
+    for (const auto &b : this->blocks) {
+        stats.reserved_bytes += b.size;
+        stats.free_ranges += b.free_ranges.size();
+        for (const auto &range : b.free_ranges) {
+            stats.largest_free_range = std::max(stats.largest_free_range, range.second);
+        }
+    }
+    for (const auto &a : this->allocations) {
+        if (a.live) {
+            stats.used_bytes += a.size;
+            stats.allocations++;
+        }
+    }
+    return stats;
+}
@@ -0,0 +1,70 @@
+#ifndef BUFFER_ARENA_HPP_
+#define BUFFER_ARENA_HPP_
+
+#include <map>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <SDL2/SDL_opengles2.h>
+
+typedef uint32_t arena_handle;
+
+struct arena_stats {
+    size_t blocks;
+    size_t reserved_bytes;
+    size_t used_bytes;
+    size_t allocations;
+    size_t free_ranges;
+    size_t largest_free_range;
+};
+
+// Hands out ranges of a few large GL buffers so that many small meshes can
+// share one binding. Each block keeps a CPU copy of its contents, since ES
+// 2.0 can't read buffers back, which is what lets defragment() move
+// allocations; holders read their data back from it instead of keeping
+// their own. Offsets can change when defragmenting, so holders keep the
+// handle and look the offset up when they draw.
+class buffer_arena {
+protected:
+    struct block {
+        uint32_t buffer_id;
+        size_t size;
+        std::vector<uint8_t> shadow;
+        // Free ranges by offset, so neighbours can be found for coalescing.
+        std::map<size_t, size_t> free_ranges;
+    };
+
+    struct allocation {
+        bool live;
+        size_t block_index;
+        size_t offset;
+        size_t size;
+    };
+
+    GLenum target;
+    size_t block_size;
+    std::vector<block> blocks;
+    std::vector<allocation> allocations;
+    std::vector<arena_handle> free_handles;
+    bool find_range(size_t size, size_t *block_index, size_t *offset);
+    void add_block(size_t size);
+public:
+    static const size_t alignment = 16;
+    buffer_arena(GLenum target, size_t block_size);
+    buffer_arena(buffer_arena const &) = delete;
+    ~buffer_arena();
+    void operator=(buffer_arena const &) = delete;
+    arena_handle allocate(const void *data, size_t size);
+    void write(arena_handle handle, const void *data, size_t size, size_t offset = 0);
+    void free(arena_handle handle);
+    void defragment();
+    void bind(arena_handle handle);
+    uint32_t get_buffer_id(arena_handle handle) const;
+    const uint8_t *get_data(arena_handle handle) const;
+    size_t get_offset(arena_handle handle) const;
+    arena_stats get_stats() const;
+};
+
+#endif // BUFFER_ARENA_HPP_
@@ -0,0 +1,93 @@
+#include <stdexcept>
+#include <string>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/draw_batch.hpp"
+#include "engine/frame_stats.hpp"
+#include "engine/gl_check.hpp"
+#include "engine/gl_functions.hpp"
+#include "engine/gl_state.hpp"
+
+const int batch_vertex_floats = 8;
+const size_t max_short_index_vertices = 65536;
+
+draw_batch::draw_batch()
+    : vertex_stream(0, buffer_usage::stream_draw, buffer_update::orphan), located_program_id(0), position_attrib(0), color_attrib(0) {
+    GL_CALL(glGenBuffers(1, &this->index_buffer_id));
+    this->uint_indices = SDL_GL_ExtensionSupported("GL_OES_element_index_uint");
+}
+
+draw_batch::~draw_batch() {
+    get_gl_state().forget_buffer(this->index_buffer_id);
+    glDeleteBuffers(1, &this->index_buffer_id);
+}
+
+// Batches the store entries at the given dense indices, skipping entries
+// without a drawable. The program doesn't have to be the one the drawables
+// were built for, only to take the same position and color attributes.
+void draw_batch::draw(const drawable_store &drawables, const std::vector<uint32_t> &indices, const shader_program &program) {
+    if (this->located_program_id != program.get_program_id()) {
+        this->position_attrib = program.get_attrib_location("position");
+        this->color_attrib = program.get_attrib_location("color");
+        this->located_program_id = program.get_program_id();
+    }
+    uint32_t position_attrib = this->position_attrib;
+    uint32_t color_attrib = this->color_attrib;
+
+    this->vertices.clear();
+    this->indices.clear();
+    for (const auto &index : indices) {
+        const drawable *d = drawables.get_at(index);
+        if (d == NULL) {
+            continue;
+        }
+        size_t batch_vertex_count = this->vertices.size() / batch_vertex_floats;
+        if (!this->uint_indices && batch_vertex_count + d->get_vertex_count() > max_short_index_vertices) {
+            // Flushing can't split one drawable, whose indices would
+            // otherwise be truncated to 16 bits.
+            if ((size_t) d->get_vertex_count() > max_short_index_vertices) {
+                throw std::runtime_error(
+                    "can't batch a drawable with " + std::to_string(d->get_vertex_count())
+                    + " vertices without GL_OES_element_index_uint; draw it unbatched");
+            }
+            this->flush(position_attrib, color_attrib);
+        }
+        d->append_to_batch(this->vertices, this->indices, drawables.get_offset_at(index));
+    }
+    this->flush(position_attrib, color_attrib);
+}
+
+void draw_batch::flush(uint32_t position_attrib, uint32_t color_attrib) {
+    if (this->indices.empty()) {
+        this->vertices.clear();
+        return;
+    }
+
+    // Orphaning the store every flush lets the driver hand us fresh memory
+    // instead of waiting on draws still reading the old data.
+    gl_state &state = get_gl_state();
+    this->vertex_stream.update(this->vertices.data(), this->vertices.size() * sizeof(float));
+
+    const GLsizei stride = sizeof(float) * batch_vertex_floats;
+    state.enable_vertex_attrib(position_attrib);
+    state.vertex_attrib_pointer(position_attrib, 4, GL_FLOAT, GL_FALSE, stride, 0);
+    state.enable_vertex_attrib(color_attrib);
+    state.vertex_attrib_pointer(color_attrib, 4, GL_FLOAT, GL_FALSE, stride, (GLvoid*) (sizeof(float) * 4));
+
+    state.bind_buffer(GL_ELEMENT_ARRAY_BUFFER, this->index_buffer_id);
+    if (this->uint_indices) {
+        GL_CALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->indices.size() * sizeof(uint32_t), this->indices.data(), GL_STREAM_DRAW));
+        GL_CALL(glDrawElements(GL_TRIANGLES, this->indices.size(), GL_UNSIGNED_INT, 0));
+    } else {
+        this->short_indices.assign(this->indices.begin(), this->indices.end());
+        GL_CALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->short_indices.size() * sizeof(uint16_t), this->short_indices.data(), GL_STREAM_DRAW));
+        GL_CALL(glDrawElements(GL_TRIANGLES, this->short_indices.size(), GL_UNSIGNED_SHORT, 0));
+    }
+
+    get_frame_stats().count(frame_counter::draw_calls);
+
+    this->vertices.clear();
+    this->indices.clear();
+}
@@ -0,0 +1,35 @@
+#ifndef DRAW_BATCH_HPP_
+#define DRAW_BATCH_HPP_
+
+#include <vector>
+
+#include <stdint.h>
+
+#include "engine/drawable_store.hpp"
+#include "engine/shader_program.hpp"
+#include "engine/vertex_buffer.hpp"
+
+// Streams the geometry of many drawables that share a shader program into
+// one vertex buffer each frame and submits it with as few glDrawElements
+// calls as the index type allows.
+class draw_batch {
+protected:
+    vertex_buffer vertex_stream;
+    uint32_t index_buffer_id;
+    bool uint_indices;
+    std::vector<float> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<uint16_t> short_indices;
+    uint32_t located_program_id;
+    uint32_t position_attrib;
+    uint32_t color_attrib;
+    void flush(uint32_t position_attrib, uint32_t color_attrib);
+public:
+    draw_batch();
+    draw_batch(draw_batch const &) = delete;
+    ~draw_batch();
+    void operator=(draw_batch const &) = delete;
+    void draw(const drawable_store &drawables, const std::vector<uint32_t> &indices, const shader_program &program);
+};
+
+#endif // DRAW_BATCH_HPP_
@@ -1,45 +1,297 @@
+#include <stdexcept>
+#include <vector>
+
+#include <math.h>
+#include <string.h>
+
 #include <SDL2/SDL_opengles2.h>
 
 #include "engine/drawable.hpp"
+#include "engine/frame_stats.hpp"
+#include "engine/gl_check.hpp"
+#include "engine/gl_functions.hpp"
+#include "engine/gl_state.hpp"
+
+std::vector<uint8_t> get_float_bytes(const std::vector<float> &floats) {
+    std::vector<uint8_t> bytes(floats.size() * sizeof(float));
+    memcpy(bytes.data(), floats.data(), bytes.size());
+    return bytes;
+}
 
 drawable::drawable(const std::vector<float> &vertex_vector, const int vertex_depth, const shader_program &program)
-    : vertices(vertex_vector), vertex_depth(vertex_depth), offset_x(0), offset_y(0), offset_z(0) {
-    this->vertex_count = vertex_vector.size() / this->vertex_depth / 2;
+    : drawable(
+            get_float_bytes(vertex_vector),
+            vertex_layout::planar({"position", "color"}, vertex_depth, vertex_vector.size() / vertex_depth / 2),
+            vertex_vector.size() / vertex_depth / 2,
+            program) {
+}
+
+drawable::drawable(const std::vector<uint8_t> &vertex_bytes, const vertex_layout &layout, const int vertex_count, const shader_program &program)
+    : drawable(vertex_bytes, layout, vertex_count, std::vector<uint16_t>(), program) {
+}
+
+// Without indices the vertices are drawn as a triangle fan, with indices
+// as an indexed triangle list.
+drawable::drawable(
+        const std::vector<uint8_t> &vertex_bytes,
+        const vertex_layout &layout,
+        const int vertex_count,
+        const std::vector<uint16_t> &index_vector,
+        const shader_program &program)
+    : layout(layout), vertex_data(vertex_bytes), vertices(new vertex_buffer(vertex_bytes.data(), vertex_bytes.size())),
+      arena(NULL), vertex_allocation(0), vertex_count(vertex_count), index_data(index_vector) {
+    this->init(program);
+}
+
+// Places the vertices in a range of the arena's shared buffers instead of
+// a buffer of their own, and reads them back from the arena's CPU copy
+// rather than keeping one as well. The arena has to outlive the drawable.
+drawable::drawable(
+        const std::vector<uint8_t> &vertex_bytes,
+        const vertex_layout &layout,
+        const int vertex_count,
+        const std::vector<uint16_t> &index_vector,
+        const shader_program &program,
+        buffer_arena &arena)
+    : layout(layout), arena(&arena),
+      vertex_allocation(arena.allocate(vertex_bytes.data(), vertex_bytes.size())),
+      vertex_count(vertex_count), index_data(index_vector) {
+    this->init(program);
+}
+
+// Uploads straight from the mapped file and keeps the mapping alive for
+// batching, so the vertices are never copied on the CPU.
+drawable::drawable(std::shared_ptr<const mapped_mesh> mesh, const shader_program &program)
+    : layout(mesh->get_layout()), mesh(mesh), vertices(new vertex_buffer(mesh->get_vertex_data(), mesh->get_vertex_bytes())),
+      arena(NULL), vertex_allocation(0), vertex_count(mesh->get_vertex_count()) {
+    if (mesh->get_index_count() > 0) {
+        this->indices.reset(new index_buffer(mesh->get_index_data(), mesh->get_index_type(), mesh->get_index_count()));
+    }
+    this->init(program);
+}
+
+drawable::~drawable() {
+    if (this->arena != NULL) {
+        this->arena->free(this->vertex_allocation);
+    }
+}
+
+void drawable::init(const shader_program &program) {
+    if (!this->index_data.empty()) {
+        this->indices.reset(new index_buffer(this->index_data));
+    }
+
+    for (const auto &attribute : this->layout.get_attributes()) {
+        this->attrib_locations.push_back(program.get_attrib_location(attribute.name.c_str()));
+    }
+    this->position_index = this->layout.find("position");
+    this->color_index = this->layout.find("color");
+    if (this->position_index < 0 || this->color_index < 0) {
+        throw std::runtime_error("drawable layouts need position and color attributes");
+    }
+    this->program = &program;
+    this->offset_uniform = uniform<vec3>(program, "offset");
+
+    // Mesh files carry their bounds, which spares a pass over the mapped
+    // vertices; the sphere is then the box's, which is a little loose.
+    if (this->mesh) {
+        this->box = this->mesh->get_bounds();
+        this->sphere.center = {
+            (this->box.min.x + this->box.max.x) / 2,
+            (this->box.min.y + this->box.max.y) / 2,
+            (this->box.min.z + this->box.max.z) / 2,
+        };
+        float dx = this->box.max.x - this->sphere.center.x;
+        float dy = this->box.max.y - this->sphere.center.y;
+        float dz = this->box.max.z - this->sphere.center.z;
+        this->sphere.radius = sqrtf(dx * dx + dy * dy + dz * dz);
+        return;
+    }
+
+    // Bounds in the drawable's own space; the sphere is centred on the box
+    // but sized by the furthest vertex, which is tighter than the box's
+    // half diagonal for most shapes.
+    const uint8_t *data = this->get_vertex_data();
+    float *box_min = &this->box.min.x;
+    float *box_max = &this->box.max.x;
+    for (int c = 0; c < 3; c++) {
+        box_min[c] = this->vertex_count > 0 ? INFINITY : 0.0f;
+        box_max[c] = this->vertex_count > 0 ? -INFINITY : 0.0f;
+        for (int v = 0; v < this->vertex_count; v++) {
+            float value = this->layout.read(data, this->position_index, v, c);
+            box_min[c] = fminf(box_min[c], value);
+            box_max[c] = fmaxf(box_max[c], value);
+        }
+    }
+    this->sphere.center = {
+        (this->box.min.x + this->box.max.x) / 2,
+        (this->box.min.y + this->box.max.y) / 2,
+        (this->box.min.z + this->box.max.z) / 2,
+    };
+    float radius_squared = 0.0f;
+    for (int v = 0; v < this->vertex_count; v++) {
+        float dx = this->layout.read(data, this->position_index, v, 0) - this->sphere.center.x;
+        float dy = this->layout.read(data, this->position_index, v, 1) - this->sphere.center.y;
+        float dz = this->layout.read(data, this->position_index, v, 2) - this->sphere.center.z;
+        radius_squared = fmaxf(radius_squared, dx * dx + dy * dy + dz * dz);
+    }
+    this->sphere.radius = sqrtf(radius_squared);
+}
 
-    this->position_attrib = program.get_attrib_location("position");
-    this->color_attrib = program.get_attrib_location("color");
-    this->offset_uniform = program.get_uniform_location("offset");
+// Arena data moves when the arena defragments, so this is only good until
+// then.
+const uint8_t *drawable::get_vertex_data() const {
+    if (this->mesh) {
+        return this->mesh->get_vertex_data();
+    }
+    if (this->arena != NULL) {
+        return this->arena->get_data(this->vertex_allocation);
+    }
+    return this->vertex_data.data();
 }
 
-void drawable::update_offsets(float dx, float dy, float dz) {
-    this->offset_x += dx;
-    this->offset_y += dy;
-    this->offset_z += dz;
+// Leaves its buffer and attributes bound; the state cache skips the rebind
+// when the next draw uses the same setup. Drawables don't keep a position
+// of their own: the caller, usually through a drawable_store, owns it.
+void drawable::draw(const vec3 &offset) {
+    gl_state &state = get_gl_state();
+    size_t base_offset = 0;
+    if (this->arena != NULL) {
+        this->arena->bind(this->vertex_allocation);
+        base_offset = this->arena->get_offset(this->vertex_allocation);
+    } else {
+        this->vertices->bind();
+    }
+
+    const auto &attributes = this->layout.get_attributes();
+    for (size_t i = 0; i < attributes.size(); i++) {
+        state.enable_vertex_attrib(this->attrib_locations[i]);
+        state.vertex_attrib_pointer(
+                this->attrib_locations[i],
+                attributes[i].components,
+                attributes[i].type,
+                attributes[i].normalized,
+                attributes[i].stride,
+                (GLvoid*) (base_offset + attributes[i].offset));
+    }
+
+    this->offset_uniform.set(offset);
+    if (this->indices) {
+        this->indices->bind();
+        GL_CALL(glDrawElements(GL_TRIANGLES, this->indices->get_index_count(), this->indices->get_index_type(), 0));
+    } else {
+        GL_CALL(glDrawArrays(GL_TRIANGLE_FAN, 0, this->vertex_count));
+    }
+    get_frame_stats().count(frame_counter::draw_calls);
+}
+
+// The same work as draw(), as commands for a render_queue. Only reads the
+// drawable, so any thread can record while the GL thread does something
+// else. buffer_id and attrib_locations are this drawable's
+// get_vertex_buffer_id() and get_attrib_locations(), passed in so the
+// caller can read them from dense arrays.
+void drawable::record(
+        render_bucket &bucket,
+        uint32_t buffer_id,
+        const uint32_t *attrib_locations,
+        const vec3 &offset,
+        float depth) const {
+    size_t base_offset = 0;
+    if (this->arena != NULL) {
+        base_offset = this->arena->get_offset(this->vertex_allocation);
+    }
+
+    bucket.begin(make_sort_key(this->program->get_program_id(), buffer_id, depth));
+    bucket.use_program(*this->program);
+    bucket.bind_buffer(GL_ARRAY_BUFFER, buffer_id);
+    const auto &attributes = this->layout.get_attributes();
+    for (size_t i = 0; i < attributes.size(); i++) {
+        bucket.vertex_attrib(
+                attrib_locations[i],
+                attributes[i].components,
+                attributes[i].type,
+                attributes[i].normalized,
+                attributes[i].stride,
+                base_offset + attributes[i].offset);
+    }
+
+    bucket.set_uniform(this->offset_uniform, offset);
+    if (this->indices) {
+        bucket.bind_buffer(GL_ELEMENT_ARRAY_BUFFER, this->indices->get_buffer_id());
+        bucket.draw_elements(GL_TRIANGLES, this->indices->get_index_count(), this->indices->get_index_type(), 0);
+    } else {
+        bucket.draw_arrays(GL_TRIANGLE_FAN, 0, this->vertex_count);
+    }
+}
+
+int drawable::get_vertex_count() const {
+    return this->vertex_count;
+}
+
+uint32_t drawable::get_vertex_buffer_id() const {
+    if (this->arena != NULL) {
+        return this->arena->get_buffer_id(this->vertex_allocation);
+    }
+    return this->vertices->get_buffer_id();
 }
 
-void drawable::draw() {
-    this->vertices.bind();
+const std::vector<uint32_t> &drawable::get_attrib_locations() const {
+    return this->attrib_locations;
+}
+
+// Appends this drawable's triangles (fans are converted) with the offset
+// already applied, in the interleaved xyzw/rgba layout used by draw_batch.
+void drawable::append_to_batch(std::vector<float> &batch_vertices, std::vector<uint32_t> &batch_indices, const vec3 &offset) const {
+    const uint32_t base = batch_vertices.size() / 8;
+    const float offsets[3] = {offset.x, offset.y, offset.z};
+    const uint8_t *data = this->get_vertex_data();
+
+    for (int v = 0; v < this->vertex_count; v++) {
+        for (int c = 0; c < 4; c++) {
+            float value = this->layout.read(data, this->position_index, v, c);
+            batch_vertices.push_back(c < 3 ? value + offsets[c] : value);
+        }
+        for (int c = 0; c < 4; c++) {
+            batch_vertices.push_back(this->layout.read(data, this->color_index, v, c));
+        }
+    }
+
+    if (!this->index_data.empty()) {
+        for (const auto &index : this->index_data) {
+            batch_indices.push_back(base + index);
+        }
+        return;
+    }
+    if (this->mesh && this->mesh->get_index_count() > 0) {
+        for (int i = 0; i < this->mesh->get_index_count(); i++) {
+            batch_indices.push_back(base + this->mesh->get_index(i));
+        }
+        return;
+    }
+    for (int v = 1; v + 1 < this->vertex_count; v++) {
+        batch_indices.push_back(base);
+        batch_indices.push_back(base + v);
+        batch_indices.push_back(base + v + 1);
+    }
+}
 
-    glEnableVertexAttribArray(this->position_attrib);
-    glVertexAttribPointer(
-            this->position_attrib,
-            this->vertex_depth,
-            GL_FLOAT,
-            GL_FALSE,
-            0,
-            0);
+uint32_t drawable::get_position_attrib() const {
+    return this->attrib_locations[this->position_index];
+}
 
-    glEnableVertexAttribArray(this->color_attrib);
-    glVertexAttribPointer(
-            this->color_attrib,
-            this->vertex_depth,
-            GL_FLOAT,
-            GL_FALSE,
-            0,
-            (GLvoid*) (sizeof(float) * this->vertex_depth * this->vertex_count));
+uint32_t drawable::get_color_attrib() const {
+    return this->attrib_locations[this->color_index];
+}
 
-    glUniform3f(this->offset_uniform, this->offset_x, this->offset_y, this->offset_z);
-    glDrawArrays(GL_TRIANGLE_FAN, 0, this->vertex_count);
+uniform<vec3> &drawable::get_offset_uniform() {
+    return this->offset_uniform;
+}
+
+const bounding_box &drawable::get_bounding_box() const {
+    return this->box;
+}
 
-    this->vertices.unbind();
+// In the drawable's own space, like the box; offsets aren't applied.
+const bounding_sphere &drawable::get_bounding_sphere() const {
+    return this->sphere;
 }
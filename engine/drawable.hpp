@@ -6,26 +6,72 @@
 
 #include <stdint.h>
 
+#include "engine/buffer_arena.hpp"
+#include "engine/frustum.hpp"
+#include "engine/index_buffer.hpp"
+#include "engine/mesh_file.hpp"
+#include "engine/render_commands.hpp"
+#include "engine/uniform.hpp"
 #include "engine/vertex_buffer.hpp"
+#include "engine/vertex_layout.hpp"
 #include "engine/shader_program.hpp"
 
 class drawable {
 protected:
-    vertex_buffer vertices;
-    int vertex_depth;
+    vertex_layout layout;
+    std::shared_ptr<const mapped_mesh> mesh;
+    std::vector<uint8_t> vertex_data;
+    std::unique_ptr<vertex_buffer> vertices;
+    buffer_arena *arena;
+    arena_handle vertex_allocation;
     int vertex_count;
-    uint32_t position_attrib;
-    uint32_t color_attrib;
-    uint32_t offset_uniform;
-    float offset_x;
-    float offset_y;
-    float offset_z;
+    std::vector<uint16_t> index_data;
+    std::unique_ptr<index_buffer> indices;
+    std::vector<uint32_t> attrib_locations;
+    int position_index;
+    int color_index;
+    const shader_program *program;
+    uniform<vec3> offset_uniform;
+    bounding_box box;
+    bounding_sphere sphere;
+    void init(const shader_program &program);
+    const uint8_t *get_vertex_data() const;
 public:
     drawable(const std::vector<float> &vertex_vector, const int vertex_depth, const shader_program &program);
+    drawable(const std::vector<uint8_t> &vertex_bytes, const vertex_layout &layout, const int vertex_count, const shader_program &program);
+    drawable(
+            const std::vector<uint8_t> &vertex_bytes,
+            const vertex_layout &layout,
+            const int vertex_count,
+            const std::vector<uint16_t> &index_vector,
+            const shader_program &program);
+    drawable(
+            const std::vector<uint8_t> &vertex_bytes,
+            const vertex_layout &layout,
+            const int vertex_count,
+            const std::vector<uint16_t> &index_vector,
+            const shader_program &program,
+            buffer_arena &arena);
+    drawable(std::shared_ptr<const mapped_mesh> mesh, const shader_program &program);
     drawable(drawable const &) = delete;
+    ~drawable();
     void operator=(drawable const &) = delete;
-    void update_offsets(float dx, float dy, float dz);
-    void draw();
+    void draw(const vec3 &offset);
+    void record(
+            render_bucket &bucket,
+            uint32_t buffer_id,
+            const uint32_t *attrib_locations,
+            const vec3 &offset,
+            float depth) const;
+    int get_vertex_count() const;
+    uint32_t get_vertex_buffer_id() const;
+    const std::vector<uint32_t> &get_attrib_locations() const;
+    void append_to_batch(std::vector<float> &batch_vertices, std::vector<uint32_t> &batch_indices, const vec3 &offset) const;
+    uint32_t get_position_attrib() const;
+    uint32_t get_color_attrib() const;
+    uniform<vec3> &get_offset_uniform();
+    const bounding_box &get_bounding_box() const;
+    const bounding_sphere &get_bounding_sphere() const;
 };
 
 #endif // DRAWABLE_HPP_
@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "engine/drawable_store.hpp"
+
+drawable_store::drawable_store() {
+}
+
+void drawable_store::reserve(size_t count) {
+    this->drawables.reserve(count);
+    this->offset_x.reserve(count);
+    this->offset_y.reserve(count);
+    this->offset_z.reserve(count);
+    this->center_x.reserve(count);
+    this->center_y.reserve(count);
+    this->center_z.reserve(count);
+    this->radius.reserve(count);
+    this->vertex_buffer_ids.reserve(count);
+    this->attrib_set_indices.reserve(count);
+    this->dense_slots.reserve(count);
+    this->slot_indices.reserve(count);
+    this->slot_generations.reserve(count);
+}
+
+// There are only ever a handful of distinct sets, one per program and
+// layout pair, so a linear search is enough. Sets are never dropped, which
+// keeps the indices stored for other entries valid.
+uint32_t drawable_store::find_attrib_set(const std::vector<uint32_t> &locations) {
+    auto found = std::find(this->attrib_sets.begin(), this->attrib_sets.end(), locations);
+    if (found != this->attrib_sets.end()) {
+        return found - this->attrib_sets.begin();
+    }
+    this->attrib_sets.push_back(locations);
+    return this->attrib_sets.size() - 1;
+}
+
+// An entry without a drawable only carries an offset and zero-sized bounds;
+// scene skips it when drawing.
+drawable_handle drawable_store::add(std::unique_ptr<drawable> d, const vec3 &offset) {
+    uint32_t slot;
+    if (this->free_slots.empty()) {
+        slot = this->slot_indices.size();
+        this->slot_indices.push_back(0);
+        this->slot_generations.push_back(0);
+    } else {
+        slot = this->free_slots.back();
+        this->free_slots.pop_back();
+    }
+    this->slot_indices[slot] = this->drawables.size();
+    this->dense_slots.push_back(slot);
+
+    bounding_sphere sphere = d ? d->get_bounding_sphere() : bounding_sphere{{0, 0, 0}, 0};
+    this->center_x.push_back(sphere.center.x);
+    this->center_y.push_back(sphere.center.y);
+    this->center_z.push_back(sphere.center.z);
+    this->radius.push_back(sphere.radius);
+    this->vertex_buffer_ids.push_back(d ? d->get_vertex_buffer_id() : 0);
+    this->attrib_set_indices.push_back(this->find_attrib_set(d ? d->get_attrib_locations() : std::vector<uint32_t>()));
+    this->offset_x.push_back(offset.x);
+    this->offset_y.push_back(offset.y);
+    this->offset_z.push_back(offset.z);
+    this->drawables.push_back(std::move(d));
+
+    return {slot, this->slot_generations[slot]};
+}
+
+// Swap-remove: the last entry moves into the hole in every array.
+bool drawable_store::remove(drawable_handle handle) {
+    if (!this->contains(handle)) {
+        return false;
+    }
+    size_t index = this->slot_indices[handle.slot];
+    size_t last = this->drawables.size() - 1;
+    if (index != last) {
+        this->drawables[index] = std::move(this->drawables[last]);
+        this->offset_x[index] = this->offset_x[last];
+        this->offset_y[index] = this->offset_y[last];
+        this->offset_z[index] = this->offset_z[last];
+        this->center_x[index] = this->center_x[last];
+        this->center_y[index] = this->center_y[last];
+        this->center_z[index] = this->center_z[last];
+        this->radius[index] = this->radius[last];
+        this->vertex_buffer_ids[index] = this->vertex_buffer_ids[last];
+        this->attrib_set_indices[index] = this->attrib_set_indices[last];
+        this->dense_slots[index] = this->dense_slots[last];
+        this->slot_indices[this->dense_slots[index]] = index;
+    }
+    this->drawables.pop_back();
+    this->offset_x.pop_back();
+    this->offset_y.pop_back();
+    this->offset_z.pop_back();
+    this->center_x.pop_back();
+    this->center_y.pop_back();
+    this->center_z.pop_back();
+    this->radius.pop_back();
+    this->vertex_buffer_ids.pop_back();
+    this->attrib_set_indices.pop_back();
+    this->dense_slots.pop_back();
+
+    this->slot_generations[handle.slot]++;
+    this->free_slots.push_back(handle.slot);
+    return true;
+}
+
+bool drawable_store::contains(drawable_handle handle) const {
+    return handle.slot < this->slot_generations.size() && this->slot_generations[handle.slot] == handle.generation;
+}
+
+size_t drawable_store::get_index(drawable_handle handle) const {
+    if (!this->contains(handle)) {
+        throw std::runtime_error("stale drawable handle");
+    }
+    return this->slot_indices[handle.slot];
+}
+
+drawable *drawable_store::get(drawable_handle handle) const {
+    return this->drawables[this->get_index(handle)].get();
+}
+
+void drawable_store::update_offset(drawable_handle handle, float dx, float dy, float dz) {
+    size_t index = this->get_index(handle);
+    this->offset_x[index] += dx;
+    this->offset_y[index] += dy;
+    this->offset_z[index] += dz;
+}
+
+size_t drawable_store::size() const {
+    return this->drawables.size();
+}
+
+drawable *drawable_store::get_at(size_t index) const {
+    return this->drawables[index].get();
+}
+
+vec3 drawable_store::get_offset_at(size_t index) const {
+    return {this->offset_x[index], this->offset_y[index], this->offset_z[index]};
+}
+
+float *drawable_store::get_offset_x() {
+    return this->offset_x.data();
+}
+
+float *drawable_store::get_offset_y() {
+    return this->offset_y.data();
+}
+
+float *drawable_store::get_offset_z() {
+    return this->offset_z.data();
+}
+
+const float *drawable_store::get_center_x() const {
+    return this->center_x.data();
+}
+
+const float *drawable_store::get_center_y() const {
+    return this->center_y.data();
+}
+
+const float *drawable_store::get_center_z() const {
+    return this->center_z.data();
+}
+
+const float *drawable_store::get_radius() const {
+    return this->radius.data();
+}
+
+const uint32_t *drawable_store::get_vertex_buffer_ids() const {
+    return this->vertex_buffer_ids.data();
+}
+
+const uint32_t *drawable_store::get_attrib_set_indices() const {
+    return this->attrib_set_indices.data();
+}
+
+const uint32_t *drawable_store::get_attrib_set(uint32_t index) const {
+    return this->attrib_sets[index].data();
+}
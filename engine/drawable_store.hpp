@@ -0,0 +1,74 @@
+#ifndef DRAWABLE_STORE_HPP_
+#define DRAWABLE_STORE_HPP_
+
+#include <memory>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "engine/drawable.hpp"
+#include "engine/math.hpp"
+
+// Stays valid while the entry lives; once it is removed the slot's
+// generation moves on, so old handles are detected instead of silently
+// referring to whatever reuses the slot.
+struct drawable_handle {
+    uint32_t slot;
+    uint32_t generation;
+};
+
+// Keeps per-drawable data in dense parallel arrays (structure of arrays),
+// so per-frame passes like offset updates and culling stream through
+// exactly the fields they touch. Recording reads each entry's vertex
+// buffer handle and attribute location set from here too rather than from
+// the drawable. Location sets are shared by every entry with the same
+// program and layout, so entries hold an index into them. An arena
+// allocation never changes block, so the buffer handle stays valid for the
+// entry's lifetime. Removal moves the last entry into the hole, so dense
+// indices aren't stable; handles are.
+class drawable_store {
+protected:
+    std::vector<std::unique_ptr<drawable>> drawables;
+    std::vector<float> offset_x;
+    std::vector<float> offset_y;
+    std::vector<float> offset_z;
+    std::vector<float> center_x;
+    std::vector<float> center_y;
+    std::vector<float> center_z;
+    std::vector<float> radius;
+    std::vector<uint32_t> vertex_buffer_ids;
+    std::vector<uint32_t> attrib_set_indices;
+    std::vector<std::vector<uint32_t>> attrib_sets;
+    std::vector<uint32_t> dense_slots;
+    std::vector<uint32_t> slot_indices;
+    std::vector<uint32_t> slot_generations;
+    std::vector<uint32_t> free_slots;
+    uint32_t find_attrib_set(const std::vector<uint32_t> &locations);
+public:
+    drawable_store();
+    drawable_store(drawable_store const &) = delete;
+    void operator=(drawable_store const &) = delete;
+    void reserve(size_t count);
+    drawable_handle add(std::unique_ptr<drawable> d, const vec3 &offset);
+    bool remove(drawable_handle handle);
+    bool contains(drawable_handle handle) const;
+    size_t get_index(drawable_handle handle) const;
+    drawable *get(drawable_handle handle) const;
+    void update_offset(drawable_handle handle, float dx, float dy, float dz);
+    size_t size() const;
+    drawable *get_at(size_t index) const;
+    vec3 get_offset_at(size_t index) const;
+    float *get_offset_x();
+    float *get_offset_y();
+    float *get_offset_z();
+    const float *get_center_x() const;
+    const float *get_center_y() const;
+    const float *get_center_z() const;
+    const float *get_radius() const;
+    const uint32_t *get_vertex_buffer_ids() const;
+    const uint32_t *get_attrib_set_indices() const;
+    const uint32_t *get_attrib_set(uint32_t index) const;
+};
+
+#endif // DRAWABLE_STORE_HPP_
@@ -1,11 +1,69 @@
+#include <memory>
 #include <stdexcept>
 #include <string>
 
+#include <stdlib.h>
+
 #include <SDL2/SDL.h>
 
+#include "engine/bench.hpp"
 #include "engine/engine.hpp"
+#include "engine/frame_capture.hpp"
+#include "engine/frame_stats.hpp"
+#include "engine/framebuffer.hpp"
+#include "engine/image_file.hpp"
+#include "engine/job_system.hpp"
+
+const double default_target_fps = 60.0;
+
+// Benchmarks measure how fast the loop can go, so they run unpaced unless
+// the pacing options are given explicitly.
+engine::engine(int argc, char **argv)
+    : target_fps(0.0), explicit_fps(false), vsync(bench::is_enabled() ? swap_mode::off : swap_mode::on),
+      capture_format(image_file_format::png), capture_every(1), offscreen(false) {
+    for (int i = 2; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == "--fps" && i + 1 < argc) {
+            char *end;
+            this->target_fps = strtod(argv[++i], &end);
+            this->explicit_fps = true;
+            if (*end != '\0' || this->target_fps < 0.0) {
+                throw std::runtime_error("invalid --fps value \"" + std::string(argv[i]) + "\"");
+            }
+        } else if (arg == "--vsync" && i + 1 < argc) {
+            std::string mode(argv[++i]);
+            if (mode == "off") {
+                this->vsync = swap_mode::off;
+            } else if (mode == "on") {
+                this->vsync = swap_mode::on;
+            } else if (mode == "adaptive") {
+                this->vsync = swap_mode::adaptive;
+            } else {
+                throw std::runtime_error("invalid --vsync value \"" + mode + "\"");
+            }
+        } else if (arg == "--workers" && i + 1 < argc) {
+            char *end;
+            long workers = strtol(argv[++i], &end, 10);
+            if (*end != '\0' || workers < 1) {
+                throw std::runtime_error("invalid --workers value \"" + std::string(argv[i]) + "\"");
+            }
+            set_job_worker_count(workers);
+        } else if (arg == "--capture" && i + 1 < argc) {
+            this->capture_directory = argv[++i];
+        } else if (arg == "--capture-every" && i + 1 < argc) {
+            char *end;
+            long every = strtol(argv[++i], &end, 10);
+            if (*end != '\0' || every < 1) {
+                throw std::runtime_error("invalid --capture-every value \"" + std::string(argv[i]) + "\"");
+            }
+            this->capture_every = every;
+        } else if (arg == "--capture-format" && i + 1 < argc) {
+            this->capture_format = parse_image_file_format(argv[++i]);
+        } else if (arg == "--offscreen") {
+            this->offscreen = true;
+        }
+    }
 
-engine::engine() {
     if (SDL_Init(SDL_INIT_VIDEO|SDL_INIT_TIMER) != 0) {
         throw std::runtime_error("SDL_Init failed: " + std::string(SDL_GetError()));
     }
@@ -15,3 +73,71 @@ engine::~engine() {
      SDL_Quit();
 }
 
+void engine::run(window &main_window, const frame_callbacks &callbacks) {
+    // Vsync already blocks each swap until the display is ready, and the
+    // pacer's own clock drifting against it would cost vblanks and spin at
+    // the end of every frame. The pacer only runs by default when there is
+    // no vsync, including when the driver refused it.
+    swap_mode mode = main_window.set_pacing(this->target_fps, this->vsync);
+    if (!this->explicit_fps && mode == swap_mode::off && !bench::is_enabled()) {
+        main_window.set_pacing(default_target_fps, swap_mode::off);
+    }
+    frame_stats &stats = get_frame_stats();
+
+    // Offscreen, frames are drawn into a target of the window's size
+    // instead of the window, so captures don't depend on the surface format
+    // the platform picked. Its colour is a texture because RGBA textures are
+    // always 8 bits per channel in ES 2.0, where renderbuffers may fall back
+    // to RGBA4. Nothing else binds framebuffers, so binding it once is
+    // enough.
+    int width, height;
+    main_window.get_drawable_size(&width, &height);
+    std::unique_ptr<framebuffer> target;
+    if (this->offscreen) {
+        target.reset(new framebuffer(width, height, framebuffer_color::texture));
+        target->bind();
+    }
+    std::unique_ptr<frame_capture> capture;
+    if (!this->capture_directory.empty()) {
+        capture.reset(new frame_capture(this->capture_directory, this->capture_format));
+    }
+
+    SDL_Event event;
+    int frame = 0;
+    bool done = false;
+    while (!done) {
+        while (SDL_PollEvent(&event)) {
+            // Keyboard, text, mouse, joystick, controller, touch and gesture
+            // events sit between the key and clipboard event types.
+            if (event.type >= SDL_KEYDOWN && event.type < SDL_CLIPBOARDUPDATE) {
+                stats.note_input(event.common.timestamp);
+            }
+            if (event.type == SDL_QUIT) {
+                done = true;
+            } else if (callbacks.on_event) {
+                callbacks.on_event(event);
+            }
+        }
+        if (done) {
+            break;
+        }
+        stats.mark(frame_stage::input);
+
+        if (callbacks.on_update) {
+            callbacks.on_update();
+        }
+        stats.mark(frame_stage::update);
+
+        if (callbacks.on_draw) {
+            callbacks.on_draw();
+        }
+        if (capture && frame % this->capture_every == 0) {
+            capture->capture(frame, width, height);
+        }
+        main_window.swap();
+        frame++;
+    }
+    if (capture) {
+        capture->finish();
+    }
+}
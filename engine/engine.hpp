@@ -1,12 +1,36 @@
 #ifndef ENGINE_HPP_
 #define ENGINE_HPP_
 
+#include <functional>
+#include <string>
+
+#include <SDL2/SDL.h>
+
+#include "engine/frame_pacer.hpp"
+#include "engine/image_file.hpp"
+#include "engine/window.hpp"
+
+struct frame_callbacks {
+    std::function<void(const SDL_Event &)> on_event;
+    std::function<void()> on_update;
+    std::function<void()> on_draw;
+};
+
 class engine {
+protected:
+    double target_fps;
+    bool explicit_fps;
+    swap_mode vsync;
+    std::string capture_directory;
+    image_file_format capture_format;
+    int capture_every;
+    bool offscreen;
 public:
-    engine();
+    engine(int argc, char **argv);
     engine(engine const &) = delete;
     ~engine();
     void operator=(engine const &) = delete;
+    void run(window &main_window, const frame_callbacks &callbacks);
 };
 
 #endif // ENGINE_HPP_
@@ -0,0 +1,99 @@
+#include <exception>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "engine/frame_capture.hpp"
+#include "engine/framebuffer.hpp"
+#include "engine/image.hpp"
+#include "engine/image_file.hpp"
+
+// Each queued frame holds a full copy of the pixels, so only a few may
+// wait.
+const size_t max_queued_captures = 4;
+
+frame_capture::frame_capture(const std::string &directory, image_file_format format)
+    : directory(directory), format(format), stopping(false), encoding(0) {
+    this->encoder_thread = std::thread(&frame_capture::encode_loop, this);
+}
+
+// Frames still queued are written before the encoder stops; errors are
+// only reported by finish().
+frame_capture::~frame_capture() {
+    {
+        std::lock_guard<std::mutex> lock(this->jobs_mutex);
+        this->stopping = true;
+    }
+    this->changed.notify_all();
+    this->encoder_thread.join();
+}
+
+// Reads the frame from the bound framebuffer, which waits for the GPU to
+// finish it, and queues it for the encoder.
+void frame_capture::capture(int frame, int width, int height) {
+    capture_job job;
+    job.frame = frame;
+    {
+        std::unique_lock<std::mutex> lock(this->jobs_mutex);
+        this->changed.wait(lock, [this] { return this->jobs.size() < max_queued_captures; });
+        if (!this->spare_images.empty()) {
+            job.pixels = std::move(this->spare_images.back());
+            this->spare_images.pop_back();
+        }
+    }
+    read_pixels(width, height, job.pixels);
+    {
+        std::lock_guard<std::mutex> lock(this->jobs_mutex);
+        this->jobs.push_back(std::move(job));
+    }
+    this->changed.notify_all();
+}
+
+// Waits for every queued frame to be written and rethrows the first error
+// the encoder hit, if any.
+void frame_capture::finish() {
+    std::unique_lock<std::mutex> lock(this->jobs_mutex);
+    this->changed.wait(lock, [this] { return this->jobs.empty() && this->encoding == 0; });
+    if (this->error) {
+        std::exception_ptr error = this->error;
+        this->error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void frame_capture::encode_loop() {
+    std::unique_lock<std::mutex> lock(this->jobs_mutex);
+    while (true) {
+        this->changed.wait(lock, [this] { return this->stopping || !this->jobs.empty(); });
+        if (this->jobs.empty()) {
+            return;
+        }
+        capture_job job = std::move(this->jobs.front());
+        this->jobs.pop_front();
+        this->encoding++;
+        lock.unlock();
+        this->changed.notify_all();
+
+        std::exception_ptr job_error;
+        try {
+            std::ostringstream path;
+            path << this->directory << "/frame-" << std::setw(6) << std::setfill('0') << job.frame
+                << get_image_file_extension(this->format);
+            flip_rows(job.pixels);
+            write_image_file(path.str(), job.pixels, this->format);
+        } catch (...) {
+            job_error = std::current_exception();
+        }
+
+        lock.lock();
+        if (job_error && !this->error) {
+            this->error = job_error;
+        }
+        this->spare_images.push_back(std::move(job.pixels));
+        this->encoding--;
+        this->changed.notify_all();
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef FRAME_CAPTURE_HPP_
+#define FRAME_CAPTURE_HPP_
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "engine/image.hpp"
+#include "engine/image_file.hpp"
+
+// Saves rendered frames as numbered image files for golden-image runs.
+// The render thread only reads the pixels back; flipping and encoding them
+// and writing the file happen on a background encoder thread. When the
+// encoder falls behind, capture() waits for room rather than dropping a
+// frame, so a run always produces the same set of files.
+class frame_capture {
+protected:
+    struct capture_job {
+        int frame;
+        image pixels;
+    };
+    std::string directory;
+    image_file_format format;
+    std::deque<capture_job> jobs;
+    std::vector<image> spare_images;
+    std::mutex jobs_mutex;
+    std::condition_variable changed;
+    std::thread encoder_thread;
+    bool stopping;
+    int encoding;
+    std::exception_ptr error;
+    void encode_loop();
+public:
+    frame_capture(const std::string &directory, image_file_format format);
+    frame_capture(frame_capture const &) = delete;
+    ~frame_capture();
+    void operator=(frame_capture const &) = delete;
+    void capture(int frame, int width, int height);
+    void finish();
+};
+
+#endif // FRAME_CAPTURE_HPP_
@@ -0,0 +1,69 @@
+#include <algorithm>
+
+#include <math.h>
+
+#include <SDL2/SDL.h>
+
+#include "engine/frame_pacer.hpp"
+
+frame_pacer::frame_pacer()
+    : frame_ticks(0), next_deadline(0), missed_deadlines(0),
+      sleep_estimate_ms(2.0), sleep_mean_ms(2.0), sleep_m2(0.0), sleep_count(1) {
+    this->ticks_per_sec = SDL_GetPerformanceFrequency();
+}
+
+void frame_pacer::set_target_fps(double target_fps) {
+    this->frame_ticks = target_fps > 0.0 ? (uint64_t) (this->ticks_per_sec / target_fps) : 0;
+    this->next_deadline = 0;
+}
+
+// Returns false when the frame was already past its deadline. Late frames
+// resynchronise the schedule instead of rushing to catch up.
+bool frame_pacer::wait() {
+    if (this->frame_ticks == 0) {
+        return true;
+    }
+
+    uint64_t now = SDL_GetPerformanceCounter();
+    if (this->next_deadline == 0) {
+        this->next_deadline = now;
+    }
+
+    bool on_time = now <= this->next_deadline;
+    if (on_time) {
+        this->sleep_until(this->next_deadline);
+        this->next_deadline += this->frame_ticks;
+    } else {
+        this->missed_deadlines++;
+        this->next_deadline = now + this->frame_ticks;
+    }
+    return on_time;
+}
+
+void frame_pacer::sleep_until(uint64_t deadline) {
+    double ticks_per_ms = this->ticks_per_sec / 1000.0;
+    uint64_t now = SDL_GetPerformanceCounter();
+
+    while (now < deadline && (deadline - now) / ticks_per_ms > this->sleep_estimate_ms) {
+        SDL_Delay(1);
+        uint64_t woke = SDL_GetPerformanceCounter();
+        double observed_ms = (woke - now) / ticks_per_ms;
+        now = woke;
+
+        // Welford's running variance; sleeping stops once the remaining
+        // time drops below mean + one standard deviation of a 1 ms sleep.
+        this->sleep_count++;
+        double delta = observed_ms - this->sleep_mean_ms;
+        this->sleep_mean_ms += delta / this->sleep_count;
+        this->sleep_m2 += delta * (observed_ms - this->sleep_mean_ms);
+        double stddev = sqrt(this->sleep_m2 / (this->sleep_count - 1));
+        this->sleep_estimate_ms = std::min(this->sleep_mean_ms + stddev, 4.0);
+    }
+
+    while (SDL_GetPerformanceCounter() < deadline) {
+    }
+}
+
+uint64_t frame_pacer::get_missed_deadlines() const {
+    return this->missed_deadlines;
+}
@@ -0,0 +1,35 @@
+#ifndef FRAME_PACER_HPP_
+#define FRAME_PACER_HPP_
+
+#include <stdint.h>
+
+enum class swap_mode {
+    off,
+    on,
+    adaptive,
+};
+
+// Holds frames to a target rate by sleeping in 1 ms steps while the
+// remaining time is comfortably above the observed sleep overshoot, then
+// spinning for the last stretch so the deadline is hit closely.
+class frame_pacer {
+protected:
+    uint64_t ticks_per_sec;
+    uint64_t frame_ticks;
+    uint64_t next_deadline;
+    uint64_t missed_deadlines;
+    double sleep_estimate_ms;
+    double sleep_mean_ms;
+    double sleep_m2;
+    uint64_t sleep_count;
+    void sleep_until(uint64_t deadline);
+public:
+    frame_pacer();
+    frame_pacer(frame_pacer const &) = delete;
+    void operator=(frame_pacer const &) = delete;
+    void set_target_fps(double target_fps);
+    bool wait();
+    uint64_t get_missed_deadlines() const;
+};
+
+#endif // FRAME_PACER_HPP_
@@ -0,0 +1,386 @@
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <string.h>
+
+#include <SDL2/SDL.h>
+
+#include "engine/frame_stats.hpp"
+#include "utils/utils.hpp"
+
+const char *frame_stage_names[frame_stage_count] = {
+    "input",
+    "update",
+    "draw",
+    "wait",
+    "swap",
+    "total",
+};
+
+const char *frame_counter_names[frame_counter_count] = {
+    "missed_deadlines",
+    "draw_calls",
+    "gl_state_issued",
+    "gl_state_elided",
+    "uniforms_issued",
+    "uniforms_elided",
+    "upload_bytes",
+    "drawables_visible",
+    "drawables_culled",
+    "stream_queue_depth",
+    "stream_upload_us",
+};
+
+// Upper edges in milliseconds; the last bucket catches everything above.
+const double histogram_edges_ms[frame_histogram_buckets - 1] = {
+    0.5, 1.0, 2.0, 4.0, 8.0, 16.0, 32.0, 64.0, 128.0,
+};
+
+frame_stats::frame_stats()
+    : frames_written(0), worker_count(0), current(), last_mark(0), frame_start(0), input_pending(false), input_timestamp(0) {
+    this->ticks_per_ms = SDL_GetPerformanceFrequency() / 1000.0;
+    for (auto &busy : this->worker_busy) {
+        busy.store(0, std::memory_order_relaxed);
+    }
+    for (auto &slot : this->ring) {
+        slot.sequence.store(0, std::memory_order_relaxed);
+    }
+}
+
+void frame_stats::begin_frame() {
+    this->last_mark = SDL_GetPerformanceCounter();
+    this->frame_start = this->last_mark;
+    for (auto &ticks : this->current.stage_ticks) {
+        ticks = 0;
+    }
+    for (auto &counter : this->current.counters) {
+        counter = 0;
+    }
+    this->input_pending = false;
+}
+
+void frame_stats::mark(frame_stage stage) {
+    uint64_t now = SDL_GetPerformanceCounter();
+    this->current.stage_ticks[(int) stage] += now - this->last_mark;
+    this->last_mark = now;
+}
+
+void frame_stats::count(frame_counter counter, uint32_t amount) {
+    this->current.counters[(int) counter] += amount;
+}
+
+void frame_stats::set_worker_count(int count) {
+    this->worker_count = std::min(count, frame_worker_slots);
+}
+
+int frame_stats::get_worker_count() const {
+    return this->worker_count;
+}
+
+// Takes an input event's SDL timestamp; the frame that picks it up reports
+// the time from its oldest event to the end of its swap.
+void frame_stats::note_input(uint32_t timestamp) {
+    if (!this->input_pending || (int32_t) (timestamp - this->input_timestamp) < 0) {
+        this->input_timestamp = timestamp;
+    }
+    this->input_pending = true;
+}
+
+// Workers past the last slot aren't recorded.
+void frame_stats::add_worker_ticks(int worker, uint64_t ticks) {
+    if (worker >= 0 && worker < frame_worker_slots) {
+        this->worker_busy[worker].fetch_add(ticks, std::memory_order_relaxed);
+    }
+}
+
+void frame_stats::end_frame() {
+    uint64_t index = this->frames_written.load(std::memory_order_relaxed);
+    this->current.frame_index = index;
+    this->current.stage_ticks[(int) frame_stage::total] = this->last_mark - this->frame_start;
+    for (int worker = 0; worker < frame_worker_slots; worker++) {
+        this->current.worker_ticks[worker] = this->worker_busy[worker].exchange(0, std::memory_order_relaxed);
+    }
+    this->current.input_latency_ms = this->input_pending ? SDL_GetTicks() - this->input_timestamp : -1;
+    this->input_pending = false;
+    uint64_t words[frame_slot::words] = {};
+    memcpy(words, &this->current, sizeof(this->current));
+    frame_slot &slot = this->ring[index % ring_size];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    // Orders the odd sequence before the record words, so a reader that
+    // sees any of the new words also sees the sequence change.
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t word = 0; word < frame_slot::words; word++) {
+        slot.record[word].store(words[word], std::memory_order_relaxed);
+    }
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+    this->frames_written.store(index + 1, std::memory_order_release);
+
+    this->frame_start = this->last_mark;
+    for (auto &ticks : this->current.stage_ticks) {
+        ticks = 0;
+    }
+    for (auto &counter : this->current.counters) {
+        counter = 0;
+    }
+}
+
+// Records the writer overwrote or was rewriting before they were copied
+// are dropped; a reader the writer laps can lose some from the middle of
+// the snapshot too, but never keeps a torn one.
+size_t frame_stats::snapshot(std::vector<frame_record> &records) const {
+    uint64_t end = this->frames_written.load(std::memory_order_acquire);
+    uint64_t begin = end > ring_size ? end - ring_size : 0;
+    records.clear();
+    records.reserve(end - begin);
+    uint64_t words[frame_slot::words];
+    for (uint64_t i = begin; i < end; i++) {
+        const frame_slot &slot = this->ring[i % ring_size];
+        uint64_t expected = 2 * i + 2;
+        if (slot.sequence.load(std::memory_order_acquire) != expected) {
+            continue;
+        }
+        for (size_t word = 0; word < frame_slot::words; word++) {
+            words[word] = slot.record[word].load(std::memory_order_relaxed);
+        }
+        // Orders the copy before the second sequence check.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != expected) {
+            continue;
+        }
+        frame_record record;
+        memcpy(&record, words, sizeof(record));
+        records.push_back(record);
+    }
+    return records.size();
+}
+
+stage_summary summarize_values(std::vector<double> &values) {
+    double total = 0.0;
+    for (const auto &value : values) {
+        total += value;
+    }
+    std::sort(values.begin(), values.end());
+
+    auto percentile = [&values](double p) {
+        size_t rank = (size_t) (p / 100.0 * (values.size() - 1) + 0.5);
+        return values[std::min(rank, values.size() - 1)];
+    };
+
+    stage_summary summary = {};
+    summary.frames = values.size();
+    if (!values.empty()) {
+        summary.mean_ms = total / values.size();
+        summary.p50_ms = percentile(50.0);
+        summary.p95_ms = percentile(95.0);
+        summary.p99_ms = percentile(99.0);
+        summary.max_ms = values.back();
+    }
+    return summary;
+}
+
+std::vector<int> histogram_values(const std::vector<double> &values) {
+    std::vector<int> buckets(frame_histogram_buckets, 0);
+    for (const auto &ms : values) {
+        int bucket = std::upper_bound(
+                histogram_edges_ms,
+                histogram_edges_ms + frame_histogram_buckets - 1,
+                ms) - histogram_edges_ms;
+        buckets[bucket]++;
+    }
+    return buckets;
+}
+
+std::vector<double> get_stage_ms(const std::vector<frame_record> &records, frame_stage stage, double ticks_per_ms) {
+    std::vector<double> stage_ms;
+    stage_ms.reserve(records.size());
+    for (const auto &record : records) {
+        stage_ms.push_back(record.stage_ticks[(int) stage] / ticks_per_ms);
+    }
+    return stage_ms;
+}
+
+// Only frames that picked up input count.
+std::vector<double> get_input_latency_ms(const std::vector<frame_record> &records) {
+    std::vector<double> latency_ms;
+    for (const auto &record : records) {
+        if (record.input_latency_ms >= 0) {
+            latency_ms.push_back(record.input_latency_ms);
+        }
+    }
+    return latency_ms;
+}
+
+stage_summary frame_stats::summarize(frame_stage stage) const {
+    std::vector<frame_record> records;
+    this->snapshot(records);
+    std::vector<double> stage_ms = get_stage_ms(records, stage, this->ticks_per_ms);
+    return summarize_values(stage_ms);
+}
+
+std::vector<int> frame_stats::histogram(frame_stage stage) const {
+    std::vector<frame_record> records;
+    this->snapshot(records);
+    return histogram_values(get_stage_ms(records, stage, this->ticks_per_ms));
+}
+
+stage_summary frame_stats::summarize_input_latency() const {
+    std::vector<frame_record> records;
+    this->snapshot(records);
+    std::vector<double> latency_ms = get_input_latency_ms(records);
+    return summarize_values(latency_ms);
+}
+
+std::vector<int> frame_stats::input_latency_histogram() const {
+    std::vector<frame_record> records;
+    this->snapshot(records);
+    return histogram_values(get_input_latency_ms(records));
+}
+
+double frame_stats::counter_mean(frame_counter counter) const {
+    std::vector<frame_record> records;
+    this->snapshot(records);
+
+    double total = 0.0;
+    for (const auto &record : records) {
+        total += record.counters[(int) counter];
+    }
+    return records.empty() ? 0.0 : total / records.size();
+}
+
+// Share of the recorded frames' wall time the worker spent running jobs.
+double frame_stats::worker_utilisation(int worker) const {
+    std::vector<frame_record> records;
+    this->snapshot(records);
+
+    uint64_t busy = 0;
+    uint64_t total = 0;
+    for (const auto &record : records) {
+        busy += record.worker_ticks[worker];
+        total += record.stage_ticks[(int) frame_stage::total];
+    }
+    return total > 0 ? (double) busy / total : 0.0;
+}
+
+void frame_stats::write_csv(std::ostream &out) const {
+    std::vector<frame_record> records;
+    this->snapshot(records);
+
+    out << "frame";
+    for (int stage = 0; stage < frame_stage_count; stage++) {
+        out << "," << frame_stage_names[stage] << "_ms";
+    }
+    for (int counter = 0; counter < frame_counter_count; counter++) {
+        out << "," << frame_counter_names[counter];
+    }
+    for (int worker = 0; worker < this->worker_count; worker++) {
+        out << ",worker" << worker << "_busy_ms";
+    }
+    out << ",input_latency_ms" << std::endl;
+
+    out << std::fixed << std::setprecision(4);
+    for (const auto &record : records) {
+        out << record.frame_index;
+        for (int stage = 0; stage < frame_stage_count; stage++) {
+            out << "," << record.stage_ticks[stage] / this->ticks_per_ms;
+        }
+        for (int counter = 0; counter < frame_counter_count; counter++) {
+            out << "," << record.counters[counter];
+        }
+        for (int worker = 0; worker < this->worker_count; worker++) {
+            out << "," << record.worker_ticks[worker] / this->ticks_per_ms;
+        }
+        out << ",";
+        if (record.input_latency_ms >= 0) {
+            out << record.input_latency_ms;
+        }
+        out << std::endl;
+    }
+}
+
+void frame_stats::write_json(std::ostream &out) const {
+    out << std::fixed << std::setprecision(4);
+    out << "{\"frames_recorded\": " << this->frames_written.load(std::memory_order_acquire);
+    out << ", \"histogram_edges_ms\": [";
+    for (int i = 0; i < frame_histogram_buckets - 1; i++) {
+        out << (i ? ", " : "") << histogram_edges_ms[i];
+    }
+    out << "], \"stages\": {";
+    for (int stage = 0; stage < frame_stage_count; stage++) {
+        stage_summary summary = this->summarize((frame_stage) stage);
+        std::vector<int> buckets = this->histogram((frame_stage) stage);
+        out << (stage ? ", " : "") << "\"" << frame_stage_names[stage] << "\": {"
+            << "\"mean_ms\": " << summary.mean_ms
+            << ", \"p50_ms\": " << summary.p50_ms
+            << ", \"p95_ms\": " << summary.p95_ms
+            << ", \"p99_ms\": " << summary.p99_ms
+            << ", \"max_ms\": " << summary.max_ms
+            << ", \"histogram\": [";
+        for (int i = 0; i < frame_histogram_buckets; i++) {
+            out << (i ? ", " : "") << buckets[i];
+        }
+        out << "]}";
+    }
+    out << "}, \"counters_mean\": {";
+    for (int counter = 0; counter < frame_counter_count; counter++) {
+        out << (counter ? ", " : "") << "\"" << frame_counter_names[counter] << "\": "
+            << this->counter_mean((frame_counter) counter);
+    }
+    out << "}, \"worker_utilisation\": [";
+    for (int worker = 0; worker < this->worker_count; worker++) {
+        out << (worker ? ", " : "") << this->worker_utilisation(worker);
+    }
+    stage_summary latency = this->summarize_input_latency();
+    std::vector<int> latency_buckets = this->input_latency_histogram();
+    out << "], \"input_latency\": {"
+        << "\"frames\": " << latency.frames
+        << ", \"mean_ms\": " << latency.mean_ms
+        << ", \"p50_ms\": " << latency.p50_ms
+        << ", \"p95_ms\": " << latency.p95_ms
+        << ", \"p99_ms\": " << latency.p99_ms
+        << ", \"max_ms\": " << latency.max_ms
+        << ", \"histogram\": [";
+    for (int i = 0; i < frame_histogram_buckets; i++) {
+        out << (i ? ", " : "") << latency_buckets[i];
+    }
+    out << "]}}" << std::endl;
+}
+
+void frame_stats::set_dump_path(const std::string &path) {
+    this->dump_path = path;
+}
+
+void frame_stats::dump() const {
+    if (this->dump_path.empty()) {
+        return;
+    }
+
+    std::ofstream out(this->dump_path);
+    if (!out) {
+        throw std::runtime_error("couldn't open \"" + this->dump_path + "\"");
+    }
+
+    if (has_suffix(this->dump_path, ".json")) {
+        this->write_json(out);
+    } else {
+        this->write_csv(out);
+    }
+}
+
+frame_stats &get_frame_stats() {
+    static frame_stats stats;
+    return stats;
+}
+
+const char *get_frame_stage_name(frame_stage stage) {
+    return frame_stage_names[(int) stage];
+}
+
+const char *get_frame_counter_name(frame_counter counter) {
+    return frame_counter_names[(int) counter];
+}
@@ -0,0 +1,118 @@
+#ifndef FRAME_STATS_HPP_
+#define FRAME_STATS_HPP_
+
+#include <atomic>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+enum class frame_stage {
+    input,
+    update,
+    draw,
+    wait,
+    swap,
+    total,
+};
+
+const int frame_stage_count = 6;
+
+enum class frame_counter {
+    missed_deadlines,
+    draw_calls,
+    gl_state_issued,
+    gl_state_elided,
+    uniforms_issued,
+    uniforms_elided,
+    upload_bytes,
+    drawables_visible,
+    drawables_culled,
+    stream_queue_depth,
+    stream_upload_us,
+};
+
+const int frame_counter_count = 11;
+const int frame_histogram_buckets = 10;
+const int frame_worker_slots = 16;
+
+struct frame_record {
+    uint64_t frame_index;
+    uint64_t stage_ticks[frame_stage_count];
+    uint32_t counters[frame_counter_count];
+    uint64_t worker_ticks[frame_worker_slots];
+    // From the oldest input event the frame picked up to its present, or
+    // -1 when there was none.
+    int32_t input_latency_ms;
+};
+
+struct stage_summary {
+    int frames;
+    double mean_ms;
+    double p50_ms;
+    double p95_ms;
+    double p99_ms;
+    double max_ms;
+};
+
+// One ring entry as a seqlock: the sequence is odd while the render thread
+// writes the record and 2 * (frame index + 1) once it is complete. The
+// record is kept in atomic words so copying it while it is being rewritten
+// is not a data race, only a torn copy the sequence check rejects.
+struct frame_slot {
+    static const size_t words = (sizeof(frame_record) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    std::atomic<uint64_t> sequence;
+    std::atomic<uint64_t> record[words];
+};
+
+// Records per-stage timings for each frame into a fixed-size ring. Only the
+// render thread writes; readers on any thread take consistent snapshots
+// without locking, keeping only the records whose slot sequence was the
+// same, and the one expected for that frame, before and after copying.
+// Job workers add the time they spent running jobs from any thread; it is
+// folded into the frame that is current when they finish.
+class frame_stats {
+protected:
+    static const size_t ring_size = 1024;
+    frame_slot ring[ring_size];
+    std::atomic<uint64_t> frames_written;
+    std::atomic<uint64_t> worker_busy[frame_worker_slots];
+    int worker_count;
+    frame_record current;
+    uint64_t last_mark;
+    uint64_t frame_start;
+    bool input_pending;
+    uint32_t input_timestamp;
+    double ticks_per_ms;
+    std::string dump_path;
+public:
+    frame_stats();
+    frame_stats(frame_stats const &) = delete;
+    void operator=(frame_stats const &) = delete;
+    void begin_frame();
+    void mark(frame_stage stage);
+    void count(frame_counter counter, uint32_t amount = 1);
+    void set_worker_count(int count);
+    int get_worker_count() const;
+    void add_worker_ticks(int worker, uint64_t ticks);
+    void note_input(uint32_t timestamp);
+    void end_frame();
+    size_t snapshot(std::vector<frame_record> &records) const;
+    stage_summary summarize(frame_stage stage) const;
+    std::vector<int> histogram(frame_stage stage) const;
+    stage_summary summarize_input_latency() const;
+    std::vector<int> input_latency_histogram() const;
+    double counter_mean(frame_counter counter) const;
+    double worker_utilisation(int worker) const;
+    void write_csv(std::ostream &out) const;
+    void write_json(std::ostream &out) const;
+    void set_dump_path(const std::string &path);
+    void dump() const;
+};
+
+frame_stats &get_frame_stats();
+const char *get_frame_stage_name(frame_stage stage);
+const char *get_frame_counter_name(frame_counter counter);
+
+#endif // FRAME_STATS_HPP_
@@ -0,0 +1,124 @@
+#include <stdexcept>
+#include <string>
+
+#include <stdint.h>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/framebuffer.hpp"
+#include "engine/gl_check.hpp"
+#include "engine/gl_functions.hpp"
+#include "engine/gl_state.hpp"
+#include "engine/image.hpp"
+
+std::string get_framebuffer_status_name(GLenum status) {
+    switch (status) {
+        case GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT:
+            return "incomplete attachment";
+        case GL_FRAMEBUFFER_INCOMPLETE_DIMENSIONS:
+            return "incomplete dimensions";
+        case GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT:
+            return "missing attachment";
+        case GL_FRAMEBUFFER_UNSUPPORTED:
+            return "unsupported";
+        default:
+            return "status " + std::to_string(status);
+    }
+}
+
+framebuffer::framebuffer(int width, int height, framebuffer_color color, bool depth)
+    : framebuffer_id(0), color_texture_id(0), color_renderbuffer_id(0), depth_renderbuffer_id(0),
+      width(width), height(height) {
+    GL_CALL(glGenFramebuffers(1, &this->framebuffer_id));
+    get_gl_state().bind_framebuffer(this->framebuffer_id);
+
+    if (color == framebuffer_color::texture) {
+        // Not a power of two in general, so no mips and no repeat.
+        GL_CALL(glGenTextures(1, &this->color_texture_id));
+        get_gl_state().bind_texture(0, this->color_texture_id);
+        GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL));
+        GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+        GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+        GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+        GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+        GL_CALL(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->color_texture_id, 0));
+    } else {
+        GLenum format = SDL_GL_ExtensionSupported("GL_OES_rgb8_rgba8") ? GL_RGBA8_OES : GL_RGBA4;
+        GL_CALL(glGenRenderbuffers(1, &this->color_renderbuffer_id));
+        GL_CALL(glBindRenderbuffer(GL_RENDERBUFFER, this->color_renderbuffer_id));
+        GL_CALL(glRenderbufferStorage(GL_RENDERBUFFER, format, width, height));
+        GL_CALL(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->color_renderbuffer_id));
+    }
+
+    if (depth) {
+        GLenum format = SDL_GL_ExtensionSupported("GL_OES_depth24") ? GL_DEPTH_COMPONENT24_OES : GL_DEPTH_COMPONENT16;
+        GL_CALL(glGenRenderbuffers(1, &this->depth_renderbuffer_id));
+        GL_CALL(glBindRenderbuffer(GL_RENDERBUFFER, this->depth_renderbuffer_id));
+        GL_CALL(glRenderbufferStorage(GL_RENDERBUFFER, format, width, height));
+        GL_CALL(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, this->depth_renderbuffer_id));
+    }
+
+    GLenum status = GL_CALL(glCheckFramebufferStatus(GL_FRAMEBUFFER));
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::string message = "framebuffer " + std::to_string(width) + "x" + std::to_string(height)
+            + " isn't complete: " + get_framebuffer_status_name(status);
+        this->release();
+        throw std::runtime_error(message);
+    }
+}
+
+framebuffer::~framebuffer() {
+    this->release();
+}
+
+void framebuffer::release() {
+    get_gl_state().forget_framebuffer(this->framebuffer_id);
+    glDeleteFramebuffers(1, &this->framebuffer_id);
+    if (this->color_texture_id != 0) {
+        get_gl_state().forget_texture(this->color_texture_id);
+        glDeleteTextures(1, &this->color_texture_id);
+    }
+    if (this->color_renderbuffer_id != 0) {
+        glDeleteRenderbuffers(1, &this->color_renderbuffer_id);
+    }
+    if (this->depth_renderbuffer_id != 0) {
+        glDeleteRenderbuffers(1, &this->depth_renderbuffer_id);
+    }
+}
+
+// Also sets the viewport to cover the whole target.
+void framebuffer::bind() {
+    get_gl_state().bind_framebuffer(this->framebuffer_id);
+    GL_CALL(glViewport(0, 0, this->width, this->height));
+}
+
+// Zero for a renderbuffer colour attachment.
+uint32_t framebuffer::get_color_texture() const {
+    return this->color_texture_id;
+}
+
+int framebuffer::get_width() const {
+    return this->width;
+}
+
+int framebuffer::get_height() const {
+    return this->height;
+}
+
+void bind_default_framebuffer(int width, int height) {
+    get_gl_state().bind_framebuffer(0);
+    GL_CALL(glViewport(0, 0, width, height));
+}
+
+// Reads the bottom-left width by height pixels of the bound framebuffer
+// as RGBA, rows bottom to top as GL stores them. This waits for all
+// rendering queued so far; ES 2.0 has no asynchronous readback. Reusing
+// the result between frames saves reallocating its pixels.
+void read_pixels(int width, int height, image &result) {
+    result.width = width;
+    result.height = height;
+    result.channels = 4;
+    result.pixels.resize((size_t) width * height * 4);
+    GL_CALL(glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, result.pixels.data()));
+}
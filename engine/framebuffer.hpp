@@ -0,0 +1,41 @@
+#ifndef FRAMEBUFFER_HPP_
+#define FRAMEBUFFER_HPP_
+
+#include <stdint.h>
+
+#include "engine/image.hpp"
+
+enum class framebuffer_color {
+    // An RGBA texture that can be sampled once rendered.
+    texture,
+    // A renderbuffer, 8 bits per channel where GL_OES_rgb8_rgba8 allows
+    // and RGBA4 otherwise.
+    renderbuffer,
+};
+
+// An offscreen render target with a colour attachment and optionally a
+// depth renderbuffer, bound through gl_state.
+class framebuffer {
+protected:
+    uint32_t framebuffer_id;
+    uint32_t color_texture_id;
+    uint32_t color_renderbuffer_id;
+    uint32_t depth_renderbuffer_id;
+    int width;
+    int height;
+    void release();
+public:
+    framebuffer(int width, int height, framebuffer_color color = framebuffer_color::texture, bool depth = true);
+    framebuffer(framebuffer const &) = delete;
+    ~framebuffer();
+    void operator=(framebuffer const &) = delete;
+    void bind();
+    uint32_t get_color_texture() const;
+    int get_width() const;
+    int get_height() const;
+};
+
+void bind_default_framebuffer(int width, int height);
+void read_pixels(int width, int height, image &result);
+
+#endif // FRAMEBUFFER_HPP_
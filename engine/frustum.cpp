@@ -0,0 +1,107 @@
+#include <math.h>
+
+#include "engine/frustum.hpp"
+
+#if defined(ENGINE_MATH_SSE2)
+#include <emmintrin.h>
+#elif defined(ENGINE_MATH_NEON)
+#include <arm_neon.h>
+#endif
+
+vec4 normalize_plane(const vec4 &plane) {
+    float length = sqrtf(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+    return length > 0.0f ? plane * (1.0f / length) : plane;
+}
+
+// Gribb/Hartmann: each clip-space plane is a sum or difference of the
+// fourth row of the matrix and one of the others. The planes are
+// normalized so that sphere radii can be compared with the distances.
+frustum frustum_from_matrix(const mat4 &m) {
+    mat4 t = mat4_transpose(m);
+    const vec4 *rows = t.columns;
+    frustum f;
+    f.planes[0] = normalize_plane(rows[3] + rows[0]);
+    f.planes[1] = normalize_plane(rows[3] - rows[0]);
+    f.planes[2] = normalize_plane(rows[3] + rows[1]);
+    f.planes[3] = normalize_plane(rows[3] - rows[1]);
+    f.planes[4] = normalize_plane(rows[3] + rows[2]);
+    f.planes[5] = normalize_plane(rows[3] - rows[2]);
+    return f;
+}
+
+// In view space, matching mat4_perspective.
+frustum frustum_from_perspective(float frustum_scale, float z_near, float z_far) {
+    return frustum_from_matrix(mat4_perspective(frustum_scale, z_near, z_far));
+}
+
+size_t cull_spheres_scalar(
+        const frustum &f,
+        const float *x,
+        const float *y,
+        const float *z,
+        const float *radius,
+        size_t count,
+        uint8_t *visible) {
+    size_t visible_count = 0;
+    for (size_t i = 0; i < count; i++) {
+        bool inside = true;
+        for (const auto &p : f.planes) {
+            inside = inside && p.x * x[i] + p.y * y[i] + p.z * z[i] + p.w >= -radius[i];
+        }
+        visible[i] = inside;
+        visible_count += inside;
+    }
+    return visible_count;
+}
+
+size_t cull_spheres(
+        const frustum &f,
+        const float *x,
+        const float *y,
+        const float *z,
+        const float *radius,
+        size_t count,
+        uint8_t *visible) {
+    size_t i = 0;
+    size_t visible_count = 0;
+#if defined(ENGINE_MATH_SSE2)
+    for (; i + 4 <= count; i += 4) {
+        __m128 px = _mm_loadu_ps(x + i);
+        __m128 py = _mm_loadu_ps(y + i);
+        __m128 pz = _mm_loadu_ps(z + i);
+        __m128 neg_r = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius + i));
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const auto &p : f.planes) {
+            __m128 d = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(p.x)), _mm_mul_ps(py, _mm_set1_ps(p.y)));
+            d = _mm_add_ps(d, _mm_add_ps(_mm_mul_ps(pz, _mm_set1_ps(p.z)), _mm_set1_ps(p.w)));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(d, neg_r));
+        }
+        int mask = _mm_movemask_ps(inside);
+        for (int lane = 0; lane < 4; lane++) {
+            visible[i + lane] = (mask >> lane) & 1;
+            visible_count += (mask >> lane) & 1;
+        }
+    }
+#elif defined(ENGINE_MATH_NEON)
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t px = vld1q_f32(x + i);
+        float32x4_t py = vld1q_f32(y + i);
+        float32x4_t pz = vld1q_f32(z + i);
+        float32x4_t neg_r = vnegq_f32(vld1q_f32(radius + i));
+        uint32x4_t inside = vdupq_n_u32(0xffffffff);
+        for (const auto &p : f.planes) {
+            float32x4_t d = vmlaq_n_f32(vdupq_n_f32(p.w), px, p.x);
+            d = vmlaq_n_f32(d, py, p.y);
+            d = vmlaq_n_f32(d, pz, p.z);
+            inside = vandq_u32(inside, vcgeq_f32(d, neg_r));
+        }
+        uint32_t lanes[4];
+        vst1q_u32(lanes, inside);
+        for (int lane = 0; lane < 4; lane++) {
+            visible[i + lane] = lanes[lane] != 0;
+            visible_count += lanes[lane] != 0;
+        }
+    }
+#endif
+    return visible_count + cull_spheres_scalar(f, x + i, y + i, z + i, radius + i, count - i, visible + i);
+}
@@ -0,0 +1,40 @@
+#ifndef FRUSTUM_HPP_
+#define FRUSTUM_HPP_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "engine/math.hpp"
+
+struct bounding_box {
+    vec3 min;
+    vec3 max;
+};
+
+struct bounding_sphere {
+    vec3 center;
+    float radius;
+};
+
+// Six planes (x, y, z, w) with the inside where x*px + y*py + z*pz + w >= 0,
+// in the order left, right, bottom, top, near, far.
+struct frustum {
+    vec4 planes[6];
+};
+
+frustum frustum_from_matrix(const mat4 &m);
+frustum frustum_from_perspective(float frustum_scale, float z_near, float z_far);
+
+// Tests packed sphere arrays against the frustum, four at a time where SIMD
+// is available, and writes 1 to visible for every sphere that intersects
+// it. Returns the number of visible spheres.
+size_t cull_spheres(
+        const frustum &f,
+        const float *x,
+        const float *y,
+        const float *z,
+        const float *radius,
+        size_t count,
+        uint8_t *visible);
+
+#endif // FRUSTUM_HPP_
@@ -0,0 +1,97 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <stdint.h>
+
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/gl_check.hpp"
+#include "engine/gl_functions.hpp"
+
+// GL keeps one flag per error kind, so draining takes at most this many
+// calls; the bound only matters for a lost context that keeps reporting.
+const int max_gl_errors = 8;
+
+const char *get_gl_error_name(GLenum error) {
+    switch (error) {
+        case GL_NO_ERROR:
+            return "no error";
+        case GL_INVALID_ENUM:
+            return "invalid enum";
+        case GL_INVALID_VALUE:
+            return "invalid value";
+        case GL_INVALID_OPERATION:
+            return "invalid operation";
+        case GL_INVALID_FRAMEBUFFER_OPERATION:
+            return "invalid framebuffer operation";
+        case GL_OUT_OF_MEMORY:
+            return "out of memory";
+        default:
+            return "unknown error";
+    }
+}
+
+#if GL_CHECK_MODE != GL_CHECK_OFF
+
+// Sampled builds check the first frame too, which covers the resources the
+// modules create at startup.
+bool gl_checks_active = true;
+uint64_t gl_check_frame = 0;
+
+std::string drain_gl_errors() {
+    std::string errors;
+    for (int i = 0; i < max_gl_errors; i++) {
+        GLenum error = glGetError();
+        if (error == GL_NO_ERROR) {
+            break;
+        }
+        errors += (errors.empty() ? "" : ", ") + std::string(get_gl_error_name(error));
+    }
+    return errors;
+}
+
+void check_gl_errors(const char *file, int line, const char *call) {
+    GLenum error = glGetError();
+    if (error == GL_NO_ERROR) {
+        return;
+    }
+    std::string message = std::string(file) + ":" + std::to_string(line) + ": " + call + ": "
+        + get_gl_error_name(error);
+    std::string more = drain_gl_errors();
+    if (!more.empty()) {
+        message += ", " + more;
+    }
+#if GL_CHECK_MODE == GL_CHECK_ALWAYS
+    throw std::runtime_error(message);
+#else
+    std::cerr << "gl error at " << message << " (frame " << gl_check_frame << ")" << std::endl;
+#endif
+}
+
+// For calls where an error is an expected outcome that the caller handles,
+// such as the driver rejecting a cached program binary.
+void clear_gl_errors() {
+    if (gl_checks_active) {
+        drain_gl_errors();
+    }
+}
+
+// Called once per frame by the window. Errors raised by unchecked frames
+// are still pending when sampling starts again, and are reported on their
+// own rather than blamed on the first checked call.
+void advance_gl_check_frame() {
+#if GL_CHECK_MODE == GL_CHECK_SAMPLED
+    gl_check_frame++;
+    gl_checks_active = gl_check_frame % GL_CHECK_SAMPLE_FRAMES == 0;
+    if (gl_checks_active) {
+        std::string errors = drain_gl_errors();
+        if (!errors.empty()) {
+            std::cerr << "gl error in the " << GL_CHECK_SAMPLE_FRAMES - 1 << " frames before frame "
+                << gl_check_frame << ": " << errors << std::endl;
+        }
+    }
+#endif
+}
+
+#endif
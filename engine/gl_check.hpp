@@ -0,0 +1,78 @@
+#ifndef GL_CHECK_HPP_
+#define GL_CHECK_HPP_
+
+#include <SDL2/SDL_opengles2.h>
+
+// GL_CALL(glFoo(...)) wraps a GL call with a glGetError check that reports
+// the call and its file and line. glGetError is a pipeline sync on many
+// drivers, so how much of this gets compiled in is picked by GL_CHECK_MODE:
+//   GL_CHECK_OFF      GL_CALL(call) is the bare call
+//   GL_CHECK_ALWAYS   every call is checked and errors are thrown
+//   GL_CHECK_SAMPLED  every call is checked on one frame in
+//                     GL_CHECK_SAMPLE_FRAMES and errors are logged to
+//                     stderr, for diagnosing builds that ship
+// Without a mode from the build, checks are on unless NDEBUG is defined.
+// Calls made outside GL_CALL aren't checked; their errors are reported
+// against the next checked call. Destructors call GL directly, since a
+// check throwing there would terminate.
+#define GL_CHECK_OFF 0
+#define GL_CHECK_ALWAYS 1
+#define GL_CHECK_SAMPLED 2
+
+#ifndef GL_CHECK_MODE
+#ifdef NDEBUG
+#define GL_CHECK_MODE GL_CHECK_OFF
+#else
+#define GL_CHECK_MODE GL_CHECK_ALWAYS
+#endif
+#endif
+
+#ifndef GL_CHECK_SAMPLE_FRAMES
+#define GL_CHECK_SAMPLE_FRAMES 600
+#endif
+
+const char *get_gl_error_name(GLenum error);
+
+#if GL_CHECK_MODE == GL_CHECK_OFF
+
+#define GL_CALL(call) (call)
+
+inline void clear_gl_errors() {
+}
+
+inline void advance_gl_check_frame() {
+}
+
+#else
+
+extern bool gl_checks_active;
+
+void check_gl_errors(const char *file, int line, const char *call);
+void clear_gl_errors();
+void advance_gl_check_frame();
+
+// Created ahead of the call in GL_CALL and destroyed at the end of the
+// full expression, so the check runs right after the call returns while
+// the call's result, if any, is still the value of the expression.
+class gl_call_site {
+protected:
+    const char *file;
+    int line;
+    const char *call;
+public:
+    gl_call_site(const char *file, int line, const char *call) : file(file), line(line), call(call) {
+    }
+    gl_call_site(gl_call_site const &) = delete;
+    ~gl_call_site() noexcept(false) {
+        if (gl_checks_active) {
+            check_gl_errors(this->file, this->line, this->call);
+        }
+    }
+    void operator=(gl_call_site const &) = delete;
+};
+
+#define GL_CALL(call) (gl_call_site(__FILE__, __LINE__, #call), (call))
+
+#endif
+
+#endif // GL_CHECK_HPP_
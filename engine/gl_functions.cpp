@@ -0,0 +1,61 @@
+// The tables are filled with the real entry points, so the names mustn't
+// be redirected to them here.
+#define GL_FUNCTIONS_NO_REDIRECT
+
+#include <string.h>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/gl_functions.hpp"
+#include "engine/gl_trace.hpp"
+
+#define GL_LINKED_FUNCTION(ret, name, params, args, kinds) &name,
+#define GL_MISSING_FUNCTION(ret, name, params, args, kinds) NULL,
+#define GL_FUNCTION_NAME(ret, name, params, args, kinds) #name,
+#define GL_FUNCTION_KINDS(ret, name, params, args, kinds) kinds,
+
+gl_function_table gl_functions = {GL_FUNCTIONS(GL_LINKED_FUNCTION) GL_OPTIONAL_FUNCTIONS(GL_MISSING_FUNCTION)};
+gl_function_table gl_driver_functions = {GL_FUNCTIONS(GL_LINKED_FUNCTION) GL_OPTIONAL_FUNCTIONS(GL_MISSING_FUNCTION)};
+
+const char *gl_function_names[] = {GL_ALL_FUNCTIONS(GL_FUNCTION_NAME)};
+const char *gl_function_kinds[] = {GL_ALL_FUNCTIONS(GL_FUNCTION_KINDS)};
+
+// Needs a current context. Entry points the driver doesn't hand out keep
+// the linked function; extension entry points are looked up afresh for
+// every context and become NULL where it has none.
+void load_gl_functions() {
+#define GL_LOAD_FUNCTION(ret, name, params, args, kinds) \
+    if (void *address = SDL_GL_GetProcAddress(#name)) { \
+        gl_driver_functions.name = (ret (GL_APIENTRY *) params) address; \
+    }
+#define GL_LOAD_OPTIONAL_FUNCTION(ret, name, params, args, kinds) \
+    gl_driver_functions.name = (ret (GL_APIENTRY *) params) SDL_GL_GetProcAddress(#name);
+    GL_FUNCTIONS(GL_LOAD_FUNCTION)
+    GL_OPTIONAL_FUNCTIONS(GL_LOAD_OPTIONAL_FUNCTION)
+#undef GL_LOAD_OPTIONAL_FUNCTION
+#undef GL_LOAD_FUNCTION
+    get_gl_tracer().update_dispatch();
+}
+
+// By name, since sources that call GL through the table can't spell the
+// table's members or the function ids. Some drivers hand out addresses
+// for extensions they don't support, so this doesn't replace checking
+// the extension string.
+bool is_gl_function_loaded(const char *function_name) {
+#define GL_FUNCTION_LOADED(ret, name, params, args, kinds) \
+    if (strcmp(function_name, #name) == 0) { \
+        return gl_driver_functions.name != NULL; \
+    }
+    GL_ALL_FUNCTIONS(GL_FUNCTION_LOADED)
+#undef GL_FUNCTION_LOADED
+    return false;
+}
+
+const char *get_gl_function_name(gl_function_id function) {
+    return gl_function_names[(int) function];
+}
+
+const char *get_gl_function_kinds(gl_function_id function) {
+    return gl_function_kinds[(int) function];
+}
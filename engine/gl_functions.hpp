@@ -0,0 +1,219 @@
+#ifndef GL_FUNCTIONS_HPP_
+#define GL_FUNCTIONS_HPP_
+
+#include <SDL2/SDL_opengles2.h>
+
+// Every GL entry point the program calls, as
+// X(return type, name, parameters, arguments, argument kinds), where each
+// kind says how the trace prints the argument: e enum, x bitfield, i int,
+// u unsigned, b boolean, f float, o offset into a bound buffer, p pointer.
+#define GL_FUNCTIONS(X) \
+    X(void, glActiveTexture, (GLenum texture), (texture), "e") \
+    X(void, glAttachShader, (GLuint program, GLuint shader), (program, shader), "uu") \
+    X(void, glBindAttribLocation, (GLuint program, GLuint index, const GLchar *name), (program, index, name), "uup") \
+    X(void, glBindBuffer, (GLenum target, GLuint buffer), (target, buffer), "eu") \
+    X(void, glBindFramebuffer, (GLenum target, GLuint framebuffer), (target, framebuffer), "eu") \
+    X(void, glBindRenderbuffer, (GLenum target, GLuint renderbuffer), (target, renderbuffer), "eu") \
+    X(void, glBindTexture, (GLenum target, GLuint texture), (target, texture), "eu") \
+    X(void, glBlendFunc, (GLenum sfactor, GLenum dfactor), (sfactor, dfactor), "ee") \
+    X(void, glBufferData, (GLenum target, GLsizeiptr size, const void *data, GLenum usage), \
+            (target, size, data, usage), "eipe") \
+    X(void, glBufferSubData, (GLenum target, GLintptr offset, GLsizeiptr size, const void *data), \
+            (target, offset, size, data), "eiip") \
+    X(GLenum, glCheckFramebufferStatus, (GLenum target), (target), "e") \
+    X(void, glClear, (GLbitfield mask), (mask), "x") \
+    X(void, glClearColor, (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha), (red, green, blue, alpha), "ffff") \
+    X(void, glCompileShader, (GLuint shader), (shader), "u") \
+    X(void, glCompressedTexImage2D, (GLenum target, GLint level, GLenum internalformat, GLsizei width, \
+            GLsizei height, GLint border, GLsizei imageSize, const void *data), \
+            (target, level, internalformat, width, height, border, imageSize, data), "eieiiiip") \
+    X(GLuint, glCreateProgram, (void), (), "") \
+    X(GLuint, glCreateShader, (GLenum type), (type), "e") \
+    X(void, glCullFace, (GLenum mode), (mode), "e") \
+    X(void, glDeleteBuffers, (GLsizei n, const GLuint *buffers), (n, buffers), "ip") \
+    X(void, glDeleteFramebuffers, (GLsizei n, const GLuint *framebuffers), (n, framebuffers), "ip") \
+    X(void, glDeleteProgram, (GLuint program), (program), "u") \
+    X(void, glDeleteRenderbuffers, (GLsizei n, const GLuint *renderbuffers), (n, renderbuffers), "ip") \
+    X(void, glDeleteShader, (GLuint shader), (shader), "u") \
+    X(void, glDeleteTextures, (GLsizei n, const GLuint *textures), (n, textures), "ip") \
+    X(void, glDetachShader, (GLuint program, GLuint shader), (program, shader), "uu") \
+    X(void, glDisableVertexAttribArray, (GLuint index), (index), "u") \
+    X(void, glDrawArrays, (GLenum mode, GLint first, GLsizei count), (mode, first, count), "eii") \
+    X(void, glDrawElements, (GLenum mode, GLsizei count, GLenum type, const void *indices), \
+            (mode, count, type, indices), "eieo") \
+    X(void, glEnable, (GLenum cap), (cap), "e") \
+    X(void, glEnableVertexAttribArray, (GLuint index), (index), "u") \
+    X(void, glFinish, (void), (), "") \
+    X(void, glFramebufferRenderbuffer, (GLenum target, GLenum attachment, GLenum renderbuffertarget, \
+            GLuint renderbuffer), (target, attachment, renderbuffertarget, renderbuffer), "eeeu") \
+    X(void, glFramebufferTexture2D, (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, \
+            GLint level), (target, attachment, textarget, texture, level), "eeeui") \
+    X(void, glFrontFace, (GLenum mode), (mode), "e") \
+    X(void, glGenBuffers, (GLsizei n, GLuint *buffers), (n, buffers), "ip") \
+    X(void, glGenFramebuffers, (GLsizei n, GLuint *framebuffers), (n, framebuffers), "ip") \
+    X(void, glGenRenderbuffers, (GLsizei n, GLuint *renderbuffers), (n, renderbuffers), "ip") \
+    X(void, glGenTextures, (GLsizei n, GLuint *textures), (n, textures), "ip") \
+    X(void, glGenerateMipmap, (GLenum target), (target), "e") \
+    X(void, glGetAttachedShaders, (GLuint program, GLsizei maxCount, GLsizei *count, GLuint *shaders), \
+            (program, maxCount, count, shaders), "uipp") \
+    X(GLint, glGetAttribLocation, (GLuint program, const GLchar *name), (program, name), "up") \
+    X(GLenum, glGetError, (void), (), "") \
+    X(void, glGetIntegerv, (GLenum pname, GLint *data), (pname, data), "ep") \
+    X(void, glGetProgramInfoLog, (GLuint program, GLsizei bufSize, GLsizei *length, GLchar *infoLog), \
+            (program, bufSize, length, infoLog), "uipp") \
+    X(void, glGetProgramiv, (GLuint program, GLenum pname, GLint *params), (program, pname, params), "uep") \
+    X(void, glGetShaderInfoLog, (GLuint shader, GLsizei bufSize, GLsizei *length, GLchar *infoLog), \
+            (shader, bufSize, length, infoLog), "uipp") \
+    X(void, glGetShaderiv, (GLuint shader, GLenum pname, GLint *params), (shader, pname, params), "uep") \
+    X(const GLubyte *, glGetString, (GLenum name), (name), "e") \
+    X(GLint, glGetUniformLocation, (GLuint program, const GLchar *name), (program, name), "up") \
+    X(void, glLinkProgram, (GLuint program), (program), "u") \
+    X(void, glPixelStorei, (GLenum pname, GLint param), (pname, param), "ei") \
+    X(void, glReadPixels, (GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, \
+            void *pixels), (x, y, width, height, format, type, pixels), "iiiieep") \
+    X(void, glRenderbufferStorage, (GLenum target, GLenum internalformat, GLsizei width, GLsizei height), \
+            (target, internalformat, width, height), "eeii") \
+    X(void, glShaderSource, (GLuint shader, GLsizei count, const GLchar *const *string, const GLint *length), \
+            (shader, count, string, length), "uipp") \
+    X(void, glTexImage2D, (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, \
+            GLint border, GLenum format, GLenum type, const void *pixels), \
+            (target, level, internalformat, width, height, border, format, type, pixels), "eieiiieep") \
+    X(void, glTexParameteri, (GLenum target, GLenum pname, GLint param), (target, pname, param), "eee") \
+    X(void, glUniform1f, (GLint location, GLfloat v0), (location, v0), "if") \
+    X(void, glUniform1i, (GLint location, GLint v0), (location, v0), "ii") \
+    X(void, glUniform2fv, (GLint location, GLsizei count, const GLfloat *value), (location, count, value), "iip") \
+    X(void, glUniform3fv, (GLint location, GLsizei count, const GLfloat *value), (location, count, value), "iip") \
+    X(void, glUniform4fv, (GLint location, GLsizei count, const GLfloat *value), (location, count, value), "iip") \
+    X(void, glUniformMatrix4fv, (GLint location, GLsizei count, GLboolean transpose, const GLfloat *value), \
+            (location, count, transpose, value), "iibp") \
+    X(void, glUseProgram, (GLuint program), (program), "u") \
+    X(void, glVertexAttribPointer, (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, \
+            const void *pointer), (index, size, type, normalized, stride, pointer), "uiebio") \
+    X(void, glViewport, (GLint x, GLint y, GLsizei width, GLsizei height), (x, y, width, height), "iiii")
+
+// Extension entry points, in the same form. The program doesn't link
+// against these, so they are NULL until a context that hands them out is
+// created; callers check is_gl_function_loaded() along with the extension.
+#define GL_OPTIONAL_FUNCTIONS(X) \
+    X(void, glGetProgramBinaryOES, (GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary), \
+        (program, bufSize, length, binaryFormat, binary), "uippp") \
+    X(void *, glMapBufferOES, (GLenum target, GLenum access), (target, access), "ee") \
+    X(void, glMaxShaderCompilerThreadsKHR, (GLuint count), (count), "u") \
+    X(void, glProgramBinaryOES, (GLuint program, GLenum binaryFormat, const void *binary, GLint length), \
+        (program, binaryFormat, binary, length), "uepi") \
+    X(GLboolean, glUnmapBufferOES, (GLenum target), (target), "e")
+
+#define GL_ALL_FUNCTIONS(X) GL_FUNCTIONS(X) GL_OPTIONAL_FUNCTIONS(X)
+
+#define GL_FUNCTION_POINTER(ret, name, params, args, kinds) ret (GL_APIENTRY *name) params;
+
+struct gl_function_table {
+    GL_ALL_FUNCTIONS(GL_FUNCTION_POINTER)
+};
+
+#undef GL_FUNCTION_POINTER
+
+#define GL_FUNCTION_ID(ret, name, params, args, kinds) name,
+
+enum class gl_function_id {
+    GL_ALL_FUNCTIONS(GL_FUNCTION_ID)
+};
+
+#undef GL_FUNCTION_ID
+
+#define GL_FUNCTION_COUNT(ret, name, params, args, kinds) + 1
+
+const int gl_function_count = 0 GL_ALL_FUNCTIONS(GL_FUNCTION_COUNT);
+
+#undef GL_FUNCTION_COUNT
+
+// The table GL calls go through. It starts out pointing at the functions
+// the program links against and is reloaded from the driver when a
+// context is created; tracing swaps in wrappers.
+extern gl_function_table gl_functions;
+// What the driver returned, which the tracing wrappers call.
+extern gl_function_table gl_driver_functions;
+
+void load_gl_functions();
+bool is_gl_function_loaded(const char *function_name);
+const char *get_gl_function_name(gl_function_id function);
+const char *get_gl_function_kinds(gl_function_id function);
+
+// Sources that include this header call GL through the table. The table's
+// own source defines GL_FUNCTIONS_NO_REDIRECT to reach the real functions.
+// A macro can't define macros, so this list has to be kept in step with
+// GL_ALL_FUNCTIONS by hand.
+#ifndef GL_FUNCTIONS_NO_REDIRECT
+#define glActiveTexture gl_functions.glActiveTexture
+#define glAttachShader gl_functions.glAttachShader
+#define glBindAttribLocation gl_functions.glBindAttribLocation
+#define glBindBuffer gl_functions.glBindBuffer
+#define glBindFramebuffer gl_functions.glBindFramebuffer
+#define glBindRenderbuffer gl_functions.glBindRenderbuffer
+#define glBindTexture gl_functions.glBindTexture
+#define glBlendFunc gl_functions.glBlendFunc
+#define glBufferData gl_functions.glBufferData
+#define glBufferSubData gl_functions.glBufferSubData
+#define glCheckFramebufferStatus gl_functions.glCheckFramebufferStatus
+#define glClear gl_functions.glClear
+#define glClearColor gl_functions.glClearColor
+#define glCompileShader gl_functions.glCompileShader
+#define glCompressedTexImage2D gl_functions.glCompressedTexImage2D
+#define glCreateProgram gl_functions.glCreateProgram
+#define glCreateShader gl_functions.glCreateShader
+#define glCullFace gl_functions.glCullFace
+#define glDeleteBuffers gl_functions.glDeleteBuffers
+#define glDeleteFramebuffers gl_functions.glDeleteFramebuffers
+#define glDeleteProgram gl_functions.glDeleteProgram
+#define glDeleteRenderbuffers gl_functions.glDeleteRenderbuffers
+#define glDeleteShader gl_functions.glDeleteShader
+#define glDeleteTextures gl_functions.glDeleteTextures
+#define glDetachShader gl_functions.glDetachShader
+#define glDisableVertexAttribArray gl_functions.glDisableVertexAttribArray
+#define glDrawArrays gl_functions.glDrawArrays
+#define glDrawElements gl_functions.glDrawElements
+#define glEnable gl_functions.glEnable
+#define glEnableVertexAttribArray gl_functions.glEnableVertexAttribArray
+#define glFinish gl_functions.glFinish
+#define glFramebufferRenderbuffer gl_functions.glFramebufferRenderbuffer
+#define glFramebufferTexture2D gl_functions.glFramebufferTexture2D
+#define glFrontFace gl_functions.glFrontFace
+#define glGenBuffers gl_functions.glGenBuffers
+#define glGenFramebuffers gl_functions.glGenFramebuffers
+#define glGenRenderbuffers gl_functions.glGenRenderbuffers
+#define glGenTextures gl_functions.glGenTextures
+#define glGenerateMipmap gl_functions.glGenerateMipmap
+#define glGetAttachedShaders gl_functions.glGetAttachedShaders
+#define glGetAttribLocation gl_functions.glGetAttribLocation
+#define glGetError gl_functions.glGetError
+#define glGetIntegerv gl_functions.glGetIntegerv
+#define glGetProgramBinaryOES gl_functions.glGetProgramBinaryOES
+#define glGetProgramInfoLog gl_functions.glGetProgramInfoLog
+#define glGetProgramiv gl_functions.glGetProgramiv
+#define glGetShaderInfoLog gl_functions.glGetShaderInfoLog
+#define glGetShaderiv gl_functions.glGetShaderiv
+#define glGetString gl_functions.glGetString
+#define glGetUniformLocation gl_functions.glGetUniformLocation
+#define glLinkProgram gl_functions.glLinkProgram
+#define glMapBufferOES gl_functions.glMapBufferOES
+#define glMaxShaderCompilerThreadsKHR gl_functions.glMaxShaderCompilerThreadsKHR
+#define glPixelStorei gl_functions.glPixelStorei
+#define glProgramBinaryOES gl_functions.glProgramBinaryOES
+#define glReadPixels gl_functions.glReadPixels
+#define glRenderbufferStorage gl_functions.glRenderbufferStorage
+#define glShaderSource gl_functions.glShaderSource
+#define glTexImage2D gl_functions.glTexImage2D
+#define glTexParameteri gl_functions.glTexParameteri
+#define glUniform1f gl_functions.glUniform1f
+#define glUniform1i gl_functions.glUniform1i
+#define glUniform2fv gl_functions.glUniform2fv
+#define glUniform3fv gl_functions.glUniform3fv
+#define glUniform4fv gl_functions.glUniform4fv
+#define glUniformMatrix4fv gl_functions.glUniformMatrix4fv
+#define glUnmapBufferOES gl_functions.glUnmapBufferOES
+#define glUseProgram gl_functions.glUseProgram
+#define glVertexAttribPointer gl_functions.glVertexAttribPointer
+#define glViewport gl_functions.glViewport
+#endif
+
+#endif // GL_FUNCTIONS_HPP_
@@ -0,0 +1,168 @@
+#include "engine/frame_stats.hpp"
+#include "engine/gl_check.hpp"
+#include "engine/gl_functions.hpp"
+#include "engine/gl_state.hpp"
+
+gl_state::gl_state() {
+    this->reset();
+}
+
+void gl_state::issued() {
+    get_frame_stats().count(frame_counter::gl_state_issued);
+}
+
+void gl_state::elided() {
+    get_frame_stats().count(frame_counter::gl_state_elided);
+}
+
+void gl_state::reset() {
+    this->program_id = 0;
+    this->framebuffer_id = 0;
+    this->array_buffer_id = 0;
+    this->element_array_buffer_id = 0;
+    for (auto &attrib : this->attribs) {
+        attrib = vertex_attrib_state();
+        attrib.size = 4;
+        attrib.type = GL_FLOAT;
+    }
+    this->active_texture_unit = 0;
+    for (auto &texture_id : this->texture_ids) {
+        texture_id = 0;
+    }
+}
+
+void gl_state::use_program(uint32_t program_id) {
+    if (this->program_id == program_id) {
+        this->elided();
+        return;
+    }
+    GL_CALL(glUseProgram(program_id));
+    this->program_id = program_id;
+    this->issued();
+}
+
+void gl_state::bind_buffer(GLenum target, uint32_t buffer_id) {
+    uint32_t &bound_id = target == GL_ELEMENT_ARRAY_BUFFER ? this->element_array_buffer_id : this->array_buffer_id;
+    if (bound_id == buffer_id) {
+        this->elided();
+        return;
+    }
+    GL_CALL(glBindBuffer(target, buffer_id));
+    bound_id = buffer_id;
+    this->issued();
+}
+
+void gl_state::enable_vertex_attrib(uint32_t index) {
+    if (index < max_tracked_attribs && this->attribs[index].enabled) {
+        this->elided();
+        return;
+    }
+    GL_CALL(glEnableVertexAttribArray(index));
+    if (index < max_tracked_attribs) {
+        this->attribs[index].enabled = true;
+    }
+    this->issued();
+}
+
+void gl_state::disable_vertex_attrib(uint32_t index) {
+    if (index < max_tracked_attribs && !this->attribs[index].enabled) {
+        this->elided();
+        return;
+    }
+    GL_CALL(glDisableVertexAttribArray(index));
+    if (index < max_tracked_attribs) {
+        this->attribs[index].enabled = false;
+    }
+    this->issued();
+}
+
+// The attribute pointer captures the array buffer bound at call time, so
+// that binding is part of what has to match for the call to be skipped.
+void gl_state::vertex_attrib_pointer(uint32_t index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid *pointer) {
+    if (index < max_tracked_attribs) {
+        vertex_attrib_state &attrib = this->attribs[index];
+        if (attrib.buffer_id == this->array_buffer_id && attrib.size == size && attrib.type == type
+                && attrib.normalized == normalized && attrib.stride == stride && attrib.pointer == pointer) {
+            this->elided();
+            return;
+        }
+        attrib.buffer_id = this->array_buffer_id;
+        attrib.size = size;
+        attrib.type = type;
+        attrib.normalized = normalized;
+        attrib.stride = stride;
+        attrib.pointer = pointer;
+    }
+    GL_CALL(glVertexAttribPointer(index, size, type, normalized, stride, pointer));
+    this->issued();
+}
+
+// Only GL_TEXTURE_2D bindings are tracked; binds on units beyond the
+// tracked ones always reach the driver.
+void gl_state::bind_texture(uint32_t unit, uint32_t texture_id) {
+    if (unit < max_tracked_texture_units && this->texture_ids[unit] == texture_id) {
+        this->elided();
+        return;
+    }
+    if (this->active_texture_unit != unit) {
+        GL_CALL(glActiveTexture(GL_TEXTURE0 + unit));
+        this->active_texture_unit = unit;
+    }
+    GL_CALL(glBindTexture(GL_TEXTURE_2D, texture_id));
+    if (unit < max_tracked_texture_units) {
+        this->texture_ids[unit] = texture_id;
+    }
+    this->issued();
+}
+
+void gl_state::bind_framebuffer(uint32_t framebuffer_id) {
+    if (this->framebuffer_id == framebuffer_id) {
+        this->elided();
+        return;
+    }
+    GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_id));
+    this->framebuffer_id = framebuffer_id;
+    this->issued();
+}
+
+// Deleting a bound object implicitly rebinds zero; a later object may also
+// reuse the name, so cached attribute pointers into it are dropped too.
+void gl_state::forget_program(uint32_t program_id) {
+    if (this->program_id == program_id) {
+        this->program_id = 0;
+    }
+}
+
+void gl_state::forget_buffer(uint32_t buffer_id) {
+    if (this->array_buffer_id == buffer_id) {
+        this->array_buffer_id = 0;
+    }
+    if (this->element_array_buffer_id == buffer_id) {
+        this->element_array_buffer_id = 0;
+    }
+    for (auto &attrib : this->attribs) {
+        if (attrib.buffer_id == buffer_id) {
+            attrib.buffer_id = 0;
+            attrib.size = 0;
+        }
+    }
+}
+
+void gl_state::forget_texture(uint32_t texture_id) {
+    for (auto &bound_id : this->texture_ids) {
+        if (bound_id == texture_id) {
+            bound_id = 0;
+        }
+    }
+}
+
+void gl_state::forget_framebuffer(uint32_t framebuffer_id) {
+    if (this->framebuffer_id == framebuffer_id) {
+        this->framebuffer_id = 0;
+    }
+}
+
+gl_state &get_gl_state() {
+    static gl_state state;
+    return state;
+}
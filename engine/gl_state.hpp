@@ -0,0 +1,55 @@
+#ifndef GL_STATE_HPP_
+#define GL_STATE_HPP_
+
+#include <stdint.h>
+
+#include <SDL2/SDL_opengles2.h>
+
+struct vertex_attrib_state {
+    bool enabled;
+    uint32_t buffer_id;
+    GLint size;
+    GLenum type;
+    GLboolean normalized;
+    GLsizei stride;
+    const GLvoid *pointer;
+};
+
+// Shadows the GL state the engine touches so that binds, program switches
+// and attribute setup that wouldn't change anything never reach the driver.
+// Everything that changes this state has to go through here, or call
+// reset() afterwards.
+class gl_state {
+protected:
+    static const uint32_t max_tracked_attribs = 16;
+    static const uint32_t max_tracked_texture_units = 8;
+    uint32_t program_id;
+    uint32_t framebuffer_id;
+    uint32_t array_buffer_id;
+    uint32_t element_array_buffer_id;
+    vertex_attrib_state attribs[max_tracked_attribs];
+    uint32_t active_texture_unit;
+    uint32_t texture_ids[max_tracked_texture_units];
+    void issued();
+    void elided();
+public:
+    gl_state();
+    gl_state(gl_state const &) = delete;
+    void operator=(gl_state const &) = delete;
+    void reset();
+    void use_program(uint32_t program_id);
+    void bind_buffer(GLenum target, uint32_t buffer_id);
+    void enable_vertex_attrib(uint32_t index);
+    void disable_vertex_attrib(uint32_t index);
+    void vertex_attrib_pointer(uint32_t index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid *pointer);
+    void bind_texture(uint32_t unit, uint32_t texture_id);
+    void bind_framebuffer(uint32_t framebuffer_id);
+    void forget_program(uint32_t program_id);
+    void forget_buffer(uint32_t buffer_id);
+    void forget_texture(uint32_t texture_id);
+    void forget_framebuffer(uint32_t framebuffer_id);
+};
+
+gl_state &get_gl_state();
+
+#endif // GL_STATE_HPP_
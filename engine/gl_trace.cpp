@@ -0,0 +1,284 @@
+// The wrappers call the driver table by name, and the function ids share
+// the GL names, so those mustn't be redirected here.
+#define GL_FUNCTIONS_NO_REDIRECT
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <stdint.h>
+#include <string.h>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/gl_functions.hpp"
+#include "engine/gl_trace.hpp"
+#include "utils/utils.hpp"
+
+template<typename T>
+uint64_t pack_trace_arg(T value) {
+    return (uint64_t) (int64_t) value;
+}
+
+template<typename T>
+uint64_t pack_trace_arg(T *value) {
+    return (uint64_t) (uintptr_t) value;
+}
+
+uint64_t pack_trace_arg(float value) {
+    double wide = value;
+    uint64_t packed;
+    memcpy(&packed, &wide, sizeof(packed));
+    return packed;
+}
+
+// Times one wrapped call from construction to the end of the wrapper's
+// return statement, so calls that return a value are timed the same way.
+class gl_call_record {
+protected:
+    gl_function_id function;
+    uint64_t start_ticks;
+    uint64_t args[max_gl_trace_args];
+    int arg_count;
+public:
+    gl_call_record(gl_function_id function)
+        : function(function), start_ticks(SDL_GetPerformanceCounter()), arg_count(0) {
+    }
+    gl_call_record(gl_call_record const &) = delete;
+    ~gl_call_record() {
+        get_gl_tracer().record(this->function, this->start_ticks, SDL_GetPerformanceCounter(), this->args, this->arg_count);
+    }
+    void operator=(gl_call_record const &) = delete;
+    template<typename... T>
+    void set_args(T... values) {
+        const uint64_t packed[] = {0, pack_trace_arg(values)...};
+        this->arg_count = sizeof...(T);
+        std::copy(packed + 1, packed + 1 + sizeof...(T), this->args);
+    }
+};
+
+#define GL_TRACED_FUNCTION(ret, name, params, args, kinds) \
+    ret GL_APIENTRY traced_##name params { \
+        gl_call_record record(gl_function_id::name); \
+        record.set_args args; \
+        return gl_driver_functions.name args; \
+    }
+
+GL_ALL_FUNCTIONS(GL_TRACED_FUNCTION)
+
+#undef GL_TRACED_FUNCTION
+
+#define GL_TRACED_FUNCTION_ADDRESS(ret, name, params, args, kinds) &traced_##name,
+
+const gl_function_table traced_functions = {GL_ALL_FUNCTIONS(GL_TRACED_FUNCTION_ADDRESS)};
+
+#undef GL_TRACED_FUNCTION_ADDRESS
+
+gl_tracer::gl_tracer()
+    : enabled(false), frame(0), start_ticks(0), dropped_calls(0), function_calls(), function_ticks() {
+    this->ticks_per_us = SDL_GetPerformanceFrequency() / 1000000.0;
+}
+
+// Can be switched either way at any point; frames keep their numbers
+// across gaps in the trace.
+void gl_tracer::set_enabled(bool enabled) {
+    uint64_t now = SDL_GetPerformanceCounter();
+    if (enabled && !this->enabled) {
+        if (this->frames.empty()) {
+            this->start_ticks = now;
+        }
+        this->begin_trace_frame(now);
+    } else if (!enabled && this->enabled) {
+        this->frames.back().end_ticks = now;
+    }
+    this->enabled = enabled;
+    this->update_dispatch();
+}
+
+bool gl_tracer::is_enabled() const {
+    return this->enabled;
+}
+
+// Points gl_functions at the wrappers or straight at the driver, after
+// either the driver table or the tracing state changed.
+void gl_tracer::update_dispatch() {
+    gl_functions = this->enabled ? traced_functions : gl_driver_functions;
+}
+
+void gl_tracer::begin_trace_frame(uint64_t now) {
+    gl_trace_frame trace_frame;
+    trace_frame.index = this->frame;
+    trace_frame.start_ticks = now;
+    trace_frame.end_ticks = 0;
+    trace_frame.counts.fill(0);
+    this->frames.push_back(trace_frame);
+}
+
+void gl_tracer::record(gl_function_id function, uint64_t start_ticks, uint64_t end_ticks, const uint64_t *args, int arg_count) {
+    int index = (int) function;
+    this->frames.back().counts[index]++;
+    this->function_calls[index]++;
+    this->function_ticks[index] += end_ticks - start_ticks;
+
+    if (this->calls.size() == max_calls) {
+        this->dropped_calls++;
+        return;
+    }
+    gl_trace_call call;
+    call.frame = this->frame;
+    call.start_ticks = start_ticks;
+    call.end_ticks = end_ticks;
+    call.function = function;
+    std::copy(args, args + arg_count, call.args);
+    this->calls.push_back(call);
+}
+
+void gl_tracer::end_frame() {
+    this->frame++;
+    if (!this->enabled) {
+        return;
+    }
+    uint64_t now = SDL_GetPerformanceCounter();
+    this->frames.back().end_ticks = now;
+    this->begin_trace_frame(now);
+}
+
+double gl_tracer::to_us(uint64_t ticks) const {
+    return (ticks - this->start_ticks) / this->ticks_per_us;
+}
+
+// Data pointers differ from run to run, so they are only shown as null or
+// not, which keeps logs of two runs diffable.
+std::string gl_tracer::format_call(const gl_trace_call &call) const {
+    std::ostringstream out;
+    out << get_gl_function_name(call.function) << "(";
+    const char *kinds = get_gl_function_kinds(call.function);
+    for (int i = 0; kinds[i] != '\0'; i++) {
+        uint64_t arg = call.args[i];
+        if (i > 0) {
+            out << ", ";
+        }
+        switch (kinds[i]) {
+            case 'e':
+                out << "0x" << std::hex << std::setw(4) << std::setfill('0') << arg << std::dec;
+                break;
+            case 'x':
+                out << "0x" << std::hex << arg << std::dec;
+                break;
+            case 'b':
+                out << (arg ? "GL_TRUE" : "GL_FALSE");
+                break;
+            case 'f': {
+                double value;
+                memcpy(&value, &arg, sizeof(value));
+                out << value;
+                break;
+            }
+            case 'p':
+                out << (arg ? "ptr" : "NULL");
+                break;
+            case 'i':
+                out << (int64_t) arg;
+                break;
+            default:
+                out << arg;
+        }
+    }
+    out << ")";
+    return out.str();
+}
+
+// One call per line, prefixed with its frame and without timings, so two
+// runs' logs can be diffed; the per-entry-point summary follows as
+// comments.
+void gl_tracer::write_log(std::ostream &out) const {
+    for (const auto &call : this->calls) {
+        out << call.frame << " " << this->format_call(call) << "\n";
+    }
+    if (this->dropped_calls > 0) {
+        out << "# " << this->dropped_calls << " later calls not logged\n";
+    }
+
+    size_t frame_count = std::max<size_t>(1, this->frames.size());
+    out << "# entry point, calls, calls per frame, max calls per frame, mean us per call\n";
+    for (int i = 0; i < gl_function_count; i++) {
+        if (this->function_calls[i] == 0) {
+            continue;
+        }
+        uint32_t max_per_frame = 0;
+        for (const auto &trace_frame : this->frames) {
+            max_per_frame = std::max(max_per_frame, trace_frame.counts[i]);
+        }
+        out << "# " << get_gl_function_name((gl_function_id) i)
+            << ", " << this->function_calls[i]
+            << ", " << (double) this->function_calls[i] / frame_count
+            << ", " << max_per_frame
+            << ", " << this->function_ticks[i] / this->ticks_per_us / this->function_calls[i] << "\n";
+    }
+}
+
+// Chrome trace event format, which Perfetto and chrome://tracing both
+// load: a slice per call and per frame, and a counter track per entry
+// point with its calls in each frame.
+void gl_tracer::write_json(std::ostream &out) const {
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"gl calls\"}},\n";
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"frames\"}}";
+
+    for (const auto &call : this->calls) {
+        out << ",\n{\"name\":\"" << get_gl_function_name(call.function)
+            << "\",\"cat\":\"gl\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+            << ",\"ts\":" << this->to_us(call.start_ticks)
+            << ",\"dur\":" << (call.end_ticks - call.start_ticks) / this->ticks_per_us
+            << ",\"args\":{\"frame\":" << call.frame << ",\"call\":\"" << this->format_call(call) << "\"}}";
+    }
+
+    uint64_t last_ticks = this->calls.empty() ? this->start_ticks : this->calls.back().end_ticks;
+    for (const auto &trace_frame : this->frames) {
+        uint64_t frame_end = trace_frame.end_ticks != 0
+            ? trace_frame.end_ticks : std::max(trace_frame.start_ticks, last_ticks);
+        out << ",\n{\"name\":\"frame " << trace_frame.index << "\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":2"
+            << ",\"ts\":" << this->to_us(trace_frame.start_ticks)
+            << ",\"dur\":" << (frame_end - trace_frame.start_ticks) / this->ticks_per_us << "}";
+        for (int i = 0; i < gl_function_count; i++) {
+            if (this->function_calls[i] == 0) {
+                continue;
+            }
+            out << ",\n{\"name\":\"" << get_gl_function_name((gl_function_id) i)
+                << " calls\",\"cat\":\"gl\",\"ph\":\"C\",\"pid\":1,\"ts\":" << this->to_us(trace_frame.start_ticks)
+                << ",\"args\":{\"calls\":" << trace_frame.counts[i] << "}}";
+        }
+    }
+    out << "\n]}\n";
+}
+
+void gl_tracer::set_dump_path(const std::string &path) {
+    this->dump_path = path;
+}
+
+void gl_tracer::dump() const {
+    if (this->dump_path.empty()) {
+        return;
+    }
+
+    std::ofstream out(this->dump_path);
+    if (!out) {
+        throw std::runtime_error("couldn't open \"" + this->dump_path + "\"");
+    }
+
+    if (has_suffix(this->dump_path, ".json")) {
+        this->write_json(out);
+    } else {
+        this->write_log(out);
+    }
+}
+
+gl_tracer &get_gl_tracer() {
+    static gl_tracer tracer;
+    return tracer;
+}
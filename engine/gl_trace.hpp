@@ -0,0 +1,71 @@
+#ifndef GL_TRACE_HPP_
+#define GL_TRACE_HPP_
+
+#include <array>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include "engine/gl_functions.hpp"
+
+const int max_gl_trace_args = 9;
+
+struct gl_trace_call {
+    uint64_t frame;
+    uint64_t start_ticks;
+    uint64_t end_ticks;
+    gl_function_id function;
+    // Packed by kind: integers sign-extended, floats as double bits,
+    // pointers as addresses.
+    uint64_t args[max_gl_trace_args];
+};
+
+struct gl_trace_frame {
+    uint64_t index;
+    uint64_t start_ticks;
+    // Zero until the frame ends or tracing is switched off.
+    uint64_t end_ticks;
+    std::array<uint32_t, gl_function_count> counts;
+};
+
+// Logs every GL call made through gl_functions while enabled, with its
+// arguments, CPU time and frame, and counts the calls to each entry point
+// per frame. Enabling it points gl_functions at wrappers around the driver
+// functions; disabled, it costs nothing beyond the table lookup every call
+// already makes. Only the render thread calls GL, so none of this locks.
+class gl_tracer {
+protected:
+    static const size_t max_calls = 1 << 19;
+    bool enabled;
+    uint64_t frame;
+    uint64_t start_ticks;
+    double ticks_per_us;
+    std::vector<gl_trace_call> calls;
+    uint64_t dropped_calls;
+    std::vector<gl_trace_frame> frames;
+    uint64_t function_calls[gl_function_count];
+    uint64_t function_ticks[gl_function_count];
+    std::string dump_path;
+    void begin_trace_frame(uint64_t now);
+    std::string format_call(const gl_trace_call &call) const;
+    double to_us(uint64_t ticks) const;
+public:
+    gl_tracer();
+    gl_tracer(gl_tracer const &) = delete;
+    void operator=(gl_tracer const &) = delete;
+    void set_enabled(bool enabled);
+    bool is_enabled() const;
+    void update_dispatch();
+    void record(gl_function_id function, uint64_t start_ticks, uint64_t end_ticks, const uint64_t *args, int arg_count);
+    void end_frame();
+    void write_log(std::ostream &out) const;
+    void write_json(std::ostream &out) const;
+    void set_dump_path(const std::string &path);
+    void dump() const;
+};
+
+gl_tracer &get_gl_tracer();
+
+#endif // GL_TRACE_HPP_
@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/image.hpp"
+#include "engine/math.hpp"
+
+#if defined(ENGINE_MATH_SSE2)
+#include <emmintrin.h>
+#elif defined(ENGINE_MATH_NEON)
+#include <arm_neon.h>
+#endif
+
+const size_t pkm_header_size = 16;
+
+image make_image(int width, int height, int channels) {
+    image result;
+    result.width = width;
+    result.height = height;
+    result.channels = channels;
+    result.pixels.resize((size_t) width * height * channels);
+    return result;
+}
+
+GLenum get_image_format(int channels) {
+    switch (channels) {
+        case 1: return GL_LUMINANCE;
+        case 3: return GL_RGB;
+        case 4: return GL_RGBA;
+        default:
+            throw std::runtime_error("images need 1, 3 or 4 channels, not " + std::to_string(channels));
+    }
+}
+
+void flip_rows(image &source) {
+    size_t row_size = (size_t) source.width * source.channels;
+    for (int top = 0, bottom = source.height - 1; top < bottom; top++, bottom--) {
+        std::swap_ranges(
+                source.pixels.begin() + top * row_size,
+                source.pixels.begin() + (top + 1) * row_size,
+                source.pixels.begin() + bottom * row_size);
+    }
+}
+
+image convert_to_rgba(const image &source) {
+    if (source.channels == 4) {
+        return source;
+    }
+    image result = make_image(source.width, source.height, 4);
+    size_t pixel_count = (size_t) source.width * source.height;
+    for (size_t i = 0; i < pixel_count; i++) {
+        const uint8_t *in = &source.pixels[i * source.channels];
+        uint8_t *out = &result.pixels[i * 4];
+        out[0] = in[0];
+        out[1] = source.channels == 1 ? in[0] : in[1];
+        out[2] = source.channels == 1 ? in[0] : in[2];
+        out[3] = 255;
+    }
+    return result;
+}
+
+// Averages the 2x2 block under each destination pixel from x onwards; an
+// odd last row or column is clamped to the edge.
+void downsample_row_scalar(const image &source, image &result, int y, int x) {
+    const int channels = source.channels;
+    const uint8_t *row0 = &source.pixels[(size_t) (2 * y) * source.width * channels];
+    const uint8_t *row1 = &source.pixels[(size_t) std::min(2 * y + 1, source.height - 1) * source.width * channels];
+    uint8_t *out = &result.pixels[(size_t) y * result.width * channels];
+    for (; x < result.width; x++) {
+        const int x0 = 2 * x * channels;
+        const int x1 = std::min(2 * x + 1, source.width - 1) * channels;
+        for (int c = 0; c < channels; c++) {
+            out[x * channels + c] = (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2;
+        }
+    }
+}
+
+image downsample_scalar(const image &source) {
+    image result = make_image(std::max(1, source.width / 2), std::max(1, source.height / 2), source.channels);
+    for (int y = 0; y < result.height; y++) {
+        downsample_row_scalar(source, result, y, 0);
+    }
+    return result;
+}
+
+// Four RGBA destination pixels per step: the eight source pixels of each
+// row are split into even and odd ones, widened to 16 bits, summed and
+// narrowed with the same +2 rounding as the scalar path.
+int downsample_row_simd(const uint8_t *row0, const uint8_t *row1, uint8_t *out, int width) {
+    int x = 0;
+#if defined(ENGINE_MATH_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i two = _mm_set1_epi16(2);
+    for (; x + 4 <= width; x += 4) {
+        __m128 a0 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*) (row0 + x * 8)));
+        __m128 a1 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*) (row0 + x * 8 + 16)));
+        __m128 b0 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*) (row1 + x * 8)));
+        __m128 b1 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*) (row1 + x * 8 + 16)));
+        __m128i a_even = _mm_castps_si128(_mm_shuffle_ps(a0, a1, _MM_SHUFFLE(2, 0, 2, 0)));
+        __m128i a_odd = _mm_castps_si128(_mm_shuffle_ps(a0, a1, _MM_SHUFFLE(3, 1, 3, 1)));
+        __m128i b_even = _mm_castps_si128(_mm_shuffle_ps(b0, b1, _MM_SHUFFLE(2, 0, 2, 0)));
+        __m128i b_odd = _mm_castps_si128(_mm_shuffle_ps(b0, b1, _MM_SHUFFLE(3, 1, 3, 1)));
+        __m128i low = _mm_add_epi16(
+                _mm_add_epi16(_mm_unpacklo_epi8(a_even, zero), _mm_unpacklo_epi8(a_odd, zero)),
+                _mm_add_epi16(_mm_unpacklo_epi8(b_even, zero), _mm_unpacklo_epi8(b_odd, zero)));
+        __m128i high = _mm_add_epi16(
+                _mm_add_epi16(_mm_unpackhi_epi8(a_even, zero), _mm_unpackhi_epi8(a_odd, zero)),
+                _mm_add_epi16(_mm_unpackhi_epi8(b_even, zero), _mm_unpackhi_epi8(b_odd, zero)));
+        low = _mm_srli_epi16(_mm_add_epi16(low, two), 2);
+        high = _mm_srli_epi16(_mm_add_epi16(high, two), 2);
+        _mm_storeu_si128((__m128i*) (out + x * 4), _mm_packus_epi16(low, high));
+    }
+#elif defined(ENGINE_MATH_NEON)
+    for (; x + 4 <= width; x += 4) {
+        // De-interleaving 32-bit lanes splits even and odd pixels.
+        uint32x4x2_t a = vld2q_u32((const uint32_t*) (row0 + x * 8));
+        uint32x4x2_t b = vld2q_u32((const uint32_t*) (row1 + x * 8));
+        uint8x16_t a_even = vreinterpretq_u8_u32(a.val[0]);
+        uint8x16_t a_odd = vreinterpretq_u8_u32(a.val[1]);
+        uint8x16_t b_even = vreinterpretq_u8_u32(b.val[0]);
+        uint8x16_t b_odd = vreinterpretq_u8_u32(b.val[1]);
+        uint16x8_t low = vaddq_u16(
+                vaddl_u8(vget_low_u8(a_even), vget_low_u8(a_odd)),
+                vaddl_u8(vget_low_u8(b_even), vget_low_u8(b_odd)));
+        uint16x8_t high = vaddq_u16(
+                vaddl_u8(vget_high_u8(a_even), vget_high_u8(a_odd)),
+                vaddl_u8(vget_high_u8(b_even), vget_high_u8(b_odd)));
+        vst1q_u8(out + x * 4, vcombine_u8(vrshrn_n_u16(low, 2), vrshrn_n_u16(high, 2)));
+    }
+#endif
+    return x;
+}
+
+image downsample(const image &source) {
+    // The vector path reads source pixels in pairs, so it needs an even
+    // width; everything else takes the scalar path.
+    if (source.channels != 4 || source.width % 2 != 0) {
+        return downsample_scalar(source);
+    }
+    image result = make_image(std::max(1, source.width / 2), std::max(1, source.height / 2), source.channels);
+    const size_t row_bytes = (size_t) source.width * 4;
+    for (int y = 0; y < result.height; y++) {
+        const uint8_t *row0 = &source.pixels[(size_t) (2 * y) * row_bytes];
+        const uint8_t *row1 = &source.pixels[(size_t) std::min(2 * y + 1, source.height - 1) * row_bytes];
+        int x = downsample_row_simd(row0, row1, &result.pixels[(size_t) y * result.width * 4], result.width);
+        downsample_row_scalar(source, result, y, x);
+    }
+    return result;
+}
+
+// ETC1 stores 4x4 blocks of 8 bytes, rounding each dimension up.
+size_t get_etc1_size(int width, int height) {
+    return (size_t) ((width + 3) / 4) * ((height + 3) / 4) * 8;
+}
+
+uint16_t read_big_endian_16(const uint8_t *data) {
+    return (data[0] << 8) | data[1];
+}
+
+// PKM is the container written by etc1tool and Mali's texture compressor:
+// "PKM 10", a format code and the padded and original sizes, big endian,
+// then one level of ETC1 blocks.
+compressed_image read_pkm(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("couldn't open \"" + path + "\"");
+    }
+    uint8_t header[pkm_header_size];
+    if (!in.read((char*) header, sizeof(header)) || std::string((const char*) header, 6) != "PKM 10") {
+        throw std::runtime_error("\"" + path + "\" isn't an ETC1 PKM file");
+    }
+    if (read_big_endian_16(header + 6) != 0) {
+        throw std::runtime_error("\"" + path + "\" isn't ETC1 RGB data");
+    }
+
+    compressed_image result;
+    result.width = read_big_endian_16(header + 12);
+    result.height = read_big_endian_16(header + 14);
+    result.format = GL_ETC1_RGB8_OES;
+    result.levels.emplace_back(get_etc1_size(read_big_endian_16(header + 8), read_big_endian_16(header + 10)));
+    std::vector<uint8_t> &level = result.levels.back();
+    if (!in.read((char*) level.data(), level.size())) {
+        throw std::runtime_error("\"" + path + "\" is truncated");
+    }
+    return result;
+}
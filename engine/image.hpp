@@ -0,0 +1,46 @@
+#ifndef IMAGE_HPP_
+#define IMAGE_HPP_
+
+#include <string>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <SDL2/SDL_opengles2.h>
+
+// Tightly packed 8-bit pixels, rows top to bottom, with 1 (luminance),
+// 3 (RGB) or 4 (RGBA) channels.
+struct image {
+    int width;
+    int height;
+    int channels;
+    std::vector<uint8_t> pixels;
+};
+
+// Block-compressed data with one entry per mip level, largest first.
+struct compressed_image {
+    int width;
+    int height;
+    GLenum format;
+    std::vector<std::vector<uint8_t>> levels;
+};
+
+image make_image(int width, int height, int channels);
+GLenum get_image_format(int channels);
+// Turns GL's bottom-to-top rows, as glReadPixels returns them, into top to
+// bottom, or back.
+void flip_rows(image &source);
+// Alpha is opaque for RGB sources and luminance is copied to RGB.
+image convert_to_rgba(const image &source);
+
+// Halves each dimension (down to 1) with a 2x2 box filter. Four-channel
+// images go through SSE2/NEON; both paths round the same way, so their
+// results are identical.
+image downsample(const image &source);
+image downsample_scalar(const image &source);
+
+size_t get_etc1_size(int width, int height);
+compressed_image read_pkm(const std::string &path);
+
+#endif // IMAGE_HPP_
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "engine/image.hpp"
+#include "engine/image_diff.hpp"
+#include "engine/math.hpp"
+
+#if defined(ENGINE_MATH_SSE2)
+#include <emmintrin.h>
+#elif defined(ENGINE_MATH_NEON)
+#include <arm_neon.h>
+#endif
+
+void check_comparable(const image &a, const image &b) {
+    if (a.width != b.width || a.height != b.height || a.channels != b.channels) {
+        throw std::runtime_error(
+            "can't compare a " + std::to_string(a.width) + "x" + std::to_string(a.height)
+            + "x" + std::to_string(a.channels) + " image with a " + std::to_string(b.width)
+            + "x" + std::to_string(b.height) + "x" + std::to_string(b.channels) + " one");
+    }
+}
+
+// Compares pixels from start onwards, adding to result.
+void compare_pixels_scalar(const image &a, const image &b, int tolerance, size_t start, image_difference &result) {
+    const int channels = a.channels;
+    const size_t pixel_count = (size_t) a.width * a.height;
+    for (size_t i = start; i < pixel_count; i++) {
+        int pixel_max = 0;
+        for (int c = 0; c < channels; c++) {
+            pixel_max = std::max(pixel_max, abs(a.pixels[i * channels + c] - b.pixels[i * channels + c]));
+        }
+        result.max_difference = std::max(result.max_difference, pixel_max);
+        if (pixel_max > tolerance) {
+            result.differing_pixels++;
+        }
+    }
+}
+
+image_difference compare_images_scalar(const image &a, const image &b, int tolerance) {
+    check_comparable(a, b);
+    image_difference result = {0, 0};
+    compare_pixels_scalar(a, b, tolerance, 0, result);
+    return result;
+}
+
+// Four RGBA pixels per step: the absolute difference of each channel is
+// the OR of the two saturating subtractions, and whatever survives
+// subtracting the tolerance marks a channel over it. A pixel differs when
+// its 32 bits aren't all zero. Returns the number of pixels done.
+size_t compare_pixels_simd(const uint8_t *a, const uint8_t *b, size_t pixel_count, int tolerance, image_difference &result) {
+    size_t i = 0;
+#if defined(ENGINE_MATH_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i limit = _mm_set1_epi8((char) tolerance);
+    __m128i max_difference = zero;
+    for (; i + 4 <= pixel_count; i += 4) {
+        __m128i pixels_a = _mm_loadu_si128((const __m128i*) (a + i * 4));
+        __m128i pixels_b = _mm_loadu_si128((const __m128i*) (b + i * 4));
+        __m128i difference = _mm_or_si128(_mm_subs_epu8(pixels_a, pixels_b), _mm_subs_epu8(pixels_b, pixels_a));
+        max_difference = _mm_max_epu8(max_difference, difference);
+        __m128i within = _mm_cmpeq_epi32(_mm_subs_epu8(difference, limit), zero);
+        int differing = ~_mm_movemask_ps(_mm_castsi128_ps(within)) & 0xf;
+        result.differing_pixels += (differing & 1) + ((differing >> 1) & 1) + ((differing >> 2) & 1) + (differing >> 3);
+    }
+    uint8_t lanes[16];
+    _mm_storeu_si128((__m128i*) lanes, max_difference);
+    result.max_difference = std::max<int>(result.max_difference, *std::max_element(lanes, lanes + 16));
+#elif defined(ENGINE_MATH_NEON)
+    const uint8x16_t limit = vdupq_n_u8((uint8_t) tolerance);
+    uint8x16_t max_difference = vdupq_n_u8(0);
+    for (; i + 4 <= pixel_count; i += 4) {
+        uint8x16_t difference = vabdq_u8(vld1q_u8(a + i * 4), vld1q_u8(b + i * 4));
+        max_difference = vmaxq_u8(max_difference, difference);
+        // All ones for pixels within the tolerance; shifting down to one
+        // bit and summing counts them.
+        uint32x4_t within = vceqq_u32(vreinterpretq_u32_u8(vqsubq_u8(difference, limit)), vdupq_n_u32(0));
+        uint32x4_t counts = vshrq_n_u32(within, 31);
+        uint32x2_t pairs = vadd_u32(vget_low_u32(counts), vget_high_u32(counts));
+        result.differing_pixels += 4 - vget_lane_u32(vpadd_u32(pairs, pairs), 0);
+    }
+    uint8_t lanes[16];
+    vst1q_u8(lanes, max_difference);
+    result.max_difference = std::max<int>(result.max_difference, *std::max_element(lanes, lanes + 16));
+#endif
+    return i;
+}
+
+image_difference compare_images(const image &a, const image &b, int tolerance) {
+    check_comparable(a, b);
+    if (a.channels != 4) {
+        return compare_images_scalar(a, b, tolerance);
+    }
+    image_difference result = {0, 0};
+    // The vector paths only hold 8-bit tolerances; anything larger passes
+    // every pixel, which the scalar path gets right.
+    if (tolerance < 0 || tolerance > 255) {
+        compare_pixels_scalar(a, b, tolerance, 0, result);
+        return result;
+    }
+    size_t done = compare_pixels_simd(a.pixels.data(), b.pixels.data(), (size_t) a.width * a.height, tolerance, result);
+    compare_pixels_scalar(a, b, tolerance, done, result);
+    return result;
+}
+
+image make_difference_image(const image &a, const image &b, int tolerance) {
+    check_comparable(a, b);
+    image result = make_image(a.width, a.height, 4);
+    const int channels = a.channels;
+    const size_t pixel_count = (size_t) a.width * a.height;
+    for (size_t i = 0; i < pixel_count; i++) {
+        int differences[4] = {0, 0, 0, 0};
+        int pixel_max = 0;
+        for (int c = 0; c < channels; c++) {
+            differences[c] = abs(a.pixels[i * channels + c] - b.pixels[i * channels + c]);
+            pixel_max = std::max(pixel_max, differences[c]);
+        }
+        if (pixel_max <= tolerance) {
+            result.pixels[i * 4 + 3] = 255;
+            continue;
+        }
+        if (channels == 1) {
+            differences[1] = differences[2] = differences[0];
+        } else if (channels == 4) {
+            // Alpha alone differing would otherwise show as black.
+            differences[0] = std::max(differences[0], differences[3]);
+        }
+        result.pixels[i * 4] = differences[0];
+        result.pixels[i * 4 + 1] = differences[1];
+        result.pixels[i * 4 + 2] = differences[2];
+        result.pixels[i * 4 + 3] = 255;
+    }
+    return result;
+}
@@ -0,0 +1,25 @@
+#ifndef IMAGE_DIFF_HPP_
+#define IMAGE_DIFF_HPP_
+
+#include <stddef.h>
+
+#include "engine/image.hpp"
+
+struct image_difference {
+    // Pixels with any channel further than the tolerance from the other
+    // image.
+    size_t differing_pixels;
+    // Largest difference in any channel of any pixel, 0 to 255.
+    int max_difference;
+};
+
+// Compares two images of the same size and channel count, throwing
+// otherwise. Four-channel images go through SSE2/NEON; both paths count
+// the same pixels.
+image_difference compare_images(const image &a, const image &b, int tolerance);
+image_difference compare_images_scalar(const image &a, const image &b, int tolerance);
+// An RGBA image that is black where the two images match within the
+// tolerance and shows the per-channel difference, opaque, where they don't.
+image make_difference_image(const image &a, const image &b, int tolerance);
+
+#endif // IMAGE_DIFF_HPP_
@@ -0,0 +1,320 @@
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "engine/image.hpp"
+#include "engine/image_file.hpp"
+
+const uint8_t png_signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+const size_t max_stored_block = 65535;
+
+std::array<uint32_t, 256> make_crc32_table() {
+    std::array<uint32_t, 256> table;
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+    }
+    return table;
+}
+
+uint32_t crc32(uint32_t crc, const uint8_t *data, size_t size) {
+    static const std::array<uint32_t, 256> table = make_crc32_table();
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+// Sums are reduced every 5552 bytes, the most that can't overflow.
+uint32_t adler32(const uint8_t *data, size_t size) {
+    uint32_t a = 1;
+    uint32_t b = 0;
+    while (size > 0) {
+        size_t run = std::min<size_t>(size, 5552);
+        for (size_t i = 0; i < run; i++) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+        data += run;
+        size -= run;
+    }
+    return (b << 16) | a;
+}
+
+void append_big_endian_32(std::vector<uint8_t> &out, uint32_t value) {
+    out.push_back(value >> 24);
+    out.push_back(value >> 16);
+    out.push_back(value >> 8);
+    out.push_back(value);
+}
+
+uint32_t read_big_endian_32(const uint8_t *data) {
+    return ((uint32_t) data[0] << 24) | ((uint32_t) data[1] << 16) | ((uint32_t) data[2] << 8) | data[3];
+}
+
+void write_file(const std::string &path, const std::vector<uint8_t> &contents) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write((const char*) contents.data(), contents.size());
+    if (!out) {
+        throw std::runtime_error("couldn't write \"" + path + "\"");
+    }
+}
+
+void write_ppm(const std::string &path, const image &source) {
+    int channels = source.channels == 1 ? 1 : 3;
+    std::string header = std::string(channels == 1 ? "P5" : "P6") + "\n"
+        + std::to_string(source.width) + " " + std::to_string(source.height) + "\n255\n";
+    std::vector<uint8_t> contents(header.begin(), header.end());
+    size_t pixel_count = (size_t) source.width * source.height;
+    if (source.channels == channels) {
+        contents.insert(contents.end(), source.pixels.begin(), source.pixels.end());
+    } else {
+        contents.reserve(contents.size() + pixel_count * 3);
+        for (size_t i = 0; i < pixel_count; i++) {
+            const uint8_t *pixel = &source.pixels[i * source.channels];
+            contents.insert(contents.end(), pixel, pixel + 3);
+        }
+    }
+    write_file(path, contents);
+}
+
+void append_png_chunk(std::vector<uint8_t> &out, const char *type, const std::vector<uint8_t> &data) {
+    append_big_endian_32(out, data.size());
+    size_t type_offset = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    append_big_endian_32(out, crc32(0, &out[type_offset], out.size() - type_offset));
+}
+
+void write_png(const std::string &path, const image &source) {
+    uint8_t color_type;
+    switch (source.channels) {
+        case 1: color_type = 0; break;
+        case 3: color_type = 2; break;
+        case 4: color_type = 6; break;
+        default:
+            throw std::runtime_error("images need 1, 3 or 4 channels, not " + std::to_string(source.channels));
+    }
+
+    std::vector<uint8_t> header;
+    append_big_endian_32(header, source.width);
+    append_big_endian_32(header, source.height);
+    header.insert(header.end(), {8, color_type, 0, 0, 0});
+
+    // Every row starts with filter type 0, none.
+    size_t row_size = (size_t) source.width * source.channels;
+    std::vector<uint8_t> raw;
+    raw.reserve((row_size + 1) * source.height);
+    for (int y = 0; y < source.height; y++) {
+        raw.push_back(0);
+        raw.insert(raw.end(), source.pixels.begin() + y * row_size, source.pixels.begin() + (y + 1) * row_size);
+    }
+
+    std::vector<uint8_t> deflated = {0x78, 0x01};
+    deflated.reserve(raw.size() + raw.size() / max_stored_block * 5 + 16);
+    size_t offset = 0;
+    do {
+        size_t block = std::min(max_stored_block, raw.size() - offset);
+        bool last = offset + block == raw.size();
+        deflated.insert(deflated.end(), {
+            (uint8_t) (last ? 1 : 0),
+            (uint8_t) block, (uint8_t) (block >> 8),
+            (uint8_t) ~block, (uint8_t) (~block >> 8)});
+        deflated.insert(deflated.end(), raw.begin() + offset, raw.begin() + offset + block);
+        offset += block;
+    } while (offset < raw.size());
+    append_big_endian_32(deflated, adler32(raw.data(), raw.size()));
+
+    std::vector<uint8_t> contents(png_signature, png_signature + sizeof(png_signature));
+    append_png_chunk(contents, "IHDR", header);
+    append_png_chunk(contents, "IDAT", deflated);
+    append_png_chunk(contents, "IEND", std::vector<uint8_t>());
+    write_file(path, contents);
+}
+
+void write_image_file(const std::string &path, const image &source, image_file_format format) {
+    if (format == image_file_format::png) {
+        write_png(path, source);
+    } else {
+        write_ppm(path, source);
+    }
+}
+
+// Skips whitespace and comments between PPM header fields.
+int read_ppm_field(const std::vector<uint8_t> &contents, size_t &offset) {
+    while (offset < contents.size() && (isspace(contents[offset]) || contents[offset] == '#')) {
+        if (contents[offset] == '#') {
+            while (offset < contents.size() && contents[offset] != '\n') {
+                offset++;
+            }
+        } else {
+            offset++;
+        }
+    }
+    int value = 0;
+    size_t start = offset;
+    while (offset < contents.size() && isdigit(contents[offset]) && offset - start < 9) {
+        value = value * 10 + (contents[offset++] - '0');
+    }
+    if (offset == start) {
+        throw std::runtime_error("malformed PPM header");
+    }
+    return value;
+}
+
+image read_ppm(const std::vector<uint8_t> &contents) {
+    size_t offset = 2;
+    int channels = contents[1] == '5' ? 1 : 3;
+    int width = read_ppm_field(contents, offset);
+    int height = read_ppm_field(contents, offset);
+    if (read_ppm_field(contents, offset) != 255) {
+        throw std::runtime_error("only 8-bit PPM files are supported");
+    }
+    offset++;
+    image result = make_image(width, height, channels);
+    if (contents.size() < offset + result.pixels.size()) {
+        throw std::runtime_error("PPM file is truncated");
+    }
+    std::copy(contents.begin() + offset, contents.begin() + offset + result.pixels.size(), result.pixels.begin());
+    return result;
+}
+
+uint8_t paeth(uint8_t a, uint8_t b, uint8_t c) {
+    int p = a + b - c;
+    int pa = abs(p - a);
+    int pb = abs(p - b);
+    int pc = abs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+image read_png(const std::vector<uint8_t> &contents) {
+    size_t offset = sizeof(png_signature);
+    image result;
+    bool have_header = false;
+    std::vector<uint8_t> deflated;
+    while (offset + 12 <= contents.size()) {
+        uint32_t length = read_big_endian_32(&contents[offset]);
+        std::string type((const char*) &contents[offset + 4], 4);
+        const uint8_t *data = &contents[offset + 8];
+        if (length > contents.size() - offset - 12) {
+            throw std::runtime_error("PNG chunk " + type + " is truncated");
+        }
+        if (type == "IHDR" && length >= 13) {
+            static const int channels_by_color_type[] = {1, 0, 3, 0, 0, 0, 4};
+            if (data[8] != 8 || data[9] > 6 || channels_by_color_type[data[9]] == 0 || data[12] != 0) {
+                throw std::runtime_error("only 8-bit, non-interlaced grey, RGB and RGBA PNG files are supported");
+            }
+            result = make_image(read_big_endian_32(data), read_big_endian_32(data + 4), channels_by_color_type[data[9]]);
+            have_header = true;
+        } else if (type == "IDAT") {
+            deflated.insert(deflated.end(), data, data + length);
+        } else if (type == "IEND") {
+            break;
+        }
+        offset += length + 12;
+    }
+    if (!have_header || deflated.size() < 2 || (deflated[0] & 0x0f) != 8) {
+        throw std::runtime_error("malformed PNG file");
+    }
+
+    // Uncompressed deflate blocks start on a byte boundary after a stored
+    // block, so they can be walked bytewise.
+    std::vector<uint8_t> raw;
+    size_t position = 2;
+    bool last = false;
+    while (!last) {
+        if (position + 5 > deflated.size()) {
+            throw std::runtime_error("PNG data is truncated");
+        }
+        uint8_t block_header = deflated[position];
+        if ((block_header & 0x06) != 0) {
+            throw std::runtime_error("compressed PNG files aren't supported; only ones with stored deflate blocks");
+        }
+        last = block_header & 1;
+        size_t block = deflated[position + 1] | (deflated[position + 2] << 8);
+        position += 5;
+        if (position + block > deflated.size()) {
+            throw std::runtime_error("PNG data is truncated");
+        }
+        raw.insert(raw.end(), deflated.begin() + position, deflated.begin() + position + block);
+        position += block;
+    }
+
+    size_t row_size = (size_t) result.width * result.channels;
+    if (raw.size() < (row_size + 1) * result.height) {
+        throw std::runtime_error("PNG data is truncated");
+    }
+    int bpp = result.channels;
+    for (int y = 0; y < result.height; y++) {
+        uint8_t filter = raw[y * (row_size + 1)];
+        const uint8_t *in = &raw[y * (row_size + 1) + 1];
+        uint8_t *out = &result.pixels[y * row_size];
+        const uint8_t *above = y > 0 ? out - row_size : NULL;
+        for (size_t x = 0; x < row_size; x++) {
+            uint8_t a = x >= (size_t) bpp ? out[x - bpp] : 0;
+            uint8_t b = above ? above[x] : 0;
+            uint8_t c = above && x >= (size_t) bpp ? above[x - bpp] : 0;
+            switch (filter) {
+                case 0: out[x] = in[x]; break;
+                case 1: out[x] = in[x] + a; break;
+                case 2: out[x] = in[x] + b; break;
+                case 3: out[x] = in[x] + (a + b) / 2; break;
+                case 4: out[x] = in[x] + paeth(a, b, c); break;
+                default:
+                    throw std::runtime_error("unknown PNG filter type " + std::to_string(filter));
+            }
+        }
+    }
+    return result;
+}
+
+image read_image_file(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("couldn't open \"" + path + "\"");
+    }
+    std::vector<uint8_t> contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    try {
+        if (contents.size() >= sizeof(png_signature) && memcmp(contents.data(), png_signature, sizeof(png_signature)) == 0) {
+            return read_png(contents);
+        }
+        if (contents.size() >= 2 && contents[0] == 'P' && (contents[1] == '5' || contents[1] == '6')) {
+            return read_ppm(contents);
+        }
+    } catch (const std::runtime_error &e) {
+        throw std::runtime_error("\"" + path + "\": " + e.what());
+    }
+    throw std::runtime_error("\"" + path + "\" isn't a binary PPM or PNG file");
+}
+
+image_file_format parse_image_file_format(const std::string &name) {
+    if (name == "png") {
+        return image_file_format::png;
+    }
+    if (name == "ppm") {
+        return image_file_format::ppm;
+    }
+    throw std::runtime_error("invalid image format \"" + name + "\", expected png or ppm");
+}
+
+const char *get_image_file_extension(image_file_format format) {
+    return format == image_file_format::png ? ".png" : ".ppm";
+}
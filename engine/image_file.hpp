@@ -0,0 +1,25 @@
+#ifndef IMAGE_FILE_HPP_
+#define IMAGE_FILE_HPP_
+
+#include <string>
+
+#include "engine/image.hpp"
+
+enum class image_file_format {
+    png,
+    ppm,
+};
+
+// Binary PPM (P6, or P5 for one channel), which drops alpha.
+void write_ppm(const std::string &path, const image &source);
+// PNG with uncompressed deflate blocks: larger than a compressing encoder
+// would write, but quick to produce and needing no zlib.
+void write_png(const std::string &path, const image &source);
+void write_image_file(const std::string &path, const image &source, image_file_format format);
+// Reads binary PPM and PGM files, and PNG files with uncompressed deflate
+// blocks such as write_png() produces, 8 bits per channel.
+image read_image_file(const std::string &path);
+image_file_format parse_image_file_format(const std::string &name);
+const char *get_image_file_extension(image_file_format format);
+
+#endif // IMAGE_FILE_HPP_
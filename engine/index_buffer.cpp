@@ -0,0 +1,57 @@
+#include <stdexcept>
+#include <string>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/gl_check.hpp"
+#include "engine/gl_functions.hpp"
+#include "engine/gl_state.hpp"
+#include "engine/index_buffer.hpp"
+
+index_buffer::index_buffer(const std::vector<uint16_t> &indices)
+    : index_buffer(indices.data(), GL_UNSIGNED_SHORT, indices.size()) {
+}
+
+index_buffer::index_buffer(const std::vector<uint32_t> &indices)
+    : index_buffer(indices.data(), GL_UNSIGNED_INT, indices.size()) {
+}
+
+// Uploads straight from the caller's memory, e.g. a mapped mesh file.
+// 32-bit indices aren't core in ES 2.0.
+index_buffer::index_buffer(const void *indices, GLenum index_type, int index_count)
+    : index_type(index_type), index_count(index_count) {
+    if (index_type == GL_UNSIGNED_INT && !SDL_GL_ExtensionSupported("GL_OES_element_index_uint")) {
+        throw std::runtime_error("32-bit index buffers need GL_OES_element_index_uint");
+    }
+    size_t index_size = index_type == GL_UNSIGNED_INT ? sizeof(uint32_t) : sizeof(uint16_t);
+    GL_CALL(glGenBuffers(1, &this->buffer_id));
+    this->bind();
+    GL_CALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_count * index_size, indices, GL_STATIC_DRAW));
+    this->unbind();
+}
+
+index_buffer::~index_buffer() {
+    get_gl_state().forget_buffer(this->buffer_id);
+    glDeleteBuffers(1, &this->buffer_id);
+}
+
+void index_buffer::bind() {
+    get_gl_state().bind_buffer(GL_ELEMENT_ARRAY_BUFFER, this->buffer_id);
+}
+
+void index_buffer::unbind() {
+    get_gl_state().bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+GLenum index_buffer::get_index_type() const {
+    return this->index_type;
+}
+
+int index_buffer::get_index_count() const {
+    return this->index_count;
+}
+
+uint32_t index_buffer::get_buffer_id() const {
+    return this->buffer_id;
+}
@@ -0,0 +1,29 @@
+#ifndef INDEX_BUFFER_HPP_
+#define INDEX_BUFFER_HPP_
+
+#include <vector>
+
+#include <stdint.h>
+
+#include <SDL2/SDL_opengles2.h>
+
+class index_buffer {
+protected:
+    uint32_t buffer_id;
+    GLenum index_type;
+    int index_count;
+public:
+    index_buffer(const std::vector<uint16_t> &indices);
+    index_buffer(const std::vector<uint32_t> &indices);
+    index_buffer(const void *indices, GLenum index_type, int index_count);
+    index_buffer(index_buffer const &) = delete;
+    ~index_buffer();
+    void operator=(index_buffer const &) = delete;
+    void bind();
+    void unbind();
+    GLenum get_index_type() const;
+    int get_index_count() const;
+    uint32_t get_buffer_id() const;
+};
+
+#endif // INDEX_BUFFER_HPP_
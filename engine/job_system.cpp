@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <stdint.h>
+
+#include <SDL2/SDL.h>
+
+#include "engine/frame_stats.hpp"
+#include "engine/job_system.hpp"
+
+const int max_job_workers = 64;
+
+// Worker 0 for the creating thread and any thread outside the pool.
+thread_local int current_worker = 0;
+
+int requested_worker_count = 0;
+
+job_counter::job_counter() : pending(0) {
+}
+
+bool job_counter::is_done() const {
+    return this->pending.load(std::memory_order_acquire) == 0;
+}
+
+// 0 workers means one per hardware thread.
+job_system::job_system(int worker_count) : queued(0), stopping(false) {
+    if (worker_count <= 0) {
+        worker_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    worker_count = std::min(worker_count, max_job_workers);
+
+    for (int i = 0; i < worker_count; i++) {
+        this->queues.emplace_back(new worker_queue());
+    }
+    get_frame_stats().set_worker_count(worker_count);
+    for (int i = 1; i < worker_count; i++) {
+        this->threads.emplace_back(&job_system::worker_loop, this, i);
+    }
+}
+
+job_system::~job_system() {
+    {
+        std::lock_guard<std::mutex> lock(this->sleep_mutex);
+        this->stopping = true;
+    }
+    this->wake.notify_all();
+    for (auto &thread : this->threads) {
+        thread.join();
+    }
+}
+
+int job_system::get_worker_count() const {
+    return this->queues.size();
+}
+
+void job_system::push(job j) {
+    worker_queue &queue = *this->queues[current_worker];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(j));
+    }
+    {
+        std::lock_guard<std::mutex> lock(this->sleep_mutex);
+        this->queued.fetch_add(1, std::memory_order_release);
+    }
+    this->wake.notify_one();
+}
+
+// Newest first from our own queue keeps its data in cache; oldest first
+// from the others' tends to steal the largest remaining pieces of work.
+bool job_system::try_run(int worker) {
+    job j;
+    bool found = false;
+    const int worker_count = this->queues.size();
+    for (int i = 0; i < worker_count && !found; i++) {
+        worker_queue &queue = *this->queues[(worker + i) % worker_count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty()) {
+            continue;
+        }
+        if (i == 0) {
+            j = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+        } else {
+            j = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+        }
+        found = true;
+    }
+    if (!found) {
+        return false;
+    }
+    this->queued.fetch_sub(1, std::memory_order_relaxed);
+
+    uint64_t start = SDL_GetPerformanceCounter();
+    j.work();
+    get_frame_stats().add_worker_ticks(worker, SDL_GetPerformanceCounter() - start);
+    this->finish(j.counter);
+    return true;
+}
+
+// The counter's mutex is held across the decrement so wait() can tell when
+// the last finisher is done touching the counter.
+void job_system::finish(job_counter *counter) {
+    std::vector<std::function<void()>> ready;
+    {
+        std::lock_guard<std::mutex> lock(counter->continuation_mutex);
+        if (counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            ready.swap(counter->continuations);
+        }
+    }
+    for (auto &continuation : ready) {
+        continuation();
+    }
+}
+
+void job_system::worker_loop(int worker) {
+    current_worker = worker;
+    while (true) {
+        if (this->try_run(worker)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(this->sleep_mutex);
+        this->wake.wait(lock, [this]() {
+            return this->stopping || this->queued.load(std::memory_order_acquire) > 0;
+        });
+        if (this->stopping) {
+            return;
+        }
+    }
+}
+
+void job_system::run(std::function<void()> work, job_counter &counter) {
+    counter.pending.fetch_add(1, std::memory_order_relaxed);
+    this->push({std::move(work), &counter});
+}
+
+// The job counts against its counter straight away, so waiting on it also
+// waits for the dependency.
+void job_system::run_after(job_counter &dependency, std::function<void()> work, job_counter &counter) {
+    counter.pending.fetch_add(1, std::memory_order_relaxed);
+    job j = {std::move(work), &counter};
+    {
+        std::lock_guard<std::mutex> lock(dependency.continuation_mutex);
+        if (!dependency.is_done()) {
+            auto shared_job = std::make_shared<job>(std::move(j));
+            dependency.continuations.push_back([this, shared_job]() {
+                this->push(std::move(*shared_job));
+            });
+            return;
+        }
+    }
+    this->push(std::move(j));
+}
+
+// Runs queued jobs instead of blocking, so waiting on the context thread
+// adds it to the pool rather than idling it.
+void job_system::wait(job_counter &counter) {
+    while (!counter.is_done()) {
+        if (!this->try_run(current_worker)) {
+            std::this_thread::yield();
+        }
+    }
+    std::lock_guard<std::mutex> lock(counter.continuation_mutex);
+}
+
+// Splits [0, count) into ranges of at least grain items, a few per worker
+// so stealing can even out uneven ranges, and returns once all are done.
+// Counts up to grain run inline, which keeps small scenes off the pool.
+void job_system::parallel_for(size_t count, size_t grain, const std::function<void(size_t, size_t)> &body) {
+    const size_t worker_count = this->queues.size();
+    grain = std::max<size_t>(grain, 1);
+    if (count <= grain || worker_count == 1) {
+        body(0, count);
+        return;
+    }
+
+    size_t range = std::max(grain, (count + worker_count * 4 - 1) / (worker_count * 4));
+    job_counter counter;
+    for (size_t begin = range; begin < count; begin += range) {
+        size_t end = std::min(begin + range, count);
+        this->run([&body, begin, end]() {
+            body(begin, end);
+        }, counter);
+    }
+    uint64_t start = SDL_GetPerformanceCounter();
+    body(0, std::min(range, count));
+    get_frame_stats().add_worker_ticks(current_worker, SDL_GetPerformanceCounter() - start);
+    this->wait(counter);
+}
+
+// Only takes effect before the first get_job_system() call.
+void set_job_worker_count(int worker_count) {
+    requested_worker_count = worker_count;
+}
+
+job_system &get_job_system() {
+    static job_system jobs(requested_worker_count);
+    return jobs;
+}
+
+int get_current_worker() {
+    return current_worker;
+}
@@ -0,0 +1,73 @@
+#ifndef JOB_SYSTEM_HPP_
+#define JOB_SYSTEM_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <stddef.h>
+
+// Counts the jobs still outstanding in a group. Jobs can be queued to
+// start only once another counter drains, which is how dependencies
+// between groups are expressed. A counter has to outlive its jobs and
+// everything waiting on it.
+class job_counter {
+protected:
+    std::atomic<int> pending;
+    std::mutex continuation_mutex;
+    std::vector<std::function<void()>> continuations;
+    friend class job_system;
+public:
+    job_counter();
+    job_counter(job_counter const &) = delete;
+    void operator=(job_counter const &) = delete;
+    bool is_done() const;
+};
+
+// A pool of worker threads with one job queue each. Workers take from the
+// back of their own queue and steal from the front of the others' when it
+// runs dry. The thread that creates the pool (the one that owns the GL
+// context) is worker 0: it runs jobs while it waits, so GL calls never
+// have to leave it and jobs must not make any.
+class job_system {
+protected:
+    struct job {
+        std::function<void()> work;
+        job_counter *counter;
+    };
+    struct worker_queue {
+        std::mutex mutex;
+        std::deque<job> jobs;
+    };
+    std::vector<std::unique_ptr<worker_queue>> queues;
+    std::vector<std::thread> threads;
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    std::atomic<int> queued;
+    bool stopping;
+    void push(job j);
+    bool try_run(int worker);
+    void finish(job_counter *counter);
+    void worker_loop(int worker);
+public:
+    job_system(int worker_count);
+    job_system(job_system const &) = delete;
+    ~job_system();
+    void operator=(job_system const &) = delete;
+    int get_worker_count() const;
+    void run(std::function<void()> work, job_counter &counter);
+    void run_after(job_counter &dependency, std::function<void()> work, job_counter &counter);
+    void wait(job_counter &counter);
+    void parallel_for(size_t count, size_t grain, const std::function<void(size_t, size_t)> &body);
+};
+
+void set_job_worker_count(int worker_count);
+job_system &get_job_system();
+int get_current_worker();
+
+#endif // JOB_SYSTEM_HPP_
@@ -1,65 +1,42 @@
+#include <SDL2/SDL.h>
+
 #include "engine/keyboard_state.hpp"
 
 keyboard_state::keyboard_state() {}
 
-void keyboard_state::update_state(uint32_t event_type, SDL_Keycode keycode) {
-    switch (event_type) {
-        case SDL_KEYDOWN:
-            switch (keycode) {
-                case SDLK_UP:    this->up_pressed = 1; break;
-                case SDLK_LEFT:  this->left_pressed = 1; break;
-                case SDLK_DOWN:  this->down_pressed = 1; break;
-                case SDLK_RIGHT: this->right_pressed = 1; break;
-                case SDLK_w: this->w_pressed = 1; break;
-                case SDLK_a: this->a_pressed = 1; break;
-                case SDLK_s: this->s_pressed = 1; break;
-                case SDLK_d: this->d_pressed = 1; break;
-            }
-            break;
-        case SDL_KEYUP:
-            switch (keycode) {
-                case SDLK_UP:    this->up_pressed = 0; break;
-                case SDLK_LEFT:  this->left_pressed = 0; break;
-                case SDLK_DOWN:  this->down_pressed = 0; break;
-                case SDLK_RIGHT: this->right_pressed = 0; break;
-                case SDLK_w: this->w_pressed = 0; break;
-                case SDLK_a: this->a_pressed = 0; break;
-                case SDLK_s: this->s_pressed = 0; break;
-                case SDLK_d: this->d_pressed = 0; break;
-            }
-            break;
+void keyboard_state::update_state(const SDL_Event &event) {
+    if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_FOCUS_GAINED) {
+        this->sync();
+        return;
+    }
+    if (event.type != SDL_KEYDOWN && event.type != SDL_KEYUP) {
+        return;
+    }
+    SDL_Scancode scancode = event.key.keysym.scancode;
+    if (scancode > SDL_SCANCODE_UNKNOWN && scancode < SDL_NUM_SCANCODES) {
+        this->pressed[scancode] = event.type == SDL_KEYDOWN;
+        if (event.type == SDL_KEYDOWN) {
+            this->tapped[scancode] = true;
+        }
     }
 }
 
-bool keyboard_state::get_up_pressed() {
-    return this->up_pressed;
-}
-
-bool keyboard_state::get_left_pressed() {
-    return this->left_pressed;
-}
-
-bool keyboard_state::get_down_pressed() {
-    return this->down_pressed;
-}
-
-bool keyboard_state::get_right_pressed() {
-    return this->right_pressed;
-}
-
-bool keyboard_state::get_w_pressed() {
-    return this->w_pressed;
-}
-
-bool keyboard_state::get_a_pressed() {
-    return this->a_pressed;
+// Takes SDL's own view of the keyboard, which also covers keys released
+// while the window didn't have focus and so never sent a key up event.
+void keyboard_state::sync() {
+    int key_count = 0;
+    const uint8_t *keys = SDL_GetKeyboardState(&key_count);
+    for (int scancode = 0; scancode < key_count && scancode < SDL_NUM_SCANCODES; scancode++) {
+        this->pressed[scancode] = keys[scancode] != 0;
+    }
 }
 
-bool keyboard_state::get_s_pressed() {
-    return this->s_pressed;
+// Called once the frame's update has read the state.
+void keyboard_state::end_frame() {
+    this->tapped.reset();
 }
 
-bool keyboard_state::get_d_pressed() {
-    return this->d_pressed;
+bool keyboard_state::is_pressed(SDL_Scancode scancode) const {
+    return scancode > SDL_SCANCODE_UNKNOWN && scancode < SDL_NUM_SCANCODES
+        && (this->pressed[scancode] || this->tapped[scancode]);
 }
-
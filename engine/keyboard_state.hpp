@@ -1,31 +1,25 @@
 #ifndef KEYBOARD_STATE_HPP_
 #define KEYBOARD_STATE_HPP_
 
-#include <stdint.h>
+#include <bitset>
 
 #include <SDL2/SDL.h>
 
+// Which keys are held, indexed by scancode so the state doesn't depend on
+// the keyboard layout. Key events are the only source, except that SDL's
+// own view is taken when the window regains focus. A key pressed since the
+// last end_frame() counts as pressed even if it was already released, so
+// taps shorter than a frame aren't lost.
 class keyboard_state {
 protected:
-    bool up_pressed = 0;
-    bool left_pressed = 0;
-    bool down_pressed = 0;
-    bool right_pressed = 0;
-    bool w_pressed = 0;
-    bool a_pressed = 0;
-    bool s_pressed = 0;
-    bool d_pressed = 0;
+    std::bitset<SDL_NUM_SCANCODES> pressed;
+    std::bitset<SDL_NUM_SCANCODES> tapped;
 public:
     keyboard_state();
-    void update_state(uint32_t event_type, SDL_Keycode keycode);
-    bool get_up_pressed();
-    bool get_left_pressed();
-    bool get_down_pressed();
-    bool get_right_pressed();
-    bool get_w_pressed();
-    bool get_a_pressed();
-    bool get_s_pressed();
-    bool get_d_pressed();
+    void update_state(const SDL_Event &event);
+    void sync();
+    void end_frame();
+    bool is_pressed(SDL_Scancode scancode) const;
 };
 
 #endif // KEYBOARD_STATE_HPP_
@@ -0,0 +1,269 @@
+#include <math.h>
+
+#include "engine/math.hpp"
+
+#if defined(ENGINE_MATH_SSE2)
+#include <emmintrin.h>
+#elif defined(ENGINE_MATH_NEON)
+#include <arm_neon.h>
+#endif
+
+vec4 operator+(const vec4 &a, const vec4 &b) {
+    return {a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w};
+}
+
+vec4 operator-(const vec4 &a, const vec4 &b) {
+    return {a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w};
+}
+
+vec4 operator*(const vec4 &a, float s) {
+    return {a.x * s, a.y * s, a.z * s, a.w * s};
+}
+
+float dot3(const vec4 &a, const vec4 &b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+vec4 cross3(const vec4 &a, const vec4 &b) {
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x, 0.0f};
+}
+
+vec4 normalize3(const vec4 &a) {
+    float length = sqrtf(dot3(a, a));
+    return length > 0.0f ? vec4{a.x / length, a.y / length, a.z / length, 0.0f} : a;
+}
+
+mat4 mat4_multiply_scalar(const mat4 &a, const mat4 &b) {
+    mat4 result;
+    for (int c = 0; c < 4; c++) {
+        result.columns[c] = mat4_transform_scalar(a, b.columns[c]);
+    }
+    return result;
+}
+
+vec4 mat4_transform_scalar(const mat4 &m, const vec4 &v) {
+    const vec4 *c = m.columns;
+    return {
+        c[0].x * v.x + c[1].x * v.y + c[2].x * v.z + c[3].x * v.w,
+        c[0].y * v.x + c[1].y * v.y + c[2].y * v.z + c[3].y * v.w,
+        c[0].z * v.x + c[1].z * v.y + c[2].z * v.z + c[3].z * v.w,
+        c[0].w * v.x + c[1].w * v.y + c[2].w * v.z + c[3].w * v.w,
+    };
+}
+
+void transform_vec4s_scalar(const mat4 &m, const vec4 *in, vec4 *out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = mat4_transform_scalar(m, in[i]);
+    }
+}
+
+// Each result is a linear combination of the matrix columns, so the SIMD
+// paths broadcast one vector component at a time and accumulate columns.
+#if defined(ENGINE_MATH_SSE2)
+inline __m128 transform_sse2(const __m128 *c, __m128 v) {
+    __m128 r = _mm_mul_ps(c[0], _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+    r = _mm_add_ps(r, _mm_mul_ps(c[1], _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+    r = _mm_add_ps(r, _mm_mul_ps(c[2], _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+    return _mm_add_ps(r, _mm_mul_ps(c[3], _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))));
+}
+#elif defined(ENGINE_MATH_NEON)
+inline float32x4_t transform_neon(const float32x4_t *c, float32x4_t v) {
+    float32x4_t r = vmulq_lane_f32(c[0], vget_low_f32(v), 0);
+    r = vmlaq_lane_f32(r, c[1], vget_low_f32(v), 1);
+    r = vmlaq_lane_f32(r, c[2], vget_high_f32(v), 0);
+    return vmlaq_lane_f32(r, c[3], vget_high_f32(v), 1);
+}
+#endif
+
+mat4 operator*(const mat4 &a, const mat4 &b) {
+#if defined(ENGINE_MATH_SSE2)
+    const __m128 c[4] = {
+        _mm_load_ps(&a.columns[0].x), _mm_load_ps(&a.columns[1].x),
+        _mm_load_ps(&a.columns[2].x), _mm_load_ps(&a.columns[3].x),
+    };
+    mat4 result;
+    for (int i = 0; i < 4; i++) {
+        _mm_store_ps(&result.columns[i].x, transform_sse2(c, _mm_load_ps(&b.columns[i].x)));
+    }
+    return result;
+#elif defined(ENGINE_MATH_NEON)
+    const float32x4_t c[4] = {
+        vld1q_f32(&a.columns[0].x), vld1q_f32(&a.columns[1].x),
+        vld1q_f32(&a.columns[2].x), vld1q_f32(&a.columns[3].x),
+    };
+    mat4 result;
+    for (int i = 0; i < 4; i++) {
+        vst1q_f32(&result.columns[i].x, transform_neon(c, vld1q_f32(&b.columns[i].x)));
+    }
+    return result;
+#else
+    return mat4_multiply_scalar(a, b);
+#endif
+}
+
+vec4 operator*(const mat4 &m, const vec4 &v) {
+    vec4 result;
+    transform_vec4s(m, &v, &result, 1);
+    return result;
+}
+
+void transform_vec4s(const mat4 &m, const vec4 *in, vec4 *out, size_t count) {
+#if defined(ENGINE_MATH_SSE2)
+    const __m128 c[4] = {
+        _mm_load_ps(&m.columns[0].x), _mm_load_ps(&m.columns[1].x),
+        _mm_load_ps(&m.columns[2].x), _mm_load_ps(&m.columns[3].x),
+    };
+    for (size_t i = 0; i < count; i++) {
+        _mm_store_ps(&out[i].x, transform_sse2(c, _mm_load_ps(&in[i].x)));
+    }
+#elif defined(ENGINE_MATH_NEON)
+    const float32x4_t c[4] = {
+        vld1q_f32(&m.columns[0].x), vld1q_f32(&m.columns[1].x),
+        vld1q_f32(&m.columns[2].x), vld1q_f32(&m.columns[3].x),
+    };
+    for (size_t i = 0; i < count; i++) {
+        vst1q_f32(&out[i].x, transform_neon(c, vld1q_f32(&in[i].x)));
+    }
+#else
+    transform_vec4s_scalar(m, in, out, count);
+#endif
+}
+
+mat4 mat4_identity() {
+    return {{
+        {1, 0, 0, 0},
+        {0, 1, 0, 0},
+        {0, 0, 1, 0},
+        {0, 0, 0, 1},
+    }};
+}
+
+mat4 mat4_translation(float x, float y, float z) {
+    mat4 m = mat4_identity();
+    m.columns[3] = {x, y, z, 1};
+    return m;
+}
+
+mat4 mat4_rotation_x(float angle) {
+    float s = sinf(angle);
+    float c = cosf(angle);
+    return {{
+        {1, 0, 0, 0},
+        {0, c, s, 0},
+        {0, -s, c, 0},
+        {0, 0, 0, 1},
+    }};
+}
+
+mat4 mat4_rotation_y(float angle) {
+    float s = sinf(angle);
+    float c = cosf(angle);
+    return {{
+        {c, 0, -s, 0},
+        {0, 1, 0, 0},
+        {s, 0, c, 0},
+        {0, 0, 0, 1},
+    }};
+}
+
+mat4 mat4_rotation_z(float angle) {
+    float s = sinf(angle);
+    float c = cosf(angle);
+    return {{
+        {c, s, 0, 0},
+        {-s, c, 0, 0},
+        {0, 0, 1, 0},
+        {0, 0, 0, 1},
+    }};
+}
+
+// Same mapping the modules used to build by hand: x and y scaled by the
+// frustum scale, z from [-z_near, -z_far] onto [-1, 1], w = -z.
+mat4 mat4_perspective(float frustum_scale, float z_near, float z_far) {
+    float z_mapping_factor = (z_near + z_far) / (z_near - z_far);
+    float z_mapping_offset = (2 * z_near * z_far) / (z_near - z_far);
+    return {{
+        {frustum_scale, 0, 0, 0},
+        {0, frustum_scale, 0, 0},
+        {0, 0, z_mapping_factor, -1},
+        {0, 0, z_mapping_offset, 0},
+    }};
+}
+
+mat4 mat4_look_at(const vec4 &eye, const vec4 &target, const vec4 &up) {
+    vec4 forward = normalize3(target - eye);
+    vec4 side = normalize3(cross3(forward, up));
+    vec4 true_up = cross3(side, forward);
+    return {{
+        {side.x, true_up.x, -forward.x, 0},
+        {side.y, true_up.y, -forward.y, 0},
+        {side.z, true_up.z, -forward.z, 0},
+        {-dot3(side, eye), -dot3(true_up, eye), dot3(forward, eye), 1},
+    }};
+}
+
+mat4 mat4_transpose(const mat4 &m) {
+    const vec4 *c = m.columns;
+    return {{
+        {c[0].x, c[1].x, c[2].x, c[3].x},
+        {c[0].y, c[1].y, c[2].y, c[3].y},
+        {c[0].z, c[1].z, c[2].z, c[3].z},
+        {c[0].w, c[1].w, c[2].w, c[3].w},
+    }};
+}
+
+// General inverse via 2x2 sub-determinants (cofactor expansion). It isn't
+// on any per-frame path, so it stays scalar. Singular matrices return the
+// identity.
+mat4 mat4_inverse(const mat4 &m) {
+    const float *a = mat4_data(m);
+    float s0 = a[0] * a[5] - a[1] * a[4];
+    float s1 = a[0] * a[6] - a[2] * a[4];
+    float s2 = a[0] * a[7] - a[3] * a[4];
+    float s3 = a[1] * a[6] - a[2] * a[5];
+    float s4 = a[1] * a[7] - a[3] * a[5];
+    float s5 = a[2] * a[7] - a[3] * a[6];
+    float c5 = a[10] * a[15] - a[11] * a[14];
+    float c4 = a[9] * a[15] - a[11] * a[13];
+    float c3 = a[9] * a[14] - a[10] * a[13];
+    float c2 = a[8] * a[15] - a[11] * a[12];
+    float c1 = a[8] * a[14] - a[10] * a[12];
+    float c0 = a[8] * a[13] - a[9] * a[12];
+
+    float determinant = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    if (determinant == 0.0f) {
+        return mat4_identity();
+    }
+    float d = 1.0f / determinant;
+
+    return {{
+        {
+            (a[5] * c5 - a[6] * c4 + a[7] * c3) * d,
+            (-a[1] * c5 + a[2] * c4 - a[3] * c3) * d,
+            (a[13] * s5 - a[14] * s4 + a[15] * s3) * d,
+            (-a[9] * s5 + a[10] * s4 - a[11] * s3) * d,
+        },
+        {
+            (-a[4] * c5 + a[6] * c2 - a[7] * c1) * d,
+            (a[0] * c5 - a[2] * c2 + a[3] * c1) * d,
+            (-a[12] * s5 + a[14] * s2 - a[15] * s1) * d,
+            (a[8] * s5 - a[10] * s2 + a[11] * s1) * d,
+        },
+        {
+            (a[4] * c4 - a[5] * c2 + a[7] * c0) * d,
+            (-a[0] * c4 + a[1] * c2 - a[3] * c0) * d,
+            (a[12] * s4 - a[13] * s2 + a[15] * s0) * d,
+            (-a[8] * s4 + a[9] * s2 - a[11] * s0) * d,
+        },
+        {
+            (-a[4] * c3 + a[5] * c1 - a[6] * c0) * d,
+            (a[0] * c3 - a[1] * c1 + a[2] * c0) * d,
+            (-a[12] * s3 + a[13] * s1 - a[14] * s0) * d,
+            (a[8] * s3 - a[9] * s1 + a[10] * s0) * d,
+        },
+    }};
+}
+
+const float *mat4_data(const mat4 &m) {
+    return &m.columns[0].x;
+}
@@ -0,0 +1,64 @@
+#ifndef MATH_HPP_
+#define MATH_HPP_
+
+#include <stddef.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ENGINE_MATH_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define ENGINE_MATH_NEON
+#endif
+
+struct vec2 {
+    float x;
+    float y;
+};
+
+struct vec3 {
+    float x;
+    float y;
+    float z;
+};
+
+struct alignas(16) vec4 {
+    float x;
+    float y;
+    float z;
+    float w;
+};
+
+// Column-major like GL, so a mat4 can be passed straight to
+// glUniformMatrix4fv without transposing.
+struct alignas(16) mat4 {
+    vec4 columns[4];
+};
+
+vec4 operator+(const vec4 &a, const vec4 &b);
+vec4 operator-(const vec4 &a, const vec4 &b);
+vec4 operator*(const vec4 &a, float s);
+float dot3(const vec4 &a, const vec4 &b);
+vec4 cross3(const vec4 &a, const vec4 &b);
+vec4 normalize3(const vec4 &a);
+
+mat4 operator*(const mat4 &a, const mat4 &b);
+vec4 operator*(const mat4 &m, const vec4 &v);
+void transform_vec4s(const mat4 &m, const vec4 *in, vec4 *out, size_t count);
+
+mat4 mat4_identity();
+mat4 mat4_translation(float x, float y, float z);
+mat4 mat4_rotation_x(float angle);
+mat4 mat4_rotation_y(float angle);
+mat4 mat4_rotation_z(float angle);
+mat4 mat4_perspective(float frustum_scale, float z_near, float z_far);
+mat4 mat4_look_at(const vec4 &eye, const vec4 &target, const vec4 &up);
+mat4 mat4_transpose(const mat4 &m);
+mat4 mat4_inverse(const mat4 &m);
+const float *mat4_data(const mat4 &m);
+
+// Plain scalar versions of the SIMD paths, kept for comparison and as the
+// fallback when no vector unit is available.
+mat4 mat4_multiply_scalar(const mat4 &a, const mat4 &b);
+vec4 mat4_transform_scalar(const mat4 &m, const vec4 &v);
+void transform_vec4s_scalar(const mat4 &m, const vec4 *in, vec4 *out, size_t count);
+
+#endif // MATH_HPP_
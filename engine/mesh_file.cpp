@@ -0,0 +1,260 @@
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MESH_FILE_MMAP
+#endif
+
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/mesh_file.hpp"
+
+const char mesh_file_magic[4] = {'M', 'E', 'S', 'H'};
+const size_t mesh_blob_alignment = 16;
+
+size_t align_blob(size_t offset) {
+    return (offset + mesh_blob_alignment - 1) & ~(mesh_blob_alignment - 1);
+}
+
+// Indices are stored as 16-bit whenever the vertex count allows, since
+// 32-bit index buffers need an extension in ES 2.0.
+void write_mesh_file(
+        const std::string &path,
+        const vertex_layout &layout,
+        const std::vector<uint8_t> &vertices,
+        size_t vertex_count,
+        const std::vector<uint32_t> &indices,
+        const bounding_box &bounds) {
+    const auto &attributes = layout.get_attributes();
+    bool short_indices = vertex_count <= 65536;
+
+    mesh_file_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, mesh_file_magic, sizeof(header.magic));
+    header.version = mesh_file_version;
+    header.attribute_count = attributes.size();
+    header.vertex_count = vertex_count;
+    header.index_count = indices.size();
+    header.index_type = short_indices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    memcpy(header.bounds_min, &bounds.min.x, sizeof(header.bounds_min));
+    memcpy(header.bounds_max, &bounds.max.x, sizeof(header.bounds_max));
+    header.vertex_offset = align_blob(sizeof(header) + attributes.size() * sizeof(mesh_file_attribute));
+    header.vertex_bytes = vertices.size();
+    header.index_offset = align_blob(header.vertex_offset + header.vertex_bytes);
+    header.index_bytes = indices.size() * (short_indices ? sizeof(uint16_t) : sizeof(uint32_t));
+
+    std::vector<mesh_file_attribute> records;
+    for (const auto &attribute : attributes) {
+        if (attribute.name.size() >= mesh_attribute_name_size) {
+            throw std::runtime_error("attribute name \"" + attribute.name + "\" is too long for a mesh file");
+        }
+        mesh_file_attribute record;
+        memset(&record, 0, sizeof(record));
+        memcpy(record.name, attribute.name.c_str(), attribute.name.size());
+        record.components = attribute.components;
+        record.type = attribute.type;
+        record.normalized = attribute.normalized;
+        record.stride = attribute.stride;
+        record.offset = attribute.offset;
+        records.push_back(record);
+    }
+
+    std::vector<uint8_t> file(header.index_offset + header.index_bytes, 0);
+    memcpy(file.data(), &header, sizeof(header));
+    memcpy(file.data() + sizeof(header), records.data(), records.size() * sizeof(mesh_file_attribute));
+    memcpy(file.data() + header.vertex_offset, vertices.data(), vertices.size());
+    uint8_t *index_data = file.data() + header.index_offset;
+    for (size_t i = 0; i < indices.size(); i++) {
+        if (short_indices) {
+            uint16_t index = indices[i];
+            memcpy(index_data + i * sizeof(index), &index, sizeof(index));
+        } else {
+            memcpy(index_data + i * sizeof(uint32_t), &indices[i], sizeof(uint32_t));
+        }
+    }
+
+    // Written next to the target and renamed, so a reader never maps a
+    // half-written file.
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out.write((const char*) file.data(), file.size())) {
+            throw std::runtime_error("couldn't write \"" + temp_path + "\"");
+        }
+    }
+    if (rename(temp_path.c_str(), path.c_str()) != 0) {
+        remove(temp_path.c_str());
+        throw std::runtime_error("couldn't rename \"" + temp_path + "\" to \"" + path + "\"");
+    }
+}
+
+mapped_mesh::mapped_mesh(const std::string &path) : data(NULL), size(0) {
+#ifdef MESH_FILE_MMAP
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("couldn't open \"" + path + "\"");
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+        close(fd);
+        throw std::runtime_error("couldn't read \"" + path + "\"");
+    }
+    this->size = file_stat.st_size;
+    void *mapping = mmap(NULL, this->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("couldn't map \"" + path + "\"");
+    }
+    // The whole file is about to be uploaded front to back. Advice values
+    // are an enumeration, not flags, so each takes its own call.
+    madvise(mapping, this->size, MADV_SEQUENTIAL);
+    madvise(mapping, this->size, MADV_WILLNEED);
+    this->data = (const uint8_t*) mapping;
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("couldn't open \"" + path + "\"");
+    }
+    this->fallback.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    this->data = this->fallback.data();
+    this->size = this->fallback.size();
+#endif
+
+    try {
+        this->parse(path);
+    } catch (...) {
+#ifdef MESH_FILE_MMAP
+        munmap((void*) this->data, this->size);
+#endif
+        throw;
+    }
+}
+
+mapped_mesh::~mapped_mesh() {
+#ifdef MESH_FILE_MMAP
+    munmap((void*) this->data, this->size);
+#endif
+}
+
+// Checks everything the accessors rely on, so a truncated or foreign file
+// fails here instead of reading past the mapping later.
+void mapped_mesh::parse(const std::string &path) {
+    if (this->size < sizeof(mesh_file_header)) {
+        throw std::runtime_error("\"" + path + "\" is too short to be a mesh file");
+    }
+    memcpy(&this->header, this->data, sizeof(this->header));
+    if (memcmp(this->header.magic, mesh_file_magic, sizeof(mesh_file_magic)) != 0) {
+        throw std::runtime_error("\"" + path + "\" isn't a mesh file");
+    }
+    if (this->header.version != mesh_file_version) {
+        throw std::runtime_error("\"" + path + "\" has unsupported mesh file version " + std::to_string(this->header.version));
+    }
+
+    size_t index_size = this->header.index_type == GL_UNSIGNED_INT ? sizeof(uint32_t) : sizeof(uint16_t);
+    bool valid_index_type = this->header.index_type == GL_UNSIGNED_SHORT || this->header.index_type == GL_UNSIGNED_INT;
+    uint64_t attributes_end = sizeof(mesh_file_header) + (uint64_t) this->header.attribute_count * sizeof(mesh_file_attribute);
+    if (!valid_index_type
+            || attributes_end > this->size
+            || this->header.vertex_offset > this->size
+            || this->header.vertex_bytes > this->size - this->header.vertex_offset
+            || this->header.index_offset > this->size
+            || this->header.index_offset % index_size != 0
+            || this->header.index_bytes > this->size - this->header.index_offset
+            || this->header.index_bytes != (uint64_t) this->header.index_count * index_size) {
+        throw std::runtime_error("\"" + path + "\" is corrupt");
+    }
+
+    for (uint32_t i = 0; i < this->header.attribute_count; i++) {
+        mesh_file_attribute record;
+        memcpy(&record, this->data + sizeof(mesh_file_header) + i * sizeof(record), sizeof(record));
+        record.name[mesh_attribute_name_size - 1] = '\0';
+        if (this->header.vertex_count > 0 && record.offset + (uint64_t) record.stride * (this->header.vertex_count - 1)
+                + get_gl_type_size(record.type) * record.components > this->header.vertex_bytes) {
+            throw std::runtime_error("\"" + path + "\" has an attribute outside its vertex data");
+        }
+        this->layout.add({record.name, (GLint) record.components, record.type, (GLboolean) record.normalized,
+                (GLsizei) record.stride, record.offset});
+    }
+
+    // Indices reach drawable::append_to_batch() and the GPU unchecked, so a
+    // single one past the vertices has to fail here.
+    for (uint32_t i = 0; i < this->header.index_count; i++) {
+        if (this->get_index(i) >= this->header.vertex_count) {
+            throw std::runtime_error("\"" + path + "\" has index " + std::to_string(this->get_index(i))
+                + " past its " + std::to_string(this->header.vertex_count) + " vertices");
+        }
+    }
+
+    memcpy(&this->bounds.min.x, this->header.bounds_min, sizeof(this->header.bounds_min));
+    memcpy(&this->bounds.max.x, this->header.bounds_max, sizeof(this->header.bounds_max));
+}
+
+// Reads one byte of every page so the disk reads happen on the calling
+// thread rather than in whichever later call first touches the data.
+void mapped_mesh::prefault() const {
+#ifdef MESH_FILE_MMAP
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+    volatile uint8_t sink = 0;
+    for (size_t offset = 0; offset < this->size; offset += page_size) {
+        sink += this->data[offset];
+    }
+#endif
+}
+
+const vertex_layout &mapped_mesh::get_layout() const {
+    return this->layout;
+}
+
+const uint8_t *mapped_mesh::get_vertex_data() const {
+    return this->data + this->header.vertex_offset;
+}
+
+size_t mapped_mesh::get_vertex_bytes() const {
+    return this->header.vertex_bytes;
+}
+
+int mapped_mesh::get_vertex_count() const {
+    return this->header.vertex_count;
+}
+
+const void *mapped_mesh::get_index_data() const {
+    return this->data + this->header.index_offset;
+}
+
+int mapped_mesh::get_index_count() const {
+    return this->header.index_count;
+}
+
+size_t mapped_mesh::get_index_bytes() const {
+    return this->header.index_bytes;
+}
+
+GLenum mapped_mesh::get_index_type() const {
+    return this->header.index_type;
+}
+
+uint32_t mapped_mesh::get_index(int i) const {
+    const uint8_t *index_data = this->data + this->header.index_offset;
+    if (this->header.index_type == GL_UNSIGNED_INT) {
+        uint32_t index;
+        memcpy(&index, index_data + i * sizeof(index), sizeof(index));
+        return index;
+    }
+    uint16_t index;
+    memcpy(&index, index_data + i * sizeof(index), sizeof(index));
+    return index;
+}
+
+const bounding_box &mapped_mesh::get_bounds() const {
+    return this->bounds;
+}
@@ -0,0 +1,83 @@
+#ifndef MESH_FILE_HPP_
+#define MESH_FILE_HPP_
+
+#include <string>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/frustum.hpp"
+#include "engine/vertex_layout.hpp"
+
+const uint32_t mesh_file_version = 1;
+const size_t mesh_attribute_name_size = 32;
+
+// On-disk layout, little endian: the header, attribute_count attribute
+// records, then the vertex and index blobs at the recorded offsets, each
+// 16-byte aligned so they can be handed to GL straight from a mapping.
+struct mesh_file_header {
+    char magic[4];
+    uint32_t version;
+    uint32_t attribute_count;
+    uint32_t vertex_count;
+    uint32_t index_count;
+    uint32_t index_type;
+    float bounds_min[3];
+    float bounds_max[3];
+    uint64_t vertex_offset;
+    uint64_t vertex_bytes;
+    uint64_t index_offset;
+    uint64_t index_bytes;
+};
+
+struct mesh_file_attribute {
+    char name[mesh_attribute_name_size];
+    uint32_t components;
+    uint32_t type;
+    uint32_t normalized;
+    uint32_t stride;
+    uint64_t offset;
+};
+
+void write_mesh_file(
+        const std::string &path,
+        const vertex_layout &layout,
+        const std::vector<uint8_t> &vertices,
+        size_t vertex_count,
+        const std::vector<uint32_t> &indices,
+        const bounding_box &bounds);
+
+// A mesh file mapped read-only into memory. The vertex and index pointers
+// point into the mapping, so uploads read the page cache directly with no
+// parsing or intermediate copy; they stay valid while the object lives.
+class mapped_mesh {
+protected:
+    const uint8_t *data;
+    size_t size;
+    std::vector<uint8_t> fallback;
+    mesh_file_header header;
+    vertex_layout layout;
+    bounding_box bounds;
+    void parse(const std::string &path);
+public:
+    mapped_mesh(const std::string &path);
+    mapped_mesh(mapped_mesh const &) = delete;
+    ~mapped_mesh();
+    void operator=(mapped_mesh const &) = delete;
+    void prefault() const;
+    const vertex_layout &get_layout() const;
+    const uint8_t *get_vertex_data() const;
+    size_t get_vertex_bytes() const;
+    int get_vertex_count() const;
+    const void *get_index_data() const;
+    int get_index_count() const;
+    size_t get_index_bytes() const;
+    GLenum get_index_type() const;
+    uint32_t get_index(int i) const;
+    const bounding_box &get_bounds() const;
+};
+
+#endif // MESH_FILE_HPP_
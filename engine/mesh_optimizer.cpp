@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <math.h>
+#include <string.h>
+
+#include "engine/mesh_optimizer.hpp"
+
+const int vertex_cache_size = 32;
+
+uint64_t hash_vertex(const uint8_t *vertex, size_t vertex_size) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < vertex_size; i++) {
+        hash = (hash ^ vertex[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// Collapses byte-identical vertices of an unindexed (or fully expanded)
+// interleaved vertex stream and returns the unique vertex count. The hash
+// table uses open addressing with at least twice as many slots as vertices.
+size_t weld_vertices(
+        const std::vector<uint8_t> &vertices,
+        size_t vertex_size,
+        std::vector<uint8_t> &welded_vertices,
+        std::vector<uint32_t> &indices) {
+    size_t vertex_count = vertices.size() / vertex_size;
+    size_t slot_count = 1;
+    while (slot_count < vertex_count * 2) {
+        slot_count <<= 1;
+    }
+    const uint32_t empty_slot = 0xffffffff;
+    std::vector<uint32_t> slots(slot_count, empty_slot);
+
+    welded_vertices.clear();
+    indices.resize(vertex_count);
+    size_t unique_count = 0;
+    for (size_t v = 0; v < vertex_count; v++) {
+        const uint8_t *vertex = &vertices[v * vertex_size];
+        size_t slot = hash_vertex(vertex, vertex_size) & (slot_count - 1);
+        while (slots[slot] != empty_slot
+                && memcmp(&welded_vertices[slots[slot] * vertex_size], vertex, vertex_size) != 0) {
+            slot = (slot + 1) & (slot_count - 1);
+        }
+        if (slots[slot] == empty_slot) {
+            slots[slot] = unique_count++;
+            welded_vertices.insert(welded_vertices.end(), vertex, vertex + vertex_size);
+        }
+        indices[v] = slots[slot];
+    }
+    return unique_count;
+}
+
+float get_vertex_score(int cache_position, uint32_t remaining_triangles) {
+    if (remaining_triangles == 0) {
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cache_position >= 0) {
+        if (cache_position < 3) {
+            score = 0.75f;
+        } else {
+            float scaled = 1.0f - (cache_position - 3) / (float) (vertex_cache_size - 3);
+            score = powf(scaled, 1.5f);
+        }
+    }
+    return score + 2.0f / sqrtf(remaining_triangles);
+}
+
+// Tom Forsyth's linear-speed vertex cache optimisation: greedily emit the
+// triangle whose vertices score highest, where recently used vertices and
+// vertices with few remaining triangles score best.
+void optimize_vertex_cache(std::vector<uint32_t> &indices, size_t vertex_count) {
+    size_t triangle_count = indices.size() / 3;
+
+    std::vector<uint32_t> remaining(vertex_count, 0);
+    for (const auto &index : indices) {
+        remaining[index]++;
+    }
+    std::vector<uint32_t> adjacency_offsets(vertex_count + 1, 0);
+    for (size_t v = 0; v < vertex_count; v++) {
+        adjacency_offsets[v + 1] = adjacency_offsets[v] + remaining[v];
+    }
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+    for (size_t t = 0; t < triangle_count; t++) {
+        for (int i = 0; i < 3; i++) {
+            uint32_t v = indices[t * 3 + i];
+            adjacency[fill[v]++] = t;
+        }
+    }
+
+    std::vector<int> cache_position(vertex_count, -1);
+    std::vector<float> vertex_score(vertex_count);
+    for (size_t v = 0; v < vertex_count; v++) {
+        vertex_score[v] = get_vertex_score(-1, remaining[v]);
+    }
+    std::vector<float> triangle_score(triangle_count);
+    for (size_t t = 0; t < triangle_count; t++) {
+        triangle_score[t] = vertex_score[indices[t * 3]] + vertex_score[indices[t * 3 + 1]] + vertex_score[indices[t * 3 + 2]];
+    }
+    std::vector<bool> emitted(triangle_count, false);
+
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> next_cache;
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    size_t scan_cursor = 0;
+
+    while (output.size() < triangle_count * 3) {
+        int64_t best = -1;
+        float best_score = -1.0f;
+        for (const auto &v : cache) {
+            for (uint32_t a = adjacency_offsets[v]; a < adjacency_offsets[v] + remaining[v]; a++) {
+                uint32_t t = adjacency[a];
+                if (triangle_score[t] > best_score) {
+                    best_score = triangle_score[t];
+                    best = t;
+                }
+            }
+        }
+        if (best < 0) {
+            while (emitted[scan_cursor]) {
+                scan_cursor++;
+            }
+            best = scan_cursor;
+        }
+
+        emitted[best] = true;
+        const uint32_t *triangle = &indices[best * 3];
+        next_cache.assign(triangle, triangle + 3);
+        for (int i = 0; i < 3; i++) {
+            uint32_t v = triangle[i];
+            output.push_back(v);
+
+            uint32_t *begin = &adjacency[adjacency_offsets[v]];
+            uint32_t *end = begin + remaining[v];
+            uint32_t *found = std::find(begin, end, (uint32_t) best);
+            std::swap(*found, *(end - 1));
+            remaining[v]--;
+        }
+        for (const auto &v : cache) {
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                next_cache.push_back(v);
+            }
+        }
+
+        for (size_t i = 0; i < next_cache.size(); i++) {
+            uint32_t v = next_cache[i];
+            cache_position[v] = i < vertex_cache_size ? i : -1;
+            vertex_score[v] = get_vertex_score(cache_position[v], remaining[v]);
+        }
+        for (const auto &v : next_cache) {
+            for (uint32_t a = adjacency_offsets[v]; a < adjacency_offsets[v] + remaining[v]; a++) {
+                uint32_t t = adjacency[a];
+                triangle_score[t] = vertex_score[indices[t * 3]] + vertex_score[indices[t * 3 + 1]] + vertex_score[indices[t * 3 + 2]];
+            }
+        }
+
+        if (next_cache.size() > vertex_cache_size) {
+            next_cache.resize(vertex_cache_size);
+        }
+        cache.swap(next_cache);
+    }
+
+    indices.swap(output);
+}
+
+// Renumbers vertices in the order the index stream first touches them so
+// vertex fetch walks memory forwards. Unreferenced vertices are dropped.
+size_t optimize_vertex_fetch(std::vector<uint8_t> &vertices, size_t vertex_size, std::vector<uint32_t> &indices) {
+    const uint32_t unmapped = 0xffffffff;
+    std::vector<uint32_t> remap(vertices.size() / vertex_size, unmapped);
+    std::vector<uint8_t> reordered;
+    reordered.reserve(vertices.size());
+
+    uint32_t next_vertex = 0;
+    for (auto &index : indices) {
+        if (remap[index] == unmapped) {
+            remap[index] = next_vertex++;
+            const uint8_t *vertex = &vertices[index * vertex_size];
+            reordered.insert(reordered.end(), vertex, vertex + vertex_size);
+        }
+        index = remap[index];
+    }
+
+    vertices.swap(reordered);
+    return next_vertex;
+}
+
+std::vector<uint16_t> get_short_indices(const std::vector<uint32_t> &indices) {
+    std::vector<uint16_t> short_indices(indices.size());
+    for (size_t i = 0; i < indices.size(); i++) {
+        if (indices[i] > 0xffff) {
+            throw std::runtime_error("mesh has too many vertices for 16-bit indices");
+        }
+        short_indices[i] = indices[i];
+    }
+    return short_indices;
+}
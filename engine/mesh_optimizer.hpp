@@ -0,0 +1,18 @@
+#ifndef MESH_OPTIMIZER_HPP_
+#define MESH_OPTIMIZER_HPP_
+
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+size_t weld_vertices(
+        const std::vector<uint8_t> &vertices,
+        size_t vertex_size,
+        std::vector<uint8_t> &welded_vertices,
+        std::vector<uint32_t> &indices);
+void optimize_vertex_cache(std::vector<uint32_t> &indices, size_t vertex_count);
+size_t optimize_vertex_fetch(std::vector<uint8_t> &vertices, size_t vertex_size, std::vector<uint32_t> &indices);
+std::vector<uint16_t> get_short_indices(const std::vector<uint32_t> &indices);
+
+#endif // MESH_OPTIMIZER_HPP_
@@ -0,0 +1,197 @@
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/obj_parser.hpp"
+
+struct obj_corner {
+    long position;
+    long normal;
+};
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// OBJ indices are 1-based, or negative to count back from the latest
+// element; returns a 0-based index or -1 when out of range.
+long resolve_obj_index(long index, size_t count) {
+    if (index > 0 && (size_t) index <= count) {
+        return index - 1;
+    }
+    if (index < 0 && (size_t) -index <= count) {
+        return count + index;
+    }
+    return -1;
+}
+
+uint8_t to_color_byte(float value) {
+    return (uint8_t) (fminf(fmaxf(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+// Supports v (with optional rgb vertex colours), vn and polygonal f
+// statements in all four index forms; everything else is skipped. Faces
+// are fanned into triangles and identical position/normal pairs share a
+// vertex. Without vertex colours the colour comes from the normal, or
+// from the position within the bounds when there are no normals either.
+obj_mesh parse_obj(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("couldn't open \"" + path + "\"");
+    }
+    std::stringstream contents;
+    contents << in.rdbuf();
+    const std::string text = contents.str();
+
+    std::vector<float> positions;
+    std::vector<float> colors;
+    std::vector<float> normals;
+    std::vector<obj_corner> corners;
+    std::unordered_map<uint64_t, uint32_t> corner_indices;
+    obj_mesh mesh;
+    std::vector<uint32_t> face;
+
+    int line_number = 0;
+    const char *line = text.c_str();
+    const char *text_end = line + text.size();
+    while (line < text_end) {
+        const char *line_end = (const char*) memchr(line, '\n', text_end - line);
+        if (line_end == NULL) {
+            line_end = text_end;
+        }
+        line_number++;
+
+        const char *p = line;
+        while (p < line_end && is_space(*p)) {
+            p++;
+        }
+        if (p + 2 < line_end && p[0] == 'v' && is_space(p[1])) {
+            char *end;
+            float values[6];
+            int count = 0;
+            p += 2;
+            while (count < 6) {
+                values[count] = strtof(p, &end);
+                if (end == p || end > line_end) {
+                    break;
+                }
+                p = end;
+                count++;
+            }
+            if (count < 3) {
+                throw std::runtime_error(path + ":" + std::to_string(line_number) + ": vertex needs three coordinates");
+            }
+            positions.insert(positions.end(), values, values + 3);
+            if (count == 6) {
+                colors.resize(positions.size() - 3, -1.0f);
+                colors.insert(colors.end(), values + 3, values + 6);
+            }
+        } else if (p + 3 < line_end && p[0] == 'v' && p[1] == 'n' && is_space(p[2])) {
+            char *end;
+            p += 3;
+            for (int i = 0; i < 3; i++) {
+                normals.push_back(strtof(p, &end));
+                p = end;
+            }
+        } else if (p + 2 < line_end && p[0] == 'f' && is_space(p[1])) {
+            face.clear();
+            p += 2;
+            while (true) {
+                while (p < line_end && is_space(*p)) {
+                    p++;
+                }
+                if (p >= line_end) {
+                    break;
+                }
+                char *end;
+                long position = resolve_obj_index(strtol(p, &end, 10), positions.size() / 3);
+                long normal = -1;
+                if (end == p || position < 0) {
+                    throw std::runtime_error(path + ":" + std::to_string(line_number) + ": invalid face vertex");
+                }
+                p = end;
+                if (*p == '/') {
+                    p++;
+                    strtol(p, &end, 10);
+                    p = end;
+                    if (*p == '/') {
+                        p++;
+                        normal = resolve_obj_index(strtol(p, &end, 10), normals.size() / 3);
+                        p = end;
+                    }
+                }
+
+                uint64_t key = ((uint64_t) position << 32) | (uint32_t) (normal + 1);
+                auto found = corner_indices.find(key);
+                if (found == corner_indices.end()) {
+                    found = corner_indices.emplace(key, corners.size()).first;
+                    corners.push_back({position, normal});
+                }
+                face.push_back(found->second);
+                while (p < line_end && !is_space(*p)) {
+                    p++;
+                }
+            }
+            for (size_t i = 1; i + 1 < face.size(); i++) {
+                mesh.indices.push_back(face[0]);
+                mesh.indices.push_back(face[i]);
+                mesh.indices.push_back(face[i + 1]);
+            }
+        }
+        line = line_end + 1;
+    }
+
+    mesh.bounds.min = {INFINITY, INFINITY, INFINITY};
+    mesh.bounds.max = {-INFINITY, -INFINITY, -INFINITY};
+    for (const auto &corner : corners) {
+        const float *position = &positions[corner.position * 3];
+        float *min = &mesh.bounds.min.x;
+        float *max = &mesh.bounds.max.x;
+        for (int c = 0; c < 3; c++) {
+            min[c] = fminf(min[c], position[c]);
+            max[c] = fmaxf(max[c], position[c]);
+        }
+    }
+    if (corners.empty()) {
+        mesh.bounds.min = {0, 0, 0};
+        mesh.bounds.max = {0, 0, 0};
+    }
+
+    mesh.layout.append("position", 3, GL_FLOAT, GL_FALSE);
+    mesh.layout.append("color", 4, GL_UNSIGNED_BYTE, GL_TRUE);
+    const size_t vertex_size = mesh.layout.get_vertex_size();
+    mesh.vertex_count = corners.size();
+    mesh.vertices.resize(vertex_size * corners.size());
+    const float *min = &mesh.bounds.min.x;
+    const float *max = &mesh.bounds.max.x;
+    for (size_t v = 0; v < corners.size(); v++) {
+        const float *position = &positions[corners[v].position * 3];
+        float color[3];
+        if ((size_t) corners[v].position * 3 + 2 < colors.size() && colors[corners[v].position * 3] >= 0.0f) {
+            memcpy(color, &colors[corners[v].position * 3], sizeof(color));
+        } else if (corners[v].normal >= 0) {
+            for (int c = 0; c < 3; c++) {
+                color[c] = fabsf(normals[corners[v].normal * 3 + c]);
+            }
+        } else {
+            for (int c = 0; c < 3; c++) {
+                color[c] = max[c] > min[c] ? (position[c] - min[c]) / (max[c] - min[c]) : 1.0f;
+            }
+        }
+
+        uint8_t *vertex = &mesh.vertices[v * vertex_size];
+        memcpy(vertex, position, sizeof(float) * 3);
+        uint8_t rgba[4] = {to_color_byte(color[0]), to_color_byte(color[1]), to_color_byte(color[2]), 255};
+        memcpy(vertex + sizeof(float) * 3, rgba, sizeof(rgba));
+    }
+    return mesh;
+}
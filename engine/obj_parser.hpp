@@ -0,0 +1,25 @@
+#ifndef OBJ_PARSER_HPP_
+#define OBJ_PARSER_HPP_
+
+#include <string>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "engine/frustum.hpp"
+#include "engine/vertex_layout.hpp"
+
+// Interleaved float xyz positions and normalized rgba bytes, the layout
+// the modules' shaders take.
+struct obj_mesh {
+    vertex_layout layout;
+    std::vector<uint8_t> vertices;
+    size_t vertex_count;
+    std::vector<uint32_t> indices;
+    bounding_box bounds;
+};
+
+obj_mesh parse_obj(const std::string &path);
+
+#endif // OBJ_PARSER_HPP_
@@ -0,0 +1,224 @@
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/gl_check.hpp"
+#include "engine/gl_functions.hpp"
+#include "engine/program_cache.hpp"
+
+const uint32_t program_cache_magic = 0x42504c47; // "GLPB"
+const uint32_t program_cache_version = 1;
+
+struct program_cache_header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t binary_format;
+    uint32_t binary_length;
+};
+
+uint64_t hash_fnv1a(uint64_t hash, const char *str) {
+    // The terminator is hashed too so that ("ab", "c") and ("a", "bc")
+    // give different keys.
+    do {
+        hash ^= (uint8_t) *str;
+        hash *= 1099511628211ull;
+    } while (*str++ != '\0');
+    return hash;
+}
+
+std::string get_gl_string(GLenum name) {
+    const char *str = (const char*) GL_CALL(glGetString(name));
+    return str ? str : "";
+}
+
+program_cache::program_cache()
+    : initialized(false), read_enabled(true), binary_supported(false), completion_status_supported(false), stats() {
+}
+
+// Deferred until the first program is built, since it needs a current
+// context.
+void program_cache::initialize() {
+    if (this->initialized) {
+        return;
+    }
+    this->initialized = true;
+
+    this->driver_identity = get_gl_string(GL_VENDOR) + "\n" + get_gl_string(GL_RENDERER) + "\n"
+        + get_gl_string(GL_VERSION);
+
+    GLint format_count = 0;
+    if (SDL_GL_ExtensionSupported("GL_OES_get_program_binary")) {
+        GL_CALL(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &format_count));
+    }
+
+    char *pref_path = SDL_GetPrefPath("opengl-es-test", "program-cache");
+    if (pref_path != NULL) {
+        this->directory = pref_path;
+        SDL_free(pref_path);
+    }
+
+    this->completion_status_supported = SDL_GL_ExtensionSupported("GL_KHR_parallel_shader_compile");
+
+    this->binary_supported = format_count > 0 && is_gl_function_loaded("glGetProgramBinaryOES")
+        && is_gl_function_loaded("glProgramBinaryOES") && !this->directory.empty();
+}
+
+std::string program_cache::get_path(uint64_t key) const {
+    std::ostringstream path;
+    path << this->directory << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+    return path.str();
+}
+
+// Cold runs still write binaries, so the next warm run finds them.
+void program_cache::set_read_enabled(bool enabled) {
+    this->read_enabled = enabled;
+}
+
+bool program_cache::is_read_enabled() const {
+    return this->read_enabled;
+}
+
+uint64_t program_cache::get_key(const char *vertex_source, const char *fragment_source) {
+    this->initialize();
+    uint64_t hash = 14695981039346656037ull;
+    hash = hash_fnv1a(hash, this->driver_identity.c_str());
+    hash = hash_fnv1a(hash, vertex_source);
+    return hash_fnv1a(hash, fragment_source);
+}
+
+// A binary the driver rejects (after a driver update the identity usually
+// catches this, but not always) is treated as a miss and rebuilt.
+bool program_cache::load(uint64_t key, uint32_t program_id) {
+    this->initialize();
+    if (!this->binary_supported || !this->read_enabled) {
+        this->stats.binary_misses++;
+        return false;
+    }
+
+    std::ifstream file(this->get_path(key), std::ios::binary);
+    program_cache_header header;
+    if (!file.read((char*) &header, sizeof(header)) || header.magic != program_cache_magic
+            || header.version != program_cache_version || header.key != key) {
+        this->stats.binary_misses++;
+        return false;
+    }
+    std::vector<char> binary(header.binary_length);
+    if (!file.read(binary.data(), binary.size())) {
+        this->stats.binary_misses++;
+        return false;
+    }
+
+    // A binary from another driver build fails to link, or raises
+    // GL_INVALID_ENUM if its format is gone; both fall back to compiling.
+    glProgramBinaryOES(program_id, header.binary_format, binary.data(), binary.size());
+    clear_gl_errors();
+    GLint link_status = GL_FALSE;
+    GL_CALL(glGetProgramiv(program_id, GL_LINK_STATUS, &link_status));
+    if (link_status == GL_FALSE) {
+        this->stats.binary_misses++;
+        return false;
+    }
+    this->stats.binary_hits++;
+    return true;
+}
+
+// Written to a temporary file and renamed, so a crash mid-write never
+// leaves a truncated binary behind for the next run.
+void program_cache::store(uint64_t key, uint32_t program_id) {
+    this->initialize();
+    if (!this->binary_supported) {
+        return;
+    }
+
+    GLint binary_length = 0;
+    GL_CALL(glGetProgramiv(program_id, GL_PROGRAM_BINARY_LENGTH_OES, &binary_length));
+    if (binary_length <= 0) {
+        return;
+    }
+    std::vector<char> binary(binary_length);
+    GLenum binary_format = 0;
+    GLsizei written = 0;
+    GL_CALL(glGetProgramBinaryOES(program_id, binary_length, &written, &binary_format, binary.data()));
+    if (written <= 0) {
+        return;
+    }
+
+    std::string path = this->get_path(key);
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        program_cache_header header = {program_cache_magic, program_cache_version, key, binary_format, (uint32_t) written};
+        file.write((const char*) &header, sizeof(header));
+        file.write(binary.data(), written);
+        if (!file) {
+            remove(temp_path.c_str());
+            return;
+        }
+    }
+    rename(temp_path.c_str(), path.c_str());
+}
+
+std::shared_ptr<shader> program_cache::get_shader(GLenum shader_type, const char *shader_source) {
+    auto key = std::make_pair(shader_type, std::string(shader_source));
+    auto cached = this->shaders.find(key);
+    if (cached != this->shaders.end()) {
+        this->stats.shaders_reused++;
+        return cached->second;
+    }
+    auto compiled = std::make_shared<shader>(shader_type, shader_source);
+    this->shaders.emplace(key, compiled);
+    this->stats.shaders_compiled++;
+    return compiled;
+}
+
+// Shader objects belong to the context, so they have to go before it does.
+void program_cache::release_shaders() {
+    this->shaders.clear();
+    this->initialized = false;
+}
+
+void program_cache::add_build_ticks(uint64_t ticks) {
+    this->stats.build_ticks += ticks;
+}
+
+// Whether programs can be polled with GL_COMPLETION_STATUS_KHR, known
+// once the first program from sources has been built. It outlives the
+// context, so reports can still ask.
+bool program_cache::has_completion_status() const {
+    return this->completion_status_supported;
+}
+
+// overlap_ticks is the time between submitting a program and first using
+// it, and wait_ticks how long the first status query still blocked. When
+// the program was still compiling at first use, all of the overlap was
+// compile time hidden behind other work; when it was already done, how
+// much of the overlap the compile took isn't known, so only the program is
+// counted.
+void program_cache::add_compile_wait(uint64_t overlap_ticks, uint64_t wait_ticks, bool still_compiling) {
+    this->stats.compile_wait_ticks += wait_ticks;
+    if (still_compiling) {
+        this->stats.compile_hidden_ticks += overlap_ticks;
+        this->stats.programs_compiling_at_use++;
+    } else if (this->completion_status_supported) {
+        this->stats.programs_ready_before_use++;
+    }
+}
+
+const program_cache_stats &program_cache::get_stats() const {
+    return this->stats;
+}
+
+program_cache &get_program_cache() {
+    static program_cache cache;
+    return cache;
+}
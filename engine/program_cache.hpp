@@ -0,0 +1,64 @@
+#ifndef PROGRAM_CACHE_HPP_
+#define PROGRAM_CACHE_HPP_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <stdint.h>
+
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/shader.hpp"
+
+struct program_cache_stats {
+    int binary_hits;
+    int binary_misses;
+    int shaders_compiled;
+    int shaders_reused;
+    uint64_t build_ticks;
+    // Only known with GL_KHR_parallel_shader_compile: the time between
+    // submitting and first using programs that were still compiling then.
+    uint64_t compile_hidden_ticks;
+    uint64_t compile_wait_ticks;
+    int programs_compiling_at_use;
+    int programs_ready_before_use;
+};
+
+// Keeps linked program binaries on disk between runs, keyed by the shader
+// sources and the driver that built them, and shares compiled shader
+// objects between programs within a run. Without GL_OES_get_program_binary
+// (or any binary formats) programs are always built from source.
+class program_cache {
+protected:
+    bool initialized;
+    bool read_enabled;
+    bool binary_supported;
+    bool completion_status_supported;
+    std::string directory;
+    std::string driver_identity;
+    std::map<std::pair<GLenum, std::string>, std::shared_ptr<shader>> shaders;
+    program_cache_stats stats;
+    void initialize();
+    std::string get_path(uint64_t key) const;
+public:
+    program_cache();
+    program_cache(program_cache const &) = delete;
+    void operator=(program_cache const &) = delete;
+    void set_read_enabled(bool enabled);
+    bool is_read_enabled() const;
+    uint64_t get_key(const char *vertex_source, const char *fragment_source);
+    bool load(uint64_t key, uint32_t program_id);
+    void store(uint64_t key, uint32_t program_id);
+    std::shared_ptr<shader> get_shader(GLenum shader_type, const char *shader_source);
+    void release_shaders();
+    void add_build_ticks(uint64_t ticks);
+    bool has_completion_status() const;
+    void add_compile_wait(uint64_t overlap_ticks, uint64_t wait_ticks, bool still_compiling);
+    const program_cache_stats &get_stats() const;
+};
+
+program_cache &get_program_cache();
+
+#endif // PROGRAM_CACHE_HPP_
@@ -0,0 +1,240 @@
+#include <stdexcept>
+#include <vector>
+
+#include <math.h>
+#include <string.h>
+
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/frame_stats.hpp"
+#include "engine/gl_check.hpp"
+#include "engine/gl_functions.hpp"
+#include "engine/gl_state.hpp"
+#include "engine/job_system.hpp"
+#include "engine/render_commands.hpp"
+
+const int sort_radix_bits = 8;
+const int sort_radix_size = 1 << sort_radix_bits;
+
+// Copied out because the packed value has no alignment to speak of.
+template <typename T>
+void upload_command_uniform(GLint location, const uint8_t *value) {
+    T typed;
+    memcpy(&typed, value, sizeof(T));
+    upload_uniform(location, typed);
+}
+
+size_t get_uniform_size(uniform_kind kind) {
+    switch (kind) {
+        case uniform_kind::int1:
+            return sizeof(GLint);
+        case uniform_kind::float1:
+            return sizeof(float);
+        case uniform_kind::float2:
+            return sizeof(vec2);
+        case uniform_kind::float3:
+            return sizeof(vec3);
+        case uniform_kind::float4:
+            return sizeof(vec4);
+        case uniform_kind::matrix4:
+            return sizeof(mat4);
+    }
+    return 0;
+}
+
+uint64_t make_sort_key(uint32_t program_id, uint32_t buffer_id, float depth) {
+    const uint32_t depth_max = (1 << 24) - 1;
+    float clamped = fminf(fmaxf(depth, 0.0f), 1.0f);
+    uint64_t depth_bits = (uint64_t) (clamped * depth_max);
+    return ((uint64_t) (program_id & 0xffff) << 48) | ((uint64_t) (buffer_id & 0xffff) << 32) | (depth_bits << 8);
+}
+
+render_bucket::render_bucket(uint32_t index) : index(index) {
+}
+
+render_command &render_bucket::append(render_command_type type) {
+    if (this->entries.empty()) {
+        throw std::runtime_error("render commands recorded before render_bucket::begin");
+    }
+    this->commands.emplace_back();
+    this->entries.back().count++;
+    render_command &command = this->commands.back();
+    command.type = type;
+    return command;
+}
+
+void render_bucket::begin(uint64_t key) {
+    this->entries.push_back({key, this->index, (uint32_t) this->commands.size(), 0});
+}
+
+void render_bucket::use_program(const shader_program &program) {
+    this->append(render_command_type::use_program).use_program.program = &program;
+}
+
+void render_bucket::bind_buffer(GLenum target, uint32_t buffer_id) {
+    render_command &command = this->append(render_command_type::bind_buffer);
+    command.bind_buffer.target = target;
+    command.bind_buffer.buffer_id = buffer_id;
+}
+
+void render_bucket::vertex_attrib(uint32_t index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, size_t offset) {
+    render_command &command = this->append(render_command_type::vertex_attrib);
+    command.vertex_attrib.index = (uint8_t) index;
+    command.vertex_attrib.size = (uint8_t) size;
+    command.vertex_attrib.type = type;
+    command.vertex_attrib.normalized = normalized;
+    command.vertex_attrib.stride = stride;
+    command.vertex_attrib.offset = (uint32_t) offset;
+}
+
+void render_bucket::draw_arrays(GLenum mode, GLint first, GLsizei count) {
+    render_command &command = this->append(render_command_type::draw_arrays);
+    command.draw_arrays.mode = mode;
+    command.draw_arrays.first = first;
+    command.draw_arrays.count = count;
+}
+
+void render_bucket::draw_elements(GLenum mode, GLsizei count, GLenum index_type, size_t offset) {
+    render_command &command = this->append(render_command_type::draw_elements);
+    command.draw_elements.mode = mode;
+    command.draw_elements.count = count;
+    command.draw_elements.index_type = index_type;
+    command.draw_elements.offset = (uint32_t) offset;
+}
+
+void render_bucket::clear() {
+    this->commands.clear();
+    this->entries.clear();
+    this->uniform_data.clear();
+}
+
+render_queue::render_queue(int bucket_count) {
+    for (int i = 0; i < bucket_count; i++) {
+        this->buckets.emplace_back(new render_bucket(i));
+    }
+}
+
+render_bucket &render_queue::get_bucket(int index) {
+    return *this->buckets[index];
+}
+
+// The calling job worker's bucket, so jobs can record without locking.
+render_bucket &render_queue::get_current_bucket() {
+    return *this->buckets[get_current_worker() % this->buckets.size()];
+}
+
+int render_queue::get_bucket_count() const {
+    return this->buckets.size();
+}
+
+// Least significant digit first, which keeps runs with equal keys in
+// recording order. Digits where every key agrees are skipped, so the
+// usual handful of programs and buffers costs few passes.
+void render_queue::sort() {
+    uint64_t differing = 0;
+    for (const auto &entry : this->entries) {
+        differing |= entry.key ^ this->entries.front().key;
+    }
+
+    this->scratch.resize(this->entries.size());
+    for (int shift = 0; shift < 64; shift += sort_radix_bits) {
+        if (((differing >> shift) & (sort_radix_size - 1)) == 0) {
+            continue;
+        }
+        size_t offsets[sort_radix_size] = {};
+        for (const auto &entry : this->entries) {
+            offsets[(entry.key >> shift) & (sort_radix_size - 1)]++;
+        }
+        size_t total = 0;
+        for (auto &offset : offsets) {
+            size_t count = offset;
+            offset = total;
+            total += count;
+        }
+        for (const auto &entry : this->entries) {
+            this->scratch[offsets[(entry.key >> shift) & (sort_radix_size - 1)]++] = entry;
+        }
+        this->entries.swap(this->scratch);
+    }
+}
+
+void render_queue::replay(const render_command &command, const uint8_t *uniform_data) {
+    gl_state &state = get_gl_state();
+    switch (command.type) {
+        case render_command_type::use_program:
+            command.use_program.program->use();
+            break;
+        case render_command_type::bind_buffer:
+            state.bind_buffer(command.bind_buffer.target, command.bind_buffer.buffer_id);
+            break;
+        case render_command_type::vertex_attrib: {
+            const vertex_attrib_command &attrib = command.vertex_attrib;
+            state.enable_vertex_attrib(attrib.index);
+            state.vertex_attrib_pointer(attrib.index, attrib.size, attrib.type, attrib.normalized, attrib.stride, (GLvoid*) (size_t) attrib.offset);
+            break;
+        }
+        case render_command_type::set_uniform: {
+            const set_uniform_command &set = command.set_uniform;
+            const uint8_t *value = uniform_data + set.value_offset;
+            GLint location = set.program->update_uniform(set.slot, value, get_uniform_size(set.kind));
+            if (location < 0) {
+                break;
+            }
+            switch (set.kind) {
+                case uniform_kind::int1:
+                    upload_command_uniform<GLint>(location, value);
+                    break;
+                case uniform_kind::float1:
+                    upload_command_uniform<float>(location, value);
+                    break;
+                case uniform_kind::float2:
+                    upload_command_uniform<vec2>(location, value);
+                    break;
+                case uniform_kind::float3:
+                    upload_command_uniform<vec3>(location, value);
+                    break;
+                case uniform_kind::float4:
+                    upload_command_uniform<vec4>(location, value);
+                    break;
+                case uniform_kind::matrix4:
+                    upload_command_uniform<mat4>(location, value);
+                    break;
+            }
+            break;
+        }
+        case render_command_type::draw_arrays:
+            GL_CALL(glDrawArrays(command.draw_arrays.mode, command.draw_arrays.first, command.draw_arrays.count));
+            get_frame_stats().count(frame_counter::draw_calls);
+            break;
+        case render_command_type::draw_elements:
+            GL_CALL(glDrawElements(
+                    command.draw_elements.mode,
+                    command.draw_elements.count,
+                    command.draw_elements.index_type,
+                    (GLvoid*) (size_t) command.draw_elements.offset));
+            get_frame_stats().count(frame_counter::draw_calls);
+            break;
+    }
+}
+
+// Has to run on the GL thread, after every job recording into the buckets
+// has finished. Leaves the buckets empty for the next frame.
+void render_queue::submit() {
+    this->entries.clear();
+    for (const auto &bucket : this->buckets) {
+        this->entries.insert(this->entries.end(), bucket->entries.begin(), bucket->entries.end());
+    }
+    this->sort();
+
+    for (const auto &entry : this->entries) {
+        const render_bucket &bucket = *this->buckets[entry.bucket];
+        const render_command *commands = bucket.commands.data();
+        for (uint32_t i = entry.first; i < entry.first + entry.count; i++) {
+            this->replay(commands[i], bucket.uniform_data.data());
+        }
+    }
+
+    for (const auto &bucket : this->buckets) {
+        bucket->clear();
+    }
+}
@@ -0,0 +1,172 @@
+#ifndef RENDER_COMMANDS_HPP_
+#define RENDER_COMMANDS_HPP_
+
+#include <memory>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/math.hpp"
+#include "engine/shader_program.hpp"
+#include "engine/uniform.hpp"
+
+enum class render_command_type : uint8_t {
+    use_program,
+    bind_buffer,
+    vertex_attrib,
+    set_uniform,
+    draw_arrays,
+    draw_elements,
+};
+
+enum class uniform_kind : uint8_t {
+    int1,
+    float1,
+    float2,
+    float3,
+    float4,
+    matrix4,
+};
+
+struct use_program_command {
+    const shader_program *program;
+};
+
+struct bind_buffer_command {
+    GLenum target;
+    uint32_t buffer_id;
+};
+
+// Buffer offsets are stored in 32 bits, which any ES 2.0 buffer fits, to
+// keep packets small.
+struct vertex_attrib_command {
+    uint32_t offset;
+    GLsizei stride;
+    GLenum type;
+    uint8_t index;
+    uint8_t size;
+    GLboolean normalized;
+};
+
+// The value lives out of line in the recording bucket's uniform data, so a
+// matrix doesn't make every packet as large as itself.
+struct set_uniform_command {
+    const shader_program *program;
+    int slot;
+    uniform_kind kind;
+    uint32_t value_offset;
+};
+
+struct draw_arrays_command {
+    GLenum mode;
+    GLint first;
+    GLsizei count;
+};
+
+struct draw_elements_command {
+    GLenum mode;
+    GLsizei count;
+    GLenum index_type;
+    uint32_t offset;
+};
+
+// Plain data, so recording never touches GL and buckets can be filled on
+// any thread.
+struct render_command {
+    render_command_type type;
+    union {
+        use_program_command use_program;
+        bind_buffer_command bind_buffer;
+        vertex_attrib_command vertex_attrib;
+        set_uniform_command set_uniform;
+        draw_arrays_command draw_arrays;
+        draw_elements_command draw_elements;
+    };
+};
+
+static_assert(sizeof(render_command) <= 32, "render commands should stay compact for sorting and replay");
+
+// A run of commands (normally ending in one draw) that is sorted and
+// replayed as a unit.
+struct render_sort_entry {
+    uint64_t key;
+    uint32_t bucket;
+    uint32_t first;
+    uint32_t count;
+};
+
+// Program in the top 16 bits, vertex buffer in the next 16 and depth,
+// front to back, in the 24 below; the lowest byte is left for callers.
+// Sorting on it groups draws by the state that is most expensive to change.
+uint64_t make_sort_key(uint32_t program_id, uint32_t buffer_id, float depth);
+
+inline uniform_kind get_uniform_kind(const GLint &) { return uniform_kind::int1; }
+inline uniform_kind get_uniform_kind(const float &) { return uniform_kind::float1; }
+inline uniform_kind get_uniform_kind(const vec2 &) { return uniform_kind::float2; }
+inline uniform_kind get_uniform_kind(const vec3 &) { return uniform_kind::float3; }
+inline uniform_kind get_uniform_kind(const vec4 &) { return uniform_kind::float4; }
+inline uniform_kind get_uniform_kind(const mat4 &) { return uniform_kind::matrix4; }
+
+// Commands recorded by one thread. Only the owning thread may record into
+// a bucket; render_queue collects all of them on the GL thread.
+class render_bucket {
+protected:
+    std::vector<render_command> commands;
+    std::vector<render_sort_entry> entries;
+    std::vector<uint8_t> uniform_data;
+    uint32_t index;
+    render_command &append(render_command_type type);
+    friend class render_queue;
+public:
+    render_bucket(uint32_t index);
+    render_bucket(render_bucket const &) = delete;
+    void operator=(render_bucket const &) = delete;
+    void begin(uint64_t key);
+    void use_program(const shader_program &program);
+    void bind_buffer(GLenum target, uint32_t buffer_id);
+    void vertex_attrib(uint32_t index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, size_t offset);
+    void draw_arrays(GLenum mode, GLint first, GLsizei count);
+    void draw_elements(GLenum mode, GLsizei count, GLenum index_type, size_t offset);
+    void clear();
+
+    template <typename T>
+    void set_uniform(const uniform<T> &target, const T &value) {
+        static_assert(sizeof(T) <= sizeof(mat4), "uniform value too large for a command");
+        if (target.get_program() == NULL) {
+            return;
+        }
+        render_command &command = this->append(render_command_type::set_uniform);
+        command.set_uniform.program = target.get_program();
+        command.set_uniform.slot = target.get_slot();
+        command.set_uniform.kind = get_uniform_kind(value);
+        command.set_uniform.value_offset = this->uniform_data.size();
+        const uint8_t *bytes = (const uint8_t*) &value;
+        this->uniform_data.insert(this->uniform_data.end(), bytes, bytes + sizeof(T));
+    }
+};
+
+// One bucket per job worker. submit() radix-sorts every recorded run by
+// key and replays them through gl_state, so consecutive runs that share a
+// program or buffer don't rebind it.
+class render_queue {
+protected:
+    std::vector<std::unique_ptr<render_bucket>> buckets;
+    std::vector<render_sort_entry> entries;
+    std::vector<render_sort_entry> scratch;
+    void sort();
+    void replay(const render_command &command, const uint8_t *uniform_data);
+public:
+    render_queue(int bucket_count);
+    render_queue(render_queue const &) = delete;
+    void operator=(render_queue const &) = delete;
+    render_bucket &get_bucket(int index);
+    render_bucket &get_current_bucket();
+    int get_bucket_count() const;
+    void submit();
+};
+
+#endif // RENDER_COMMANDS_HPP_
@@ -1,15 +1,130 @@
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/frame_stats.hpp"
+#include "engine/job_system.hpp"
 #include "engine/scene.hpp"
 
-scene::scene(std::shared_ptr<std::list<std::shared_ptr<drawable>>> drawables, std::shared_ptr<shader_program> program)
-    : drawables(drawables), program(program) {
+const size_t record_grain = 256;
+
+scene::scene(std::shared_ptr<shader_program> program)
+    : program(program), batch_program(program), commands(get_job_system().get_worker_count()), batching(false), culling(false) {
 }
 
-void scene::draw() {
-    this->program->use();
+drawable_store &scene::get_drawables() {
+    return this->drawables;
+}
+
+void scene::set_batching(bool enabled) {
+    this->batching = enabled;
+}
+
+// Batched vertices already have their offsets baked in, so a variant of the
+// scene's program without the offset uniform saves the vertex shader the
+// add. Without one the scene's program is used with a zero offset.
+void scene::set_batch_program(std::shared_ptr<shader_program> program) {
+    this->batch_program = program;
+}
+
+// The frustum has to be in the space the drawables' offsets are in, e.g.
+// frustum_from_perspective() when the drawables are positioned in view
+// space, or frustum_from_matrix() with a view-projection matrix.
+void scene::set_frustum(const frustum &view_frustum) {
+    this->view_frustum = view_frustum;
+    this->culling = true;
+}
+
+void scene::disable_culling() {
+    this->culling = false;
+}
+
+// The store already keeps offsets and local sphere centres in packed
+// arrays, so the world-space centres are one streaming pass away and the
+// frustum test runs over several drawables at once.
+void scene::cull() {
+    size_t count = this->drawables.size();
+    this->visible_indices.clear();
+    if (!this->culling) {
+        for (size_t i = 0; i < count; i++) {
+            this->visible_indices.push_back(i);
+        }
+        get_frame_stats().count(frame_counter::drawables_visible, count);
+        return;
+    }
 
-    for (const auto &d : *this->drawables) {
-        d->draw();
+    this->bounds_x.resize(count);
+    this->bounds_y.resize(count);
+    this->bounds_z.resize(count);
+    this->visible.resize(count);
+
+    const float *offset_x = this->drawables.get_offset_x();
+    const float *offset_y = this->drawables.get_offset_y();
+    const float *offset_z = this->drawables.get_offset_z();
+    const float *center_x = this->drawables.get_center_x();
+    const float *center_y = this->drawables.get_center_y();
+    const float *center_z = this->drawables.get_center_z();
+    for (size_t i = 0; i < count; i++) {
+        this->bounds_x[i] = center_x[i] + offset_x[i];
+        this->bounds_y[i] = center_y[i] + offset_y[i];
+        this->bounds_z[i] = center_z[i] + offset_z[i];
     }
 
-    this->program->clear();
+    size_t visible_count = cull_spheres(
+            this->view_frustum,
+            this->bounds_x.data(),
+            this->bounds_y.data(),
+            this->bounds_z.data(),
+            this->drawables.get_radius(),
+            count,
+            this->visible.data());
+
+    for (size_t i = 0; i < count; i++) {
+        if (this->visible[i]) {
+            this->visible_indices.push_back(i);
+        }
+    }
+    get_frame_stats().count(frame_counter::drawables_visible, visible_count);
+    get_frame_stats().count(frame_counter::drawables_culled, count - visible_count);
+}
+
+void scene::draw() {
+    this->cull();
+
+    if (this->batching) {
+        this->batch_program->use();
+        if (this->batch_program == this->program) {
+            // Offsets are baked into the batched vertices on the CPU.
+            for (const auto &index : this->visible_indices) {
+                drawable *d = this->drawables.get_at(index);
+                if (d != NULL) {
+                    d->get_offset_uniform().set({0.0f, 0.0f, 0.0f});
+                    break;
+                }
+            }
+        }
+        this->batch.draw(this->drawables, this->visible_indices, *this->batch_program);
+    } else {
+        this->program->use();
+        // Recorded across the job workers and replayed here sorted by
+        // program and buffer. The offsets are in clip space for every scene
+        // so far, which makes z a usable depth for the sort key.
+        get_job_system().parallel_for(this->visible_indices.size(), record_grain, [this](size_t begin, size_t end) {
+            render_bucket &bucket = this->commands.get_current_bucket();
+            const uint32_t *buffer_ids = this->drawables.get_vertex_buffer_ids();
+            const uint32_t *attrib_sets = this->drawables.get_attrib_set_indices();
+            for (size_t i = begin; i < end; i++) {
+                size_t index = this->visible_indices[i];
+                const drawable *d = this->drawables.get_at(index);
+                if (d != NULL) {
+                    vec3 offset = this->drawables.get_offset_at(index);
+                    d->record(
+                            bucket,
+                            buffer_ids[index],
+                            this->drawables.get_attrib_set(attrib_sets[index]),
+                            offset,
+                            (offset.z + 1.0f) * 0.5f);
+                }
+            }
+        });
+        this->commands.submit();
+    }
 }
@@ -1,20 +1,42 @@
 #ifndef SCENE_HPP_
 #define SCENE_HPP_
 
-#include <list>
 #include <memory>
+#include <vector>
 
-#include "engine/drawable.hpp"
+#include <stdint.h>
+
+#include "engine/draw_batch.hpp"
+#include "engine/drawable_store.hpp"
+#include "engine/frustum.hpp"
+#include "engine/render_commands.hpp"
 #include "engine/shader_program.hpp"
 
 class scene {
 protected:
-    std::shared_ptr<std::list<std::shared_ptr<drawable>>> drawables;
+    drawable_store drawables;
     std::shared_ptr<shader_program> program;
+    std::shared_ptr<shader_program> batch_program;
+    draw_batch batch;
+    render_queue commands;
+    bool batching;
+    bool culling;
+    frustum view_frustum;
+    std::vector<float> bounds_x;
+    std::vector<float> bounds_y;
+    std::vector<float> bounds_z;
+    std::vector<uint8_t> visible;
+    std::vector<uint32_t> visible_indices;
+    void cull();
 public:
-    scene(std::shared_ptr<std::list<std::shared_ptr<drawable>>> drawables, std::shared_ptr<shader_program> program);
+    scene(std::shared_ptr<shader_program> program);
     scene(scene const &) = delete;
     void operator=(scene const &) = delete;
+    drawable_store &get_drawables();
+    void set_batching(bool enabled);
+    void set_batch_program(std::shared_ptr<shader_program> program);
+    void set_frustum(const frustum &view_frustum);
+    void disable_culling();
     void draw();
 };
 
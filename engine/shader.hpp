@@ -16,4 +16,6 @@ public:
     uint32_t get_shader_id() const;
 };
 
+void check_compile_status(uint32_t shader_id);
+
 #endif // SHADER_HPP_
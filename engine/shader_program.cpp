@@ -1,51 +1,246 @@
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
+#include <ctype.h>
+#include <string.h>
+
+#include <SDL2/SDL.h>
 #include <SDL2/SDL_opengles2.h>
 
+#include "engine/frame_stats.hpp"
+#include "engine/gl_check.hpp"
+#include "engine/gl_functions.hpp"
+#include "engine/gl_state.hpp"
+#include "engine/program_cache.hpp"
 #include "engine/shader_program.hpp"
 
-shader_program::shader_program(const std::list<shader> &shaders) {
-    this->program_id = glCreateProgram();
+shader_program::shader_program(const std::list<shader> &shaders)
+    : checked(false), store_binary(false), cache_key(0), submit_time(SDL_GetPerformanceCounter()) {
+    this->program_id = GL_CALL(glCreateProgram());
 
+    std::vector<uint32_t> shader_ids;
     for(const auto &shader : shaders) {
-        glAttachShader(this->program_id, shader.get_shader_id());
+        shader_ids.push_back(shader.get_shader_id());
     }
+    this->link(shader_ids);
+}
 
-    glLinkProgram(this->program_id);
+// Loads the linked binary from the program cache when there is one, and
+// otherwise builds from shader objects shared with other programs.
+shader_program::shader_program(const char *vertex_source, const char *fragment_source)
+    : checked(false), store_binary(false), cache_key(0), submit_time(SDL_GetPerformanceCounter()) {
+    program_cache &cache = get_program_cache();
+    this->cache_key = cache.get_key(vertex_source, fragment_source);
 
-    for(const auto &shader : shaders) {
-        glDetachShader(this->program_id, shader.get_shader_id());
+    this->program_id = GL_CALL(glCreateProgram());
+    if (cache.load(this->cache_key, this->program_id)) {
+        this->checked = true;
+    } else {
+        std::shared_ptr<shader> vertex_shader = cache.get_shader(GL_VERTEX_SHADER, vertex_source);
+        std::shared_ptr<shader> fragment_shader = cache.get_shader(GL_FRAGMENT_SHADER, fragment_source);
+        this->bind_attrib_locations(vertex_source);
+        this->link({vertex_shader->get_shader_id(), fragment_shader->get_shader_id()});
+        this->store_binary = true;
+    }
+    cache.add_build_ticks(SDL_GetPerformanceCounter() - this->submit_time);
+}
+
+// Gives every attribute the vertex source declares a location of its own
+// before linking, in order of declaration, so get_attrib_location() can
+// answer without waiting for the link. Declarations inside #ifdefs get a
+// location whether they are compiled in or not; binding a name the program
+// lacks is harmless. Cached binaries keep the locations they were linked
+// with, and the same source always binds the same ones.
+void shader_program::bind_attrib_locations(const char *vertex_source) {
+    const std::string keyword("attribute");
+    std::string source(vertex_source);
+    size_t position = 0;
+    while ((position = source.find(keyword, position)) != std::string::npos) {
+        bool starts_word = position == 0 || !(isalnum(source[position - 1]) || source[position - 1] == '_');
+        position += keyword.size();
+        size_t end = source.find(';', position);
+        if (!starts_word || end == std::string::npos || !isspace(source[position])) {
+            continue;
+        }
+        // The name is the last word before the semicolon, after any
+        // precision qualifier and the type.
+        size_t name_end = end;
+        while (name_end > position && isspace(source[name_end - 1])) {
+            name_end--;
+        }
+        size_t name_start = name_end;
+        while (name_start > position && (isalnum(source[name_start - 1]) || source[name_start - 1] == '_')) {
+            name_start--;
+        }
+        std::string name = source.substr(name_start, name_end - name_start);
+        if (!name.empty() && this->attrib_locations.find(name) == this->attrib_locations.end()) {
+            GLint location = this->attrib_locations.size();
+            GL_CALL(glBindAttribLocation(this->program_id, location, name.c_str()));
+            this->attrib_locations.emplace(name, location);
+        }
+        position = end;
     }
+}
+
+// The shaders stay attached until check(), so their info logs are still
+// available if the link fails, even when the caller has already deleted
+// them.
+void shader_program::link(const std::vector<uint32_t> &shader_ids) {
+    for (const auto &shader_id : shader_ids) {
+        GL_CALL(glAttachShader(this->program_id, shader_id));
+    }
+    GL_CALL(glLinkProgram(this->program_id));
+}
 
+// Called on first use. Whatever ran between submitting the program and
+// this point overlapped with the driver's compile and link; the status
+// query blocks only for what is left. A program that failed throws the
+// same error on every later use.
+void shader_program::check() const {
+    if (this->checked) {
+        return;
+    }
+    if (!this->link_error.empty()) {
+        throw std::runtime_error(this->link_error);
+    }
+
+    uint64_t start = SDL_GetPerformanceCounter();
+    bool still_compiling = !this->is_ready();
     int32_t program_status;
-    glGetProgramiv(this->program_id, GL_LINK_STATUS, &program_status);
+    GL_CALL(glGetProgramiv(this->program_id, GL_LINK_STATUS, &program_status));
+    get_program_cache().add_compile_wait(start - this->submit_time, SDL_GetPerformanceCounter() - start, still_compiling);
+
+    GLuint shader_ids[8];
+    GLsizei shader_count = 0;
+    GL_CALL(glGetAttachedShaders(this->program_id, 8, &shader_count, shader_ids));
+
     if (program_status == GL_FALSE) {
-        int32_t info_log_length;
-        glGetProgramiv(this->program_id, GL_INFO_LOG_LENGTH, &info_log_length);
-        std::vector<char> info_log(info_log_length + 1);
-        glGetProgramInfoLog(this->program_id, info_log_length, NULL, &info_log[0]);
-        throw std::runtime_error("glLinkProgram error: " + std::string(&info_log[0]));
+        try {
+            // A compile error explains a failed link better than the link
+            // log.
+            for (GLsizei i = 0; i < shader_count; i++) {
+                check_compile_status(shader_ids[i]);
+            }
+
+            int32_t info_log_length;
+            GL_CALL(glGetProgramiv(this->program_id, GL_INFO_LOG_LENGTH, &info_log_length));
+            std::vector<char> info_log(info_log_length + 1);
+            GL_CALL(glGetProgramInfoLog(this->program_id, info_log_length, NULL, &info_log[0]));
+            throw std::runtime_error("glLinkProgram error: " + std::string(&info_log[0]));
+        } catch (const std::runtime_error &e) {
+            this->link_error = e.what();
+            throw;
+        }
+    }
+
+    for (GLsizei i = 0; i < shader_count; i++) {
+        GL_CALL(glDetachShader(this->program_id, shader_ids[i]));
+    }
+    if (this->store_binary) {
+        get_program_cache().store(this->cache_key, this->program_id);
     }
+    this->checked = true;
 }
 
 shader_program::~shader_program() {
+    get_gl_state().forget_program(this->program_id);
     glDeleteProgram(this->program_id);
 }
 
-void shader_program::use() {
-    glUseProgram(this->program_id);
+// Polls GL_KHR_parallel_shader_compile's completion status, so callers can
+// do other work instead of blocking on a program that is still being built.
+// Without the extension there is no way to ask, and this is always true.
+bool shader_program::is_ready() const {
+    if (this->checked || !get_program_cache().has_completion_status()) {
+        return true;
+    }
+    GLint complete = GL_FALSE;
+    GL_CALL(glGetProgramiv(this->program_id, GL_COMPLETION_STATUS_KHR, &complete));
+    return complete == GL_TRUE;
+}
+
+void shader_program::use() const {
+    this->check();
+    get_gl_state().use_program(this->program_id);
+}
+
+void shader_program::clear() const {
+    get_gl_state().use_program(0);
 }
 
-void shader_program::clear() {
-    glUseProgram(0);
+uint32_t shader_program::get_program_id() const {
+    return this->program_id;
 }
 
+// Attributes bound before linking are answered without waiting for it.
 uint32_t shader_program::get_attrib_location(const char *attrib) const {
-    return glGetAttribLocation(this->program_id, attrib);
+    auto bound = this->attrib_locations.find(attrib);
+    if (bound != this->attrib_locations.end()) {
+        return bound->second;
+    }
+    this->check();
+    return GL_CALL(glGetAttribLocation(this->program_id, attrib));
 }
 
+// Locations don't change after linking, so the driver is asked once per name.
 uint32_t shader_program::get_uniform_location(const char *uniform) const {
-    return glGetUniformLocation(this->program_id, uniform);
+    auto cached = this->uniform_locations.find(uniform);
+    if (cached != this->uniform_locations.end()) {
+        return cached->second;
+    }
+    this->check();
+    GLint location = GL_CALL(glGetUniformLocation(this->program_id, uniform));
+    this->uniform_locations.emplace(uniform, location);
+    return location;
+}
+
+// Handles to the same uniform share a slot, so a value set through one
+// handle is seen by the others. The location is only looked up on the
+// first upload through the slot.
+int shader_program::get_uniform_slot(const char *uniform) const {
+    for (size_t slot = 0; slot < this->uniform_shadows.size(); slot++) {
+        if (this->uniform_shadows[slot].name == uniform) {
+            return slot;
+        }
+    }
+    uniform_shadow shadow;
+    shadow.name = uniform;
+    shadow.location = -1;
+    shadow.resolved = false;
+    shadow.valid = false;
+    this->uniform_shadows.push_back(shadow);
+    return this->uniform_shadows.size() - 1;
+}
+
+// Makes the program current and returns the location to upload to, or -1
+// when the slot already holds this value. Uniform state belongs to the
+// program, so the shadow stays valid across program switches; anything
+// that sets these uniforms without going through here leaves it stale.
+GLint shader_program::update_uniform(int slot, const void *value, size_t size) const {
+    if (slot < 0) {
+        return -1;
+    }
+    if (size > sizeof(uniform_shadow::value)) {
+        throw std::runtime_error("uniform value too large for its shadow copy");
+    }
+
+    uniform_shadow &shadow = this->uniform_shadows[slot];
+    if (!shadow.resolved) {
+        shadow.location = this->get_uniform_location(shadow.name.c_str());
+        shadow.resolved = true;
+    }
+    if (shadow.location < 0) {
+        return -1;
+    }
+    if (shadow.valid && memcmp(shadow.value, value, size) == 0) {
+        get_frame_stats().count(frame_counter::uniforms_elided);
+        return -1;
+    }
+    memcpy(shadow.value, value, size);
+    shadow.valid = true;
+    this->use();
+    get_frame_stats().count(frame_counter::uniforms_issued);
+    return shadow.location;
 }
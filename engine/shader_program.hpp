@@ -2,23 +2,56 @@
 #define SHADER_PROGRAM_HPP_
 
 #include <list>
+#include <map>
+#include <string>
+#include <vector>
 
 #include <stdint.h>
 
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/math.hpp"
 #include "engine/shader.hpp"
 
+// Last value uploaded to one uniform, shared by every handle that refers
+// to it. The location is looked up on the first upload, so creating handles
+// doesn't wait for the program to link.
+struct uniform_shadow {
+    std::string name;
+    GLint location;
+    bool resolved;
+    bool valid;
+    uint8_t value[sizeof(mat4)];
+};
+
 class shader_program {
 protected:
     uint32_t program_id;
+    mutable bool checked;
+    mutable std::string link_error;
+    bool store_binary;
+    uint64_t cache_key;
+    uint64_t submit_time;
+    std::map<std::string, GLint> attrib_locations;
+    mutable std::map<std::string, GLint> uniform_locations;
+    mutable std::vector<uniform_shadow> uniform_shadows;
+    void bind_attrib_locations(const char *vertex_source);
+    void link(const std::vector<uint32_t> &shader_ids);
+    void check() const;
 public:
     shader_program(const std::list<shader> &shaders);
+    shader_program(const char *vertex_source, const char *fragment_source);
     shader_program(shader_program const &) = delete;
     ~shader_program();
     void operator=(shader_program const &) = delete;
-    void use();
-    void clear();
+    bool is_ready() const;
+    void use() const;
+    void clear() const;
+    uint32_t get_program_id() const;
     uint32_t get_attrib_location(const char *attrib) const;
     uint32_t get_uniform_location(const char *uniform) const;
+    int get_uniform_slot(const char *uniform) const;
+    GLint update_uniform(int slot, const void *value, size_t size) const;
 };
 
 
@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <string.h>
+
+#include "engine/shader_program.hpp"
+#include "engine/shader_variants.hpp"
+
+const char *feature_pragma = "#pragma feature";
+const size_t max_shader_features = 32;
+
+shader_variants::shader_variants(const char *vertex_source, const char *fragment_source)
+    : vertex(this->parse(vertex_source)), fragment(this->parse(fragment_source)) {
+}
+
+// Splits off everything up to the #version line, which has to stay first,
+// and removes the feature declarations from the body.
+shader_variants::stage_source shader_variants::parse(const char *source) {
+    stage_source stage;
+    std::istringstream lines(source);
+    std::string line;
+    bool versioned = std::string(source).find("#version") != std::string::npos;
+    bool in_header = versioned;
+    while (std::getline(lines, line)) {
+        size_t start = line.find_first_not_of(" \t");
+        std::string trimmed = start == std::string::npos ? "" : line.substr(start);
+        if (trimmed.compare(0, strlen(feature_pragma), feature_pragma) == 0) {
+            std::istringstream words(trimmed.substr(strlen(feature_pragma)));
+            std::string name;
+            if (!(words >> name)) {
+                throw std::runtime_error("\"" + trimmed + "\" doesn't name a feature");
+            }
+            auto known = std::find(this->feature_names.begin(), this->feature_names.end(), name);
+            if (known == this->feature_names.end()) {
+                if (this->feature_names.size() == max_shader_features) {
+                    throw std::runtime_error("shaders can't declare more than 32 features");
+                }
+                known = this->feature_names.insert(this->feature_names.end(), name);
+            }
+            stage.features.push_back(known - this->feature_names.begin());
+            continue;
+        }
+        (in_header ? stage.header : stage.body) += line + "\n";
+        if (trimmed.compare(0, 8, "#version") == 0) {
+            in_header = false;
+        }
+    }
+    return stage;
+}
+
+std::string shader_variants::specialise(const stage_source &stage, uint32_t features) const {
+    std::string source = stage.header;
+    for (int feature : stage.features) {
+        if (features & (1u << feature)) {
+            source += "#define " + this->feature_names[feature] + " 1\n";
+        }
+    }
+    return source + stage.body;
+}
+
+// Throws for names the sources don't declare, so a typo doesn't silently
+// select the plain variant.
+uint32_t shader_variants::get_feature(const std::string &name) const {
+    auto known = std::find(this->feature_names.begin(), this->feature_names.end(), name);
+    if (known == this->feature_names.end()) {
+        throw std::runtime_error("shader has no feature \"" + name + "\"");
+    }
+    return 1u << (known - this->feature_names.begin());
+}
+
+const std::vector<std::string> &shader_variants::get_feature_names() const {
+    return this->feature_names;
+}
+
+std::shared_ptr<shader_program> shader_variants::get(uint32_t features) {
+    auto cached = this->programs.find(features);
+    if (cached != this->programs.end()) {
+        return cached->second;
+    }
+    if (this->feature_names.size() < max_shader_features && (features >> this->feature_names.size()) != 0) {
+        throw std::runtime_error("shader variant requested with undeclared feature bits");
+    }
+    auto program = std::make_shared<shader_program>(
+            this->specialise(this->vertex, features).c_str(),
+            this->specialise(this->fragment, features).c_str());
+    this->programs.emplace(features, program);
+    return program;
+}
+
+size_t shader_variants::get_variant_count() const {
+    return this->programs.size();
+}
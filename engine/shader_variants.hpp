@@ -0,0 +1,44 @@
+#ifndef SHADER_VARIANTS_HPP_
+#define SHADER_VARIANTS_HPP_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include "engine/shader_program.hpp"
+
+// A vertex and fragment source pair whose optional features are declared
+// with "#pragma feature NAME" lines and guarded with "#ifdef NAME". get()
+// builds the program for a set of features on first request by defining
+// exactly those names, so a variant carries no uniforms, math or branches
+// for the features it leaves out. Feature bits follow declaration order,
+// vertex source first; a feature only defines its name in the stages that
+// declare it, so variants differing in vertex-only features share the
+// compiled fragment shader.
+class shader_variants {
+protected:
+    struct stage_source {
+        std::string header;
+        std::string body;
+        std::vector<int> features;
+    };
+    std::vector<std::string> feature_names;
+    stage_source vertex;
+    stage_source fragment;
+    std::map<uint32_t, std::shared_ptr<shader_program>> programs;
+    stage_source parse(const char *source);
+    std::string specialise(const stage_source &stage, uint32_t features) const;
+public:
+    shader_variants(const char *vertex_source, const char *fragment_source);
+    shader_variants(shader_variants const &) = delete;
+    void operator=(shader_variants const &) = delete;
+    uint32_t get_feature(const std::string &name) const;
+    const std::vector<std::string> &get_feature_names() const;
+    std::shared_ptr<shader_program> get(uint32_t features);
+    size_t get_variant_count() const;
+};
+
+#endif // SHADER_VARIANTS_HPP_
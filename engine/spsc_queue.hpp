@@ -0,0 +1,79 @@
+#ifndef SPSC_QUEUE_HPP_
+#define SPSC_QUEUE_HPP_
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include <stddef.h>
+
+const size_t spsc_cache_line = 64;
+
+// A bounded lock-free ring for exactly one producer thread and one
+// consumer thread. Each side owns one index and only reads the other's,
+// and the indices sit on separate cache lines so the two threads don't
+// keep stealing the same line from each other.
+template <typename T>
+class spsc_queue {
+protected:
+    std::vector<T> slots;
+    size_t mask;
+    std::atomic<size_t> head;
+    char head_padding[spsc_cache_line - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> tail;
+    char tail_padding[spsc_cache_line - sizeof(std::atomic<size_t>)];
+public:
+    // The capacity is rounded up to a power of two.
+    spsc_queue(size_t capacity) : head(0), tail(0) {
+        size_t size = 1;
+        while (size < capacity) {
+            size *= 2;
+        }
+        this->slots.resize(size);
+        this->mask = size - 1;
+    }
+
+    spsc_queue(spsc_queue const &) = delete;
+    void operator=(spsc_queue const &) = delete;
+
+    // Producer only; leaves value untouched when the queue is full.
+    bool try_push(T &value) {
+        size_t tail = this->tail.load(std::memory_order_relaxed);
+        if (tail - this->head.load(std::memory_order_acquire) == this->slots.size()) {
+            return false;
+        }
+        this->slots[tail & this->mask] = std::move(value);
+        this->tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only; the oldest element, or NULL when the queue is empty.
+    // It stays valid until the next pop.
+    T *front() {
+        size_t head = this->head.load(std::memory_order_relaxed);
+        if (head == this->tail.load(std::memory_order_acquire)) {
+            return NULL;
+        }
+        return &this->slots[head & this->mask];
+    }
+
+    // Consumer only.
+    bool try_pop(T &value) {
+        T *element = this->front();
+        if (element == NULL) {
+            return false;
+        }
+        value = std::move(*element);
+        *element = T();
+        this->head.store(this->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Exact from either end's own thread, a hint from anywhere else.
+    size_t size() const {
+        size_t head = this->head.load(std::memory_order_acquire);
+        return this->tail.load(std::memory_order_acquire) - head;
+    }
+};
+
+#endif // SPSC_QUEUE_HPP_
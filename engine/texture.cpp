@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/frame_stats.hpp"
+#include "engine/gl_check.hpp"
+#include "engine/gl_functions.hpp"
+#include "engine/gl_state.hpp"
+#include "engine/image.hpp"
+#include "engine/texture.hpp"
+
+size_t texture_memory = 0;
+
+bool is_power_of_two(int value) {
+    return value > 0 && (value & (value - 1)) == 0;
+}
+
+// Software rasterizers build mips through their generic blit path, one
+// level at a time, which is slower than filtering on the CPU ourselves.
+bool has_slow_generate_mipmap() {
+    const char *renderer = (const char*) GL_CALL(glGetString(GL_RENDERER));
+    if (renderer == NULL) {
+        return false;
+    }
+    std::string name(renderer);
+    for (const char *software : {"llvmpipe", "softpipe", "swrast", "SwiftShader"}) {
+        if (name.find(software) != std::string::npos) {
+            return true;
+        }
+    }
+    return false;
+}
+
+texture::texture(const image &source, mipmap_mode mipmaps)
+    : width(source.width), height(source.height), level_count(1), memory_bytes(source.pixels.size()) {
+    const uint64_t start = SDL_GetPerformanceCounter();
+    const GLenum format = get_image_format(source.channels);
+    if (!is_power_of_two(this->width) || !is_power_of_two(this->height)) {
+        mipmaps = mipmap_mode::none;
+    } else if (mipmaps == mipmap_mode::automatic) {
+        mipmaps = has_slow_generate_mipmap() ? mipmap_mode::cpu : mipmap_mode::driver;
+    }
+
+    this->create();
+    // Rows of one- and three-channel images aren't padded to four bytes.
+    GL_CALL(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+    GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0, format, this->width, this->height, 0, format, GL_UNSIGNED_BYTE, source.pixels.data()));
+    if (mipmaps == mipmap_mode::cpu) {
+        image level;
+        const image *previous = &source;
+        while (previous->width > 1 || previous->height > 1) {
+            level = downsample(*previous);
+            GL_CALL(glTexImage2D(GL_TEXTURE_2D, this->level_count, format, level.width, level.height, 0, format, GL_UNSIGNED_BYTE,
+                    level.pixels.data()));
+            this->level_count++;
+            this->memory_bytes += level.pixels.size();
+            previous = &level;
+        }
+    } else if (mipmaps == mipmap_mode::driver) {
+        GL_CALL(glGenerateMipmap(GL_TEXTURE_2D));
+        for (int w = this->width, h = this->height; w > 1 || h > 1; ) {
+            w = std::max(1, w / 2);
+            h = std::max(1, h / 2);
+            this->level_count++;
+            this->memory_bytes += (size_t) w * h * source.channels;
+        }
+    }
+    GL_CALL(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+
+    GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, this->level_count > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
+    this->finish(start);
+}
+
+// ETC1 has no alpha and can't be mipmapped by the driver, so only the
+// levels in the source are uploaded.
+texture::texture(const compressed_image &source)
+    : width(source.width), height(source.height), level_count(source.levels.size()), memory_bytes(0) {
+    const uint64_t start = SDL_GetPerformanceCounter();
+    if (source.format == GL_ETC1_RGB8_OES && !SDL_GL_ExtensionSupported("GL_OES_compressed_ETC1_RGB8_texture")) {
+        throw std::runtime_error("ETC1 textures need GL_OES_compressed_ETC1_RGB8_texture");
+    }
+    if (source.levels.empty()) {
+        throw std::runtime_error("compressed images need at least one level");
+    }
+
+    this->create();
+    for (int level = 0; level < this->level_count; level++) {
+        const std::vector<uint8_t> &data = source.levels[level];
+        GL_CALL(glCompressedTexImage2D(GL_TEXTURE_2D, level, source.format,
+                std::max(1, this->width >> level), std::max(1, this->height >> level), 0, data.size(), data.data()));
+        this->memory_bytes += data.size();
+    }
+
+    GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, this->level_count > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
+    this->finish(start);
+}
+
+texture::~texture() {
+    get_gl_state().forget_texture(this->texture_id);
+    glDeleteTextures(1, &this->texture_id);
+    texture_memory -= this->memory_bytes;
+}
+
+void texture::create() {
+    GL_CALL(glGenTextures(1, &this->texture_id));
+    this->bind();
+    GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+    GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+    GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+}
+
+// The upload time is what the calls cost this thread, including CPU mip
+// generation; drivers may still be copying afterwards.
+void texture::finish(uint64_t start_ticks) {
+    texture_memory += this->memory_bytes;
+    get_frame_stats().count(frame_counter::upload_bytes, this->memory_bytes);
+    this->upload_ms = (SDL_GetPerformanceCounter() - start_ticks) * 1000.0 / SDL_GetPerformanceFrequency();
+}
+
+void texture::bind(uint32_t unit) {
+    get_gl_state().bind_texture(unit, this->texture_id);
+}
+
+uint32_t texture::get_texture_id() const {
+    return this->texture_id;
+}
+
+int texture::get_width() const {
+    return this->width;
+}
+
+int texture::get_height() const {
+    return this->height;
+}
+
+int texture::get_level_count() const {
+    return this->level_count;
+}
+
+size_t texture::get_memory_bytes() const {
+    return this->memory_bytes;
+}
+
+double texture::get_upload_ms() const {
+    return this->upload_ms;
+}
+
+mipmap_mode parse_mipmap_mode(const std::string &name) {
+    if (name == "off") {
+        return mipmap_mode::none;
+    } else if (name == "auto") {
+        return mipmap_mode::automatic;
+    } else if (name == "cpu") {
+        return mipmap_mode::cpu;
+    } else if (name == "driver") {
+        return mipmap_mode::driver;
+    }
+    throw std::runtime_error("invalid mipmap mode \"" + name + "\"");
+}
+
+// Every live texture's levels as uploaded, not what the driver allocates.
+size_t get_texture_memory() {
+    return texture_memory;
+}
@@ -0,0 +1,54 @@
+#ifndef TEXTURE_HPP_
+#define TEXTURE_HPP_
+
+#include <string>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/image.hpp"
+
+enum class mipmap_mode {
+    none,
+    // The CPU filter where glGenerateMipmap is known to be slow, the
+    // driver's everywhere else.
+    automatic,
+    // downsample() on the CPU, uploading every level.
+    cpu,
+    // glGenerateMipmap.
+    driver,
+};
+
+// A 2D texture, bound through gl_state. ES 2.0 only mipmaps power-of-two
+// textures, so others are created without mips whatever the mode.
+class texture {
+protected:
+    uint32_t texture_id;
+    int width;
+    int height;
+    int level_count;
+    size_t memory_bytes;
+    double upload_ms;
+    void create();
+    void finish(uint64_t start_ticks);
+public:
+    texture(const image &source, mipmap_mode mipmaps = mipmap_mode::automatic);
+    texture(const compressed_image &source);
+    texture(texture const &) = delete;
+    ~texture();
+    void operator=(texture const &) = delete;
+    void bind(uint32_t unit = 0);
+    uint32_t get_texture_id() const;
+    int get_width() const;
+    int get_height() const;
+    int get_level_count() const;
+    size_t get_memory_bytes() const;
+    double get_upload_ms() const;
+};
+
+mipmap_mode parse_mipmap_mode(const std::string &name);
+size_t get_texture_memory();
+
+#endif // TEXTURE_HPP_
@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <string.h>
+
+#include "engine/image.hpp"
+#include "engine/texture.hpp"
+#include "engine/texture_atlas.hpp"
+
+texture_atlas::texture_atlas(int page_size, int padding, mipmap_mode mipmaps)
+    : page_size(page_size), padding(padding), mipmaps(mipmaps) {
+}
+
+// The lowest spot whose left edge starts a skyline segment, preferring
+// the narrowest segment on ties to keep wide gaps for wide images.
+bool texture_atlas::find_position(const atlas_page &page, int width, int height, size_t &segment, int &y) const {
+    int best_y = std::numeric_limits<int>::max();
+    int best_width = std::numeric_limits<int>::max();
+    const std::vector<skyline_segment> &skyline = page.skyline;
+    for (size_t i = 0; i < skyline.size(); i++) {
+        if (skyline[i].x + width > this->page_size) {
+            break;
+        }
+        int top = 0;
+        int remaining = width;
+        for (size_t j = i; remaining > 0; j++) {
+            top = std::max(top, skyline[j].y);
+            remaining -= skyline[j].width;
+        }
+        if (top + height <= this->page_size
+                && (top < best_y || (top == best_y && skyline[i].width < best_width))) {
+            best_y = top;
+            best_width = skyline[i].width;
+            segment = i;
+        }
+    }
+    y = best_y;
+    return best_y != std::numeric_limits<int>::max();
+}
+
+// Raises the skyline under the new rectangle, trims the segments it now
+// covers and merges neighbours left at the same height.
+void texture_atlas::place(atlas_page &page, size_t segment, int y, int width, int height) {
+    std::vector<skyline_segment> &skyline = page.skyline;
+    const int x = skyline[segment].x;
+    skyline.insert(skyline.begin() + segment, {x, y + height, width});
+
+    size_t next = segment + 1;
+    while (next < skyline.size() && skyline[next].x < x + width) {
+        int overlap = x + width - skyline[next].x;
+        if (skyline[next].width <= overlap) {
+            skyline.erase(skyline.begin() + next);
+        } else {
+            skyline[next].x += overlap;
+            skyline[next].width -= overlap;
+            break;
+        }
+    }
+    for (size_t i = 0; i + 1 < skyline.size(); ) {
+        if (skyline[i].y == skyline[i + 1].y) {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        } else {
+            i++;
+        }
+    }
+    page.used_area += (size_t) width * height;
+}
+
+// Copies the image to (x, y) inside its gutter and extends its edge
+// pixels across the gutter.
+void texture_atlas::copy_padded(atlas_page &page, const image &source, int x, int y) {
+    const int row_bytes = page.pixels.width * 4;
+    for (int row = -this->padding; row < source.height + this->padding; row++) {
+        const int source_row = std::min(std::max(row, 0), source.height - 1);
+        const uint8_t *from = &source.pixels[(size_t) source_row * source.width * 4];
+        uint8_t *to = &page.pixels.pixels[(size_t) (y + row) * row_bytes + (size_t) x * 4];
+        memcpy(to, from, source.width * 4);
+        for (int column = 1; column <= this->padding; column++) {
+            memcpy(to - column * 4, from, 4);
+            memcpy(to + (source.width + column - 1) * 4, from + (source.width - 1) * 4, 4);
+        }
+    }
+}
+
+// Tries the existing pages in order before starting a new one.
+atlas_region texture_atlas::add(const image &source) {
+    if (source.channels != 4) {
+        throw std::runtime_error("atlas images need 4 channels");
+    }
+    const int padded_width = source.width + 2 * this->padding;
+    const int padded_height = source.height + 2 * this->padding;
+    if (padded_width > this->page_size || padded_height > this->page_size) {
+        throw std::runtime_error("a " + std::to_string(source.width) + "x" + std::to_string(source.height)
+                + " image doesn't fit a " + std::to_string(this->page_size) + " pixel atlas page");
+    }
+
+    size_t segment = 0;
+    int y = 0;
+    size_t page_index = 0;
+    while (page_index < this->pages.size()
+            && !this->find_position(*this->pages[page_index], padded_width, padded_height, segment, y)) {
+        page_index++;
+    }
+    if (page_index == this->pages.size()) {
+        std::unique_ptr<atlas_page> page(new atlas_page());
+        page->pixels = make_image(this->page_size, this->page_size, 4);
+        page->skyline.push_back({0, 0, this->page_size});
+        page->used_area = 0;
+        page->dirty = true;
+        this->pages.push_back(std::move(page));
+        this->find_position(*this->pages.back(), padded_width, padded_height, segment, y);
+    }
+
+    atlas_page &page = *this->pages[page_index];
+    const int x = page.skyline[segment].x;
+    this->place(page, segment, y, padded_width, padded_height);
+    this->copy_padded(page, source, x + this->padding, y + this->padding);
+    page.dirty = true;
+
+    atlas_region region;
+    region.page = page_index;
+    region.x = x + this->padding;
+    region.y = y + this->padding;
+    region.width = source.width;
+    region.height = source.height;
+    region.uv_min = {(float) region.x / this->page_size, (float) region.y / this->page_size};
+    region.uv_max = {(float) (region.x + region.width) / this->page_size, (float) (region.y + region.height) / this->page_size};
+    return region;
+}
+
+// Recreates the textures of pages that changed since the last upload.
+void texture_atlas::upload() {
+    for (auto &page : this->pages) {
+        if (page->dirty) {
+            page->gpu.reset(new texture(page->pixels, this->mipmaps));
+            page->dirty = false;
+        }
+    }
+}
+
+int texture_atlas::get_page_count() const {
+    return this->pages.size();
+}
+
+texture &texture_atlas::get_texture(int page) {
+    if (!this->pages[page]->gpu) {
+        throw std::runtime_error("atlas page " + std::to_string(page) + " hasn't been uploaded");
+    }
+    return *this->pages[page]->gpu;
+}
+
+size_t texture_atlas::get_memory_bytes(int page) const {
+    return this->pages[page]->gpu ? this->pages[page]->gpu->get_memory_bytes() : 0;
+}
+
+// The share of the page covered by images and their gutters.
+float texture_atlas::get_occupancy(int page) const {
+    return (float) this->pages[page]->used_area / ((size_t) this->page_size * this->page_size);
+}
+
+double texture_atlas::get_upload_ms(int page) const {
+    return this->pages[page]->gpu ? this->pages[page]->gpu->get_upload_ms() : 0.0;
+}
@@ -0,0 +1,64 @@
+#ifndef TEXTURE_ATLAS_HPP_
+#define TEXTURE_ATLAS_HPP_
+
+#include <memory>
+#include <vector>
+
+#include <stddef.h>
+
+#include "engine/image.hpp"
+#include "engine/math.hpp"
+#include "engine/texture.hpp"
+
+// Where an image ended up: the page's texture and the texture coordinates
+// of its corners, top left first.
+struct atlas_region {
+    int page;
+    int x;
+    int y;
+    int width;
+    int height;
+    vec2 uv_min;
+    vec2 uv_max;
+};
+
+// Packs many small RGBA images into a few square pages, so everything on
+// a page draws without rebinding textures. Pages are filled bottom-left
+// first along a skyline of the lowest free row in each column span. Every
+// image is surrounded by a gutter that repeats its edge pixels, so
+// filtering doesn't pick up the neighbours; deep mip levels still can.
+class texture_atlas {
+protected:
+    struct skyline_segment {
+        int x;
+        int y;
+        int width;
+    };
+    struct atlas_page {
+        image pixels;
+        std::vector<skyline_segment> skyline;
+        size_t used_area;
+        std::unique_ptr<texture> gpu;
+        bool dirty;
+    };
+    int page_size;
+    int padding;
+    mipmap_mode mipmaps;
+    std::vector<std::unique_ptr<atlas_page>> pages;
+    bool find_position(const atlas_page &page, int width, int height, size_t &segment, int &y) const;
+    void place(atlas_page &page, size_t segment, int y, int width, int height);
+    void copy_padded(atlas_page &page, const image &source, int x, int y);
+public:
+    texture_atlas(int page_size, int padding = 2, mipmap_mode mipmaps = mipmap_mode::automatic);
+    texture_atlas(texture_atlas const &) = delete;
+    void operator=(texture_atlas const &) = delete;
+    atlas_region add(const image &source);
+    void upload();
+    int get_page_count() const;
+    texture &get_texture(int page);
+    size_t get_memory_bytes(int page) const;
+    float get_occupancy(int page) const;
+    double get_upload_ms(int page) const;
+};
+
+#endif // TEXTURE_ATLAS_HPP_
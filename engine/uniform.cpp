@@ -0,0 +1,29 @@
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/gl_check.hpp"
+#include "engine/gl_functions.hpp"
+#include "engine/uniform.hpp"
+
+void upload_uniform(GLint location, const GLint &value) {
+    GL_CALL(glUniform1i(location, value));
+}
+
+void upload_uniform(GLint location, const float &value) {
+    GL_CALL(glUniform1f(location, value));
+}
+
+void upload_uniform(GLint location, const vec2 &value) {
+    GL_CALL(glUniform2fv(location, 1, &value.x));
+}
+
+void upload_uniform(GLint location, const vec3 &value) {
+    GL_CALL(glUniform3fv(location, 1, &value.x));
+}
+
+void upload_uniform(GLint location, const vec4 &value) {
+    GL_CALL(glUniform4fv(location, 1, &value.x));
+}
+
+void upload_uniform(GLint location, const mat4 &value) {
+    GL_CALL(glUniformMatrix4fv(location, 1, GL_FALSE, mat4_data(value)));
+}
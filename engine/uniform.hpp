@@ -0,0 +1,52 @@
+#ifndef UNIFORM_HPP_
+#define UNIFORM_HPP_
+
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/math.hpp"
+#include "engine/shader_program.hpp"
+
+void upload_uniform(GLint location, const GLint &value);
+void upload_uniform(GLint location, const float &value);
+void upload_uniform(GLint location, const vec2 &value);
+void upload_uniform(GLint location, const vec3 &value);
+void upload_uniform(GLint location, const vec4 &value);
+void upload_uniform(GLint location, const mat4 &value);
+
+// Typed handle to a uniform, whose location is resolved on the first set()
+// so that creating it doesn't wait for the program to link. set() only
+// reaches the driver when the value differs from the last one uploaded to
+// that location of the program.
+template <typename T>
+class uniform {
+protected:
+    const shader_program *program;
+    int slot;
+public:
+    uniform() : program(NULL), slot(-1) {
+    }
+
+    uniform(const shader_program &program, const char *name)
+        : program(&program), slot(program.get_uniform_slot(name)) {
+    }
+
+    void set(const T &value) {
+        if (this->program == NULL) {
+            return;
+        }
+        GLint location = this->program->update_uniform(this->slot, &value, sizeof(T));
+        if (location >= 0) {
+            upload_uniform(location, value);
+        }
+    }
+
+    const shader_program *get_program() const {
+        return this->program;
+    }
+
+    int get_slot() const {
+        return this->slot;
+    }
+};
+
+#endif // UNIFORM_HPP_
@@ -1,25 +1,131 @@
+#include <algorithm>
 #include <stdexcept>
 #include <string>
 
+#include <string.h>
+
+#include <SDL2/SDL.h>
 #include <SDL2/SDL_opengles2.h>
 
+#include "engine/frame_stats.hpp"
+#include "engine/gl_check.hpp"
+#include "engine/gl_functions.hpp"
+#include "engine/gl_state.hpp"
 #include "engine/vertex_buffer.hpp"
 
-vertex_buffer::vertex_buffer(const std::vector<float> &buffer) {
-    glGenBuffers(1, &this->buffer_id);
+GLenum get_gl_usage(buffer_usage usage) {
+    switch (usage) {
+        case buffer_usage::dynamic_draw: return GL_DYNAMIC_DRAW;
+        case buffer_usage::stream_draw:  return GL_STREAM_DRAW;
+        default:                         return GL_STATIC_DRAW;
+    }
+}
+
+vertex_buffer::vertex_buffer(const std::vector<float> &buffer)
+    : vertex_buffer(buffer.data(), buffer.size() * sizeof(float)) {
+}
+
+vertex_buffer::vertex_buffer(const void *data, size_t size)
+    : buffer_ids(1), capacities(1, size), current(0), usage(GL_STATIC_DRAW), update_mode(buffer_update::sub_data),
+      map_supported(false) {
+    GL_CALL(glGenBuffers(1, &this->buffer_ids[0]));
     this->bind();
-    glBufferData(GL_ARRAY_BUFFER, buffer.size() * sizeof(float), buffer.data(), GL_STATIC_DRAW);
+    GL_CALL(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+    this->unbind();
+}
+
+// A ring of three is enough for drivers that queue up to two frames ahead.
+vertex_buffer::vertex_buffer(size_t capacity, buffer_usage usage, buffer_update update_mode, int ring_depth)
+    : current(0), usage(get_gl_usage(usage)), update_mode(update_mode), map_supported(false) {
+    if (ring_depth < 1 || (ring_depth > 1 && update_mode != buffer_update::ring)) {
+        throw std::runtime_error("only ring buffers can have more than one store");
+    }
+    // Checked per buffer rather than once per process, since the extension
+    // belongs to the context the buffer was created in.
+    this->map_supported = update_mode == buffer_update::map && SDL_GL_ExtensionSupported("GL_OES_mapbuffer")
+        && is_gl_function_loaded("glMapBufferOES") && is_gl_function_loaded("glUnmapBufferOES");
+    this->buffer_ids.resize(ring_depth);
+    this->capacities.resize(ring_depth, capacity);
+    GL_CALL(glGenBuffers(ring_depth, this->buffer_ids.data()));
+    for (const auto &buffer_id : this->buffer_ids) {
+        get_gl_state().bind_buffer(GL_ARRAY_BUFFER, buffer_id);
+        GL_CALL(glBufferData(GL_ARRAY_BUFFER, capacity, NULL, this->usage));
+    }
     this->unbind();
 }
 
 vertex_buffer::~vertex_buffer() {
-    glDeleteBuffers(1, &this->buffer_id);
+    for (const auto &buffer_id : this->buffer_ids) {
+        get_gl_state().forget_buffer(buffer_id);
+    }
+    glDeleteBuffers(this->buffer_ids.size(), this->buffer_ids.data());
 }
 
 void vertex_buffer::bind() {
-    glBindBuffer(GL_ARRAY_BUFFER, this->buffer_id);
+    get_gl_state().bind_buffer(GL_ARRAY_BUFFER, this->buffer_ids[this->current]);
 }
 
 void vertex_buffer::unbind() {
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    get_gl_state().bind_buffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Grows the current store, which also orphans it.
+void vertex_buffer::reserve(size_t size) {
+    if (size > this->capacities[this->current]) {
+        GL_CALL(glBufferData(GL_ARRAY_BUFFER, size, NULL, this->usage));
+        this->capacities[this->current] = size;
+    }
+}
+
+// Replaces the contents from the start. Ring buffers move on to the next
+// store first, so the one the GPU may still be reading is left alone; the
+// buffer stays bound, and attribute pointers have to be set up again
+// after each update since the bound store changes.
+void vertex_buffer::update(const void *data, size_t size) {
+    if (this->update_mode == buffer_update::ring) {
+        this->current = (this->current + 1) % this->buffer_ids.size();
+    }
+    this->bind();
+
+    if (this->update_mode == buffer_update::orphan || this->update_mode == buffer_update::map) {
+        size_t capacity = std::max(size, this->capacities[this->current]);
+        GL_CALL(glBufferData(GL_ARRAY_BUFFER, capacity, NULL, this->usage));
+        this->capacities[this->current] = capacity;
+    } else {
+        this->reserve(size);
+    }
+
+    void *mapped = NULL;
+    if (this->map_supported) {
+        mapped = GL_CALL(glMapBufferOES(GL_ARRAY_BUFFER, GL_WRITE_ONLY_OES));
+    }
+    if (mapped != NULL) {
+        memcpy(mapped, data, size);
+        // The contents are undefined if the store was lost while mapped.
+        if (GL_CALL(glUnmapBufferOES(GL_ARRAY_BUFFER)) == GL_FALSE) {
+            GL_CALL(glBufferSubData(GL_ARRAY_BUFFER, 0, size, data));
+        }
+    } else {
+        GL_CALL(glBufferSubData(GL_ARRAY_BUFFER, 0, size, data));
+    }
+    get_frame_stats().count(frame_counter::upload_bytes, size);
+}
+
+// Patches part of the current store in place.
+void vertex_buffer::update_range(const void *data, size_t size, size_t offset) {
+    if (offset + size > this->capacities[this->current]) {
+        throw std::runtime_error("vertex_buffer::update_range past the end of the buffer");
+    }
+    this->bind();
+    GL_CALL(glBufferSubData(GL_ARRAY_BUFFER, offset, size, data));
+    get_frame_stats().count(frame_counter::upload_bytes, size);
+}
+
+size_t vertex_buffer::get_capacity() const {
+    return this->capacities[this->current];
+}
+
+// The store the next draw reads from, which moves with update() in ring mode.
+uint32_t vertex_buffer::get_buffer_id() const {
+    return this->buffer_ids[this->current];
 }
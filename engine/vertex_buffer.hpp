@@ -3,18 +3,51 @@
 
 #include <vector>
 
+#include <stddef.h>
 #include <stdint.h>
 
+#include <SDL2/SDL_opengles2.h>
+
+enum class buffer_usage {
+    static_draw,
+    dynamic_draw,
+    stream_draw,
+};
+
+// How update() replaces the contents of a dynamic or stream buffer.
+enum class buffer_update {
+    // glBufferSubData into the same store; stalls if the GPU still reads it.
+    sub_data,
+    // Re-specify the store first so the driver can hand out fresh memory.
+    orphan,
+    // glBufferSubData into the next of several stores, used round-robin.
+    ring,
+    // Orphan, then write through GL_OES_mapbuffer; orphans when unsupported.
+    map,
+};
+
 class vertex_buffer {
 protected:
-    uint32_t buffer_id;
+    std::vector<uint32_t> buffer_ids;
+    std::vector<size_t> capacities;
+    size_t current;
+    GLenum usage;
+    buffer_update update_mode;
+    bool map_supported;
+    void reserve(size_t size);
 public:
     vertex_buffer(const std::vector<float> &buffer);
+    vertex_buffer(const void *data, size_t size);
+    vertex_buffer(size_t capacity, buffer_usage usage, buffer_update update_mode, int ring_depth = 1);
     vertex_buffer(vertex_buffer const &) = delete;
     ~vertex_buffer();
     void operator=(vertex_buffer const &) = delete;
     void bind();
     void unbind();
+    void update(const void *data, size_t size);
+    void update_range(const void *data, size_t size, size_t offset);
+    size_t get_capacity() const;
+    uint32_t get_buffer_id() const;
 };
 
 #endif // VERTEX_BUFFER_HPP_
@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <math.h>
+#include <string.h>
+
+#include "engine/vertex_layout.hpp"
+
+size_t get_gl_type_size(GLenum type) {
+    switch (type) {
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE:
+            return 1;
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+            return 2;
+        case GL_FIXED:
+        case GL_FLOAT:
+            return 4;
+    }
+    throw std::runtime_error("unsupported vertex attribute type " + std::to_string(type));
+}
+
+vertex_layout::vertex_layout() : vertex_size(0) {}
+
+// The layout the original drawables use: every attribute is a tightly
+// packed block of float vectors, one block after the other.
+vertex_layout vertex_layout::planar(const std::vector<std::string> &names, GLint components, int vertex_count) {
+    vertex_layout layout;
+    size_t block_size = sizeof(float) * components * vertex_count;
+    for (size_t i = 0; i < names.size(); i++) {
+        layout.add({names[i], components, GL_FLOAT, GL_FALSE, 0, block_size * i});
+    }
+    return layout;
+}
+
+void vertex_layout::add(const vertex_attribute &attribute) {
+    this->attributes.push_back(attribute);
+}
+
+void vertex_layout::append(const std::string &name, GLint components, GLenum type, GLboolean normalized) {
+    size_t offset = this->vertex_size;
+    size_t size = get_gl_type_size(type) * components;
+    this->vertex_size += (size + 3) & ~((size_t) 3);
+
+    this->attributes.push_back({name, components, type, normalized, 0, offset});
+    for (auto &attribute : this->attributes) {
+        attribute.stride = this->vertex_size;
+    }
+}
+
+const std::vector<vertex_attribute> &vertex_layout::get_attributes() const {
+    return this->attributes;
+}
+
+int vertex_layout::find(const std::string &name) const {
+    for (size_t i = 0; i < this->attributes.size(); i++) {
+        if (this->attributes[i].name == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+size_t vertex_layout::get_vertex_size() const {
+    return this->vertex_size;
+}
+
+size_t vertex_layout::get_buffer_size(int vertex_count) const {
+    size_t size = 0;
+    if (vertex_count <= 0) {
+        return size;
+    }
+    for (const auto &attribute : this->attributes) {
+        size_t element_size = get_gl_type_size(attribute.type) * attribute.components;
+        size_t stride = attribute.stride ? attribute.stride : element_size;
+        size = std::max(size, attribute.offset + stride * (vertex_count - 1) + element_size);
+    }
+    return size;
+}
+
+// Converts per-attribute float values into the layout's storage types.
+// Normalized integer types map [-1, 1] or [0, 1] onto their full range;
+// GL_FIXED is 16.16 and, as in GL, ignores the normalized flag.
+std::vector<uint8_t> vertex_layout::pack(const std::vector<std::vector<float>> &values, int vertex_count) const {
+    if (values.size() != this->attributes.size()) {
+        throw std::runtime_error("vertex_layout::pack needs one value array per attribute");
+    }
+
+    std::vector<uint8_t> buffer(this->get_buffer_size(vertex_count));
+    for (size_t a = 0; a < this->attributes.size(); a++) {
+        const vertex_attribute &attribute = this->attributes[a];
+        size_t type_size = get_gl_type_size(attribute.type);
+        size_t stride = attribute.stride ? attribute.stride : type_size * attribute.components;
+        if (values[a].size() < (size_t) (attribute.components * vertex_count)) {
+            throw std::runtime_error("not enough values for vertex attribute \"" + attribute.name + "\"");
+        }
+
+        for (int v = 0; v < vertex_count; v++) {
+            uint8_t *element = &buffer[attribute.offset + stride * v];
+            for (int c = 0; c < attribute.components; c++) {
+                float value = values[a][v * attribute.components + c];
+                uint8_t *dest = element + type_size * c;
+                switch (attribute.type) {
+                    case GL_FLOAT:
+                        memcpy(dest, &value, sizeof(float));
+                        break;
+                    case GL_FIXED: {
+                        int32_t packed = (int32_t) lrint(value * 65536.0);
+                        memcpy(dest, &packed, sizeof(packed));
+                        break;
+                    }
+                    case GL_SHORT: {
+                        float scaled = attribute.normalized ? std::max(-1.0f, std::min(1.0f, value)) * 32767.0f : value;
+                        int16_t packed = (int16_t) lrintf(scaled);
+                        memcpy(dest, &packed, sizeof(packed));
+                        break;
+                    }
+                    case GL_UNSIGNED_SHORT: {
+                        float scaled = attribute.normalized ? std::max(0.0f, std::min(1.0f, value)) * 65535.0f : value;
+                        uint16_t packed = (uint16_t) lrintf(scaled);
+                        memcpy(dest, &packed, sizeof(packed));
+                        break;
+                    }
+                    case GL_BYTE:
+                        *(int8_t*) dest = (int8_t) lrintf(attribute.normalized ? std::max(-1.0f, std::min(1.0f, value)) * 127.0f : value);
+                        break;
+                    case GL_UNSIGNED_BYTE:
+                        *dest = (uint8_t) lrintf(attribute.normalized ? std::max(0.0f, std::min(1.0f, value)) * 255.0f : value);
+                        break;
+                    default:
+                        throw std::runtime_error("can't pack vertex attribute \"" + attribute.name + "\"");
+                }
+            }
+        }
+    }
+    return buffer;
+}
+
+// Reads one component back as a float the way GL would fetch it, including
+// the (0, 0, 0, 1) defaults for components the attribute doesn't store.
+float vertex_layout::read(const uint8_t *data, int attribute_index, int vertex, int component) const {
+    const vertex_attribute &attribute = this->attributes[attribute_index];
+    if (component >= attribute.components) {
+        return component == 3 ? 1.0f : 0.0f;
+    }
+
+    size_t type_size = get_gl_type_size(attribute.type);
+    size_t stride = attribute.stride ? attribute.stride : type_size * attribute.components;
+    const uint8_t *src = data + attribute.offset + stride * vertex + type_size * component;
+    switch (attribute.type) {
+        case GL_FLOAT: {
+            float value;
+            memcpy(&value, src, sizeof(value));
+            return value;
+        }
+        case GL_FIXED: {
+            int32_t value;
+            memcpy(&value, src, sizeof(value));
+            return value / 65536.0f;
+        }
+        case GL_SHORT: {
+            int16_t value;
+            memcpy(&value, src, sizeof(value));
+            return attribute.normalized ? std::max(value / 32767.0f, -1.0f) : value;
+        }
+        case GL_UNSIGNED_SHORT: {
+            uint16_t value;
+            memcpy(&value, src, sizeof(value));
+            return attribute.normalized ? value / 65535.0f : value;
+        }
+        case GL_BYTE: {
+            int8_t value = *(const int8_t*) src;
+            return attribute.normalized ? std::max(value / 127.0f, -1.0f) : value;
+        }
+        case GL_UNSIGNED_BYTE:
+            return attribute.normalized ? *src / 255.0f : *src;
+    }
+    throw std::runtime_error("can't read vertex attribute \"" + attribute.name + "\"");
+}
@@ -0,0 +1,44 @@
+#ifndef VERTEX_LAYOUT_HPP_
+#define VERTEX_LAYOUT_HPP_
+
+#include <string>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <SDL2/SDL_opengles2.h>
+
+struct vertex_attribute {
+    std::string name;
+    GLint components;
+    GLenum type;
+    GLboolean normalized;
+    GLsizei stride;
+    size_t offset;
+};
+
+// Describes where each named attribute lives in a vertex buffer. Either add
+// attributes with an explicit stride and offset (e.g. planar blocks), or
+// append them all to an interleaved vertex whose stride grows as they are
+// added; the two styles aren't meant to be mixed in one layout.
+class vertex_layout {
+protected:
+    std::vector<vertex_attribute> attributes;
+    size_t vertex_size;
+public:
+    vertex_layout();
+    static vertex_layout planar(const std::vector<std::string> &names, GLint components, int vertex_count);
+    void add(const vertex_attribute &attribute);
+    void append(const std::string &name, GLint components, GLenum type, GLboolean normalized);
+    const std::vector<vertex_attribute> &get_attributes() const;
+    int find(const std::string &name) const;
+    size_t get_vertex_size() const;
+    size_t get_buffer_size(int vertex_count) const;
+    std::vector<uint8_t> pack(const std::vector<std::vector<float>> &values, int vertex_count) const;
+    float read(const uint8_t *data, int attribute, int vertex, int component) const;
+};
+
+size_t get_gl_type_size(GLenum type);
+
+#endif // VERTEX_LAYOUT_HPP_
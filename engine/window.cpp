@@ -1,6 +1,16 @@
 #include <stdexcept>
 #include <string>
 
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/bench.hpp"
+#include "engine/frame_stats.hpp"
+#include "engine/gl_check.hpp"
+#include "engine/gl_functions.hpp"
+#include "engine/gl_state.hpp"
+#include "engine/gl_trace.hpp"
+#include "engine/program_cache.hpp"
 #include "engine/window.hpp"
 
 window::window() {
@@ -26,13 +36,56 @@ window::window() {
         SDL_DestroyWindow(this->sdl_window);
         throw std::runtime_error("SDL_GL_CreateContext failed: " + std::string(SDL_GetError()));
     }
+    load_gl_functions();
+
+    // Let the driver compile on its own threads; programs only wait for
+    // the result when they are first used.
+    if (SDL_GL_ExtensionSupported("GL_KHR_parallel_shader_compile")
+        && is_gl_function_loaded("glMaxShaderCompilerThreadsKHR")) {
+        GL_CALL(glMaxShaderCompilerThreadsKHR(0xffffffff));
+    }
+
+    get_gl_state().reset();
+    get_frame_stats().begin_frame();
 }
 
 window::~window() {
+    get_program_cache().release_shaders();
     SDL_GL_DeleteContext(this->sdl_glcontext);
     SDL_DestroyWindow(this->sdl_window);
 }
 
+// Returns the swap mode actually in effect, since drivers without late
+// swap tearing support reject adaptive vsync.
+swap_mode window::set_pacing(double target_fps, swap_mode mode) {
+    this->pacer.set_target_fps(target_fps);
+
+    if (mode == swap_mode::adaptive && SDL_GL_SetSwapInterval(-1) == 0) {
+        return swap_mode::adaptive;
+    }
+    if (mode != swap_mode::off && SDL_GL_SetSwapInterval(1) == 0) {
+        return swap_mode::on;
+    }
+    SDL_GL_SetSwapInterval(0);
+    return swap_mode::off;
+}
+
+// In pixels, which differ from window coordinates on high-DPI displays.
+void window::get_drawable_size(int *width, int *height) const {
+    SDL_GL_GetDrawableSize(this->sdl_window, width, height);
+}
+
 void window::swap() {
+    frame_stats &stats = get_frame_stats();
+    stats.mark(frame_stage::draw);
+    if (!this->pacer.wait()) {
+        stats.count(frame_counter::missed_deadlines);
+    }
+    stats.mark(frame_stage::wait);
     SDL_GL_SwapWindow(this->sdl_window);
+    stats.mark(frame_stage::swap);
+    stats.end_frame();
+    advance_gl_check_frame();
+    get_gl_tracer().end_frame();
+    bench::on_swap();
 }
@@ -3,15 +3,20 @@
 
 #include <SDL2/SDL.h>
 
+#include "engine/frame_pacer.hpp"
+
 class window {
 protected:
     SDL_Window* sdl_window;
     SDL_GLContext sdl_glcontext;
+    frame_pacer pacer;
 public:
     window();
     window(window const &) = delete;
     ~window();
     void operator=(window const &) = delete;
+    swap_mode set_pacing(double target_fps, swap_mode mode);
+    void get_drawable_size(int *width, int *height) const;
     void swap();
 };
 
@@ -1,4 +1,3 @@
-#include <list>
 #include <memory>
 #include <vector>
 
@@ -8,9 +7,16 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_opengles2.h>
 
+#include "engine/action_map.hpp"
+#include "engine/basic_shader.hpp"
 #include "engine/engine.hpp"
-#include "engine/shader.hpp"
+#include "engine/gl_functions.hpp"
+#include "engine/gl_state.hpp"
+#include "engine/keyboard_state.hpp"
+#include "engine/math.hpp"
 #include "engine/shader_program.hpp"
+#include "engine/shader_variants.hpp"
+#include "engine/uniform.hpp"
 #include "engine/vertex_buffer.hpp"
 #include "engine/window.hpp"
 #include "modules/movable_square.hpp"
@@ -18,56 +24,30 @@
 namespace movable_square {
     const std::string module_name("movable_square");
 
-    struct vec2 {
-        float x;
-        float y;
-    };
-
-    const char *vertex_shader_source = R"glsl(
-#version 100
-
-attribute vec4 position;
-attribute vec4 color;
-
-varying vec4 fragment_color;
-
-uniform vec2 offset;
-
-void main() {
-    fragment_color = color;
-    gl_Position = position + vec4(offset.xy, 0.0, 0.0);
-}
-)glsl";
-
-    const char *fragment_shader_source = R"glsl(
-#version 100
-
-precision mediump float;
-
-varying vec4 fragment_color;
-
-void main() {
-   gl_FragColor = fragment_color;
-}
-)glsl";
-
     const int vertex_depth = 4;
     const float square_units_per_msec = 0.001f;
     const float square_unit_offset = 0.025f;
 
-    bool left_pressed = 0;
-    bool right_pressed = 0;
-    bool up_pressed = 0;
-    bool down_pressed = 0;
+    struct movement {
+        const char *action;
+        SDL_Scancode default_key;
+        float dx;
+        float dy;
+    };
+
+    const movement movements[] = {
+        {"left", SDL_SCANCODE_LEFT, -square_unit_offset, 0.0f},
+        {"right", SDL_SCANCODE_RIGHT, square_unit_offset, 0.0f},
+        {"up", SDL_SCANCODE_UP, 0.0f, square_unit_offset},
+        {"down", SDL_SCANCODE_DOWN, 0.0f, -square_unit_offset},
+    };
 
     int run(int argc, char **argv) {
-        engine e;
+        engine e(argc, argv);
         window main_window;
 
-        std::list<shader> shaders;
-        shaders.emplace_back(GL_VERTEX_SHADER, vertex_shader_source);
-        shaders.emplace_back(GL_FRAGMENT_SHADER, fragment_shader_source);
-        shader_program main_program(shaders);
+        shader_variants shaders(basic_vertex_source, basic_fragment_source);
+        std::shared_ptr<shader_program> main_program = shaders.get(shaders.get_feature("OFFSET"));
 
         std::vector<float> square_vertex_vector {
             0.1f, 0.1f, 0.0f, 1.0f,
@@ -82,14 +62,14 @@ void main() {
         const int vertex_count = square_vertex_vector.size() / vertex_depth / 2;
         vertex_buffer square_vertices(square_vertex_vector);
 
-        main_program.use();
+        main_program->use();
         square_vertices.bind();
-        uint32_t position_attrib = main_program.get_attrib_location("position");
-        glEnableVertexAttribArray(position_attrib);
-        glVertexAttribPointer(position_attrib, vertex_depth, GL_FLOAT, GL_FALSE, 0, 0);
-        uint32_t color_attrib = main_program.get_attrib_location("color");
-        glEnableVertexAttribArray(color_attrib);
-        glVertexAttribPointer(
+        uint32_t position_attrib = main_program->get_attrib_location("position");
+        get_gl_state().enable_vertex_attrib(position_attrib);
+        get_gl_state().vertex_attrib_pointer(position_attrib, vertex_depth, GL_FLOAT, GL_FALSE, 0, 0);
+        uint32_t color_attrib = main_program->get_attrib_location("color");
+        get_gl_state().enable_vertex_attrib(color_attrib);
+        get_gl_state().vertex_attrib_pointer(
                 color_attrib,
                 vertex_depth,
                 GL_FLOAT,
@@ -97,58 +77,42 @@ void main() {
                 0,
                 (GLvoid*) (sizeof(float) * vertex_depth * vertex_count));
 
-        uint32_t offset_uniform = main_program.get_uniform_location("offset");
-        vec2 offsets;
-
-        SDL_Event event;
-        bool done = false;
-        while (!done) {
-            while (SDL_PollEvent(&event)) {
-                switch (event.type) {
-                    case SDL_QUIT:
-                        done = true;
-                        break;
-                    case SDL_KEYDOWN:
-                        switch (event.key.keysym.sym) {
-                            case SDLK_LEFT:  left_pressed = 1; break;
-                            case SDLK_RIGHT: right_pressed = 1; break;
-                            case SDLK_UP:    up_pressed = 1; break;
-                            case SDLK_DOWN:  down_pressed = 1; break;
-                        }
-                        break;
-                    case SDL_KEYUP:
-                        switch (event.key.keysym.sym) {
-                            case SDLK_LEFT:  left_pressed = 0; break;
-                            case SDLK_RIGHT: right_pressed = 0; break;
-                            case SDLK_UP:    up_pressed = 0; break;
-                            case SDLK_DOWN:  down_pressed = 0; break;
-                        }
-                        break;
-                }
-            }
+        uniform<vec3> offset_uniform(*main_program, "offset");
+        vec3 offsets = {0.0f, 0.0f, 0.0f};
 
-            if (left_pressed) {
-                offsets.x -= square_unit_offset;
-            }
-            if (right_pressed) {
-                offsets.x += square_unit_offset;
-            }
-            if (up_pressed) {
-                offsets.y += square_unit_offset;
-            }
-            if (down_pressed) {
-                offsets.y -= square_unit_offset;
-            }
+        keyboard_state kb;
+        action_map actions;
+        for (const auto &m : movements) {
+            actions.bind(m.action, m.default_key);
+        }
+        actions.apply_options(argc, argv);
+        std::vector<int> movement_actions;
+        for (const auto &m : movements) {
+            movement_actions.push_back(actions.get_action(m.action));
+        }
 
+        frame_callbacks callbacks;
+        callbacks.on_event = [&](const SDL_Event &event) {
+            kb.update_state(event);
+        };
+        callbacks.on_update = [&]() {
+            for (size_t i = 0; i < movement_actions.size(); i++) {
+                if (actions.is_active(movement_actions[i], kb)) {
+                    offsets.x += movements[i].dx;
+                    offsets.y += movements[i].dy;
+                }
+            }
+            kb.end_frame();
+        };
+        callbacks.on_draw = [&]() {
             glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
             glClear(GL_COLOR_BUFFER_BIT);
 
-            glUniform2f(offset_uniform, offsets.x, offsets.y);
+            offset_uniform.set(offsets);
 
             glDrawArrays(GL_TRIANGLE_FAN, 0, vertex_count);
-
-            main_window.swap();
-        }
+        };
+        e.run(main_window, callbacks);
 
         return 0;
     }
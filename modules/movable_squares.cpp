@@ -1,4 +1,3 @@
-#include <list>
 #include <memory>
 #include <vector>
 
@@ -8,137 +7,134 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_opengles2.h>
 
+#include "engine/action_map.hpp"
+#include "engine/basic_shader.hpp"
 #include "engine/drawable.hpp"
+#include "engine/drawable_store.hpp"
 #include "engine/engine.hpp"
+#include "engine/gl_functions.hpp"
 #include "engine/keyboard_state.hpp"
 #include "engine/scene.hpp"
-#include "engine/shader.hpp"
 #include "engine/shader_program.hpp"
+#include "engine/shader_variants.hpp"
 #include "engine/vertex_buffer.hpp"
+#include "engine/vertex_layout.hpp"
 #include "engine/window.hpp"
 #include "modules/movable_squares.hpp"
 
 namespace movable_squares {
     const std::string module_name("movable_squares");
 
-    const char *vertex_shader_source = R"glsl(
-#version 100
-
-attribute vec4 position;
-attribute vec4 color;
-
-varying vec4 fragment_color;
-
-uniform vec3 offset;
-
-void main() {
-    fragment_color = color;
-    gl_Position = position + vec4(offset.xyz, 0.0);
-}
-)glsl";
-
-    const char *fragment_shader_source = R"glsl(
-#version 100
-
-precision mediump float;
-
-varying vec4 fragment_color;
-
-void main() {
-   gl_FragColor = fragment_color;
-}
-)glsl";
-
-    const int vertex_depth = 4;
+    const int vertex_count = 4;
     const float square_unit_offset = 0.025f;
 
+    struct movement {
+        const char *action;
+        SDL_Scancode default_key;
+        int square;
+        float dx;
+        float dy;
+    };
+
+    const movement movements[] = {
+        {"square_1_up", SDL_SCANCODE_UP, 0, 0.0f, square_unit_offset},
+        {"square_1_left", SDL_SCANCODE_LEFT, 0, -square_unit_offset, 0.0f},
+        {"square_1_down", SDL_SCANCODE_DOWN, 0, 0.0f, -square_unit_offset},
+        {"square_1_right", SDL_SCANCODE_RIGHT, 0, square_unit_offset, 0.0f},
+        {"square_2_up", SDL_SCANCODE_W, 1, 0.0f, square_unit_offset},
+        {"square_2_left", SDL_SCANCODE_A, 1, -square_unit_offset, 0.0f},
+        {"square_2_down", SDL_SCANCODE_S, 1, 0.0f, -square_unit_offset},
+        {"square_2_right", SDL_SCANCODE_D, 1, square_unit_offset, 0.0f},
+    };
+
     int run(int argc, char **argv) {
-        engine e;
+        engine e(argc, argv);
         window main_window;
 
-        std::list<shader> shaders;
-        shaders.emplace_back(GL_VERTEX_SHADER, vertex_shader_source);
-        shaders.emplace_back(GL_FRAGMENT_SHADER, fragment_shader_source);
-        auto main_program = std::make_shared<shader_program>(shaders);
+        shader_variants shaders(basic_vertex_source, basic_fragment_source);
+        std::shared_ptr<shader_program> main_program = shaders.get(shaders.get_feature("OFFSET"));
 
-        std::vector<float> square_1_vertex_vector {
-            0.0f, 0.0f, 0.0f, 1.0f,
-            -0.2f, 0.0f, 0.0f, 1.0f,
-            -0.2f, -0.2f, 0.0f, 1.0f,
-            0.0f, -0.2f, 0.0f, 1.0f,
+        // 8 bytes per vertex: normalized shorts for x/y (z and w default to
+        // 0 and 1) followed by normalized bytes for the colour.
+        vertex_layout square_layout;
+        square_layout.append("position", 2, GL_SHORT, GL_TRUE);
+        square_layout.append("color", 4, GL_UNSIGNED_BYTE, GL_TRUE);
+
+        std::vector<float> square_1_positions {
+            0.0f, 0.0f,
+            -0.2f, 0.0f,
+            -0.2f, -0.2f,
+            0.0f, -0.2f
+        };
+        std::vector<float> square_1_colors {
             0.0f, 1.0f, 0.0f, 1.0f,
             0.0f, 1.0f, 0.0f, 1.0f,
             0.0f, 1.0f, 0.0f, 1.0f,
             0.0f, 1.0f, 0.0f, 1.0f
         };
 
-        std::vector<float> square_2_vertex_vector {
-            0.1f, 0.1f, 0.0f, 1.0f,
-            -0.1f, 0.1f, 0.0f, 1.0f,
-            -0.1f, -0.1f, 0.0f, 1.0f,
-            0.1f, -0.1f, 0.0f, 1.0f,
+        std::vector<float> square_2_positions {
+            0.1f, 0.1f,
+            -0.1f, 0.1f,
+            -0.1f, -0.1f,
+            0.1f, -0.1f
+        };
+        std::vector<float> square_2_colors {
             1.0f, 0.0f, 0.0f, 1.0f,
             1.0f, 0.0f, 0.0f, 1.0f,
             1.0f, 0.0f, 0.0f, 1.0f,
             1.0f, 0.0f, 0.0f, 1.0f
         };
 
-        auto square_1 = std::make_shared<drawable>(square_1_vertex_vector, vertex_depth, *main_program);
-        auto square_2 = std::make_shared<drawable>(square_2_vertex_vector, vertex_depth, *main_program);
-        auto drawables = std::make_shared<std::list<std::shared_ptr<drawable>>>();
-        drawables->push_back(square_1);
-        drawables->push_back(square_2);
-        scene squares(drawables, main_program);
+        scene squares(main_program);
+        drawable_store &drawables = squares.get_drawables();
+        drawable_handle square_1 = drawables.add(
+                std::make_unique<drawable>(
+                    square_layout.pack({square_1_positions, square_1_colors}, vertex_count),
+                    square_layout,
+                    vertex_count,
+                    *main_program),
+                {0.0f, 0.0f, 0.0f});
+        drawable_handle square_2 = drawables.add(
+                std::make_unique<drawable>(
+                    square_layout.pack({square_2_positions, square_2_colors}, vertex_count),
+                    square_layout,
+                    vertex_count,
+                    *main_program),
+                {0.0f, 0.0f, 0.0f});
+
+        const drawable_handle squares_by_index[] = {square_1, square_2};
 
         keyboard_state kb;
+        action_map actions;
+        for (const auto &m : movements) {
+            actions.bind(m.action, m.default_key);
+        }
+        actions.apply_options(argc, argv);
+        std::vector<int> movement_actions;
+        for (const auto &m : movements) {
+            movement_actions.push_back(actions.get_action(m.action));
+        }
 
-        SDL_Event event;
-        bool done = false;
-        while (!done) {
-            while (SDL_PollEvent(&event)) {
-                switch (event.type) {
-                    case SDL_QUIT:
-                        done = true;
-                        break;
-                    case SDL_KEYDOWN:
-                    case SDL_KEYUP:
-                        kb.update_state(event.type, event.key.keysym.sym);
-                        break;
+        frame_callbacks callbacks;
+        callbacks.on_event = [&](const SDL_Event &event) {
+            kb.update_state(event);
+        };
+        callbacks.on_update = [&]() {
+            for (size_t i = 0; i < movement_actions.size(); i++) {
+                if (actions.is_active(movement_actions[i], kb)) {
+                    drawables.update_offset(squares_by_index[movements[i].square], movements[i].dx, movements[i].dy, 0);
                 }
             }
-
-            if (kb.get_up_pressed()) {
-                square_1->update_offsets(0, square_unit_offset, 0);
-            }
-            if (kb.get_left_pressed()) {
-                square_1->update_offsets(-square_unit_offset, 0, 0);
-            }
-            if (kb.get_down_pressed()) {
-                square_1->update_offsets(0, -square_unit_offset, 0);
-            }
-            if (kb.get_right_pressed()) {
-                square_1->update_offsets(square_unit_offset, 0, 0);
-            }
-            if (kb.get_w_pressed()) {
-                square_2->update_offsets(0, square_unit_offset, 0);
-            }
-            if (kb.get_a_pressed()) {
-                square_2->update_offsets(-square_unit_offset, 0, 0);
-            }
-            if (kb.get_s_pressed()) {
-                square_2->update_offsets(0, -square_unit_offset, 0);
-            }
-            if (kb.get_d_pressed()) {
-                square_2->update_offsets(square_unit_offset, 0, 0);
-            }
-
+            kb.end_frame();
+        };
+        callbacks.on_draw = [&]() {
             glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
             glClear(GL_COLOR_BUFFER_BIT);
 
             squares.draw();
-
-            main_window.swap();
-        }
+        };
+        e.run(main_window, callbacks);
 
         return 0;
     }
@@ -1,6 +1,5 @@
-#include <iostream>
-#include <list>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <math.h>
@@ -9,78 +8,25 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_opengles2.h>
 
-#include "engine/shader.hpp"
+#include "engine/action_map.hpp"
+#include "engine/asset_streamer.hpp"
+#include "engine/basic_shader.hpp"
+#include "engine/drawable.hpp"
+#include "engine/engine.hpp"
+#include "engine/gl_functions.hpp"
+#include "engine/keyboard_state.hpp"
+#include "engine/math.hpp"
+#include "engine/mesh_optimizer.hpp"
 #include "engine/shader_program.hpp"
-#include "engine/vertex_buffer.hpp"
+#include "engine/shader_variants.hpp"
+#include "engine/uniform.hpp"
+#include "engine/vertex_layout.hpp"
 #include "engine/window.hpp"
 #include "modules/perspective_cube.hpp"
 
 namespace perspective_cube {
     const std::string module_name("perspective_cube");
 
-    struct mat4 {
-        float c1_r1;
-        float c1_r2;
-        float c1_r3;
-        float c1_r4;
-        float c2_r1;
-        float c2_r2;
-        float c2_r3;
-        float c2_r4;
-        float c3_r1;
-        float c3_r2;
-        float c3_r3;
-        float c3_r4;
-        float c4_r1;
-        float c4_r2;
-        float c4_r3;
-        float c4_r4;
-    };
-
-    struct vec4 {
-        float x;
-        float y;
-        float z;
-        float w;
-    };
-
-    const char *vertex_shader_source = R"glsl(
-#version 100
-
-attribute vec4 position;
-attribute vec4 color;
-
-varying vec4 fragment_color;
-
-uniform mat4 y_rotation_matrix;
-uniform mat4 z_rotation_matrix;
-
-uniform vec4 object_offset;
-uniform vec4 camera_offset;
-
-uniform mat4 perspective_matrix;
-
-void main() {
-    fragment_color = color;
-
-    vec4 camera_position = (y_rotation_matrix * (z_rotation_matrix * position)) + object_offset + camera_offset;
-
-    gl_Position = perspective_matrix * camera_position;
-}
-)glsl";
-
-    const char *fragment_shader_source = R"glsl(
-#version 100
-
-precision mediump float;
-
-varying vec4 fragment_color;
-
-void main() {
-   gl_FragColor = fragment_color;
-}
-)glsl";
-
     const int vertex_depth = 4;
 
     const float y_rotation_period = 60.0f;
@@ -88,13 +34,29 @@ void main() {
     const float y_angular_ratio = M_PI * 2.0f / y_rotation_period;
     const float z_angular_ratio = M_PI * 2.0f / z_rotation_period;
 
+    // In units per second while a key is held. A long frame, like one spent
+    // loading a mesh, counts as at most camera_max_step seconds, so the
+    // camera doesn't jump once it is over.
     const float camera_speed = 1.0f;
+    const float camera_max_step = 0.1f;
+
+    struct movement {
+        const char *action;
+        SDL_Scancode default_key;
+        float dx;
+        float dz;
+    };
+
+    const movement movements[] = {
+        {"camera_left", SDL_SCANCODE_LEFT, 1.0f, 0.0f},
+        {"camera_right", SDL_SCANCODE_RIGHT, -1.0f, 0.0f},
+        {"camera_forward", SDL_SCANCODE_UP, 0.0f, 1.0f},
+        {"camera_back", SDL_SCANCODE_DOWN, 0.0f, -1.0f},
+    };
 
     const float frustum_scale = 2.0f;
     const float z_near = 0.1f;
     const float z_far = 10.0f;
-    const float z_mapping_factor = (z_near + z_far) / (z_near - z_far);
-    const float z_mapping_offset = (2 * z_near * z_far) / (z_near - z_far);
 
     float get_rotation_angle(float rotation_period, float angular_ratio) {
         float elapsed_time = SDL_GetTicks() / 1000.0f;
@@ -103,12 +65,19 @@ void main() {
     }
 
     int run(int argc, char **argv) {
+        std::string mesh_path;
+        for (int i = 2; i < argc; i++) {
+            std::string arg(argv[i]);
+            if (arg == "--mesh" && i + 1 < argc) {
+                mesh_path = argv[++i];
+            }
+        }
+
+        engine e(argc, argv);
         window main_window;
 
-        std::list<shader> shaders;
-        shaders.emplace_back(GL_VERTEX_SHADER, vertex_shader_source);
-        shaders.emplace_back(GL_FRAGMENT_SHADER, fragment_shader_source);
-        shader_program main_program(shaders);
+        shader_variants shaders(basic_vertex_source, basic_fragment_source);
+        std::shared_ptr<shader_program> main_program = shaders.get(shaders.get_feature("MVP"));
 
         std::vector<float> cube_vertex_vector {
             -0.5f, 0.5f, 0.5f, 1.0f,
@@ -207,97 +176,109 @@ void main() {
             1.0f, 0.0f, 1.0f, 1.0f,
             1.0f, 0.0f, 1.0f, 1.0f,
         };
-        const int vertex_count = cube_vertex_vector.size() / vertex_depth / 2;
-        vertex_buffer cube_vertices(cube_vertex_vector);
+        const int expanded_vertex_count = cube_vertex_vector.size() / vertex_depth / 2;
+
+        // The expanded triangle list repeats the two shared corners of every
+        // face; welding brings the 36 vertices down to 24 plus indices.
+        vertex_layout cube_layout;
+        cube_layout.append("position", 3, GL_FLOAT, GL_FALSE);
+        cube_layout.append("color", 4, GL_UNSIGNED_BYTE, GL_TRUE);
+
+        std::vector<float> cube_positions;
+        std::vector<float> cube_colors;
+        for (int v = 0; v < expanded_vertex_count; v++) {
+            const float *position = &cube_vertex_vector[v * vertex_depth];
+            const float *color = &cube_vertex_vector[(expanded_vertex_count + v) * vertex_depth];
+            cube_positions.insert(cube_positions.end(), position, position + 3);
+            cube_colors.insert(cube_colors.end(), color, color + 4);
+        }
+
+        std::vector<uint8_t> cube_vertex_bytes;
+        std::vector<uint32_t> cube_indices;
+        const int vertex_count = weld_vertices(
+                cube_layout.pack({cube_positions, cube_colors}, expanded_vertex_count),
+                cube_layout.get_vertex_size(),
+                cube_vertex_bytes,
+                cube_indices);
+        optimize_vertex_cache(cube_indices, vertex_count);
+        optimize_vertex_fetch(cube_vertex_bytes, cube_layout.get_vertex_size(), cube_indices);
+        std::unique_ptr<drawable> model(
+                new drawable(cube_vertex_bytes, cube_layout, vertex_count, get_short_indices(cube_indices), *main_program));
 
         glEnable(GL_CULL_FACE);
         glCullFace(GL_BACK);
         glFrontFace(GL_CW);
 
-        main_program.use();
-        cube_vertices.bind();
-        uint32_t position_attrib = main_program.get_attrib_location("position");
-        glEnableVertexAttribArray(position_attrib);
-        glVertexAttribPointer(position_attrib, vertex_depth, GL_FLOAT, GL_FALSE, 0, 0);
-        uint32_t color_attrib = main_program.get_attrib_location("color");
-        glEnableVertexAttribArray(color_attrib);
-        glVertexAttribPointer(
-                color_attrib,
-                vertex_depth,
-                GL_FLOAT,
-                GL_FALSE,
-                0,
-                (GLvoid*) (sizeof(float) * vertex_depth * vertex_count));
-
-        uint32_t object_offset_uniform = main_program.get_uniform_location("object_offset");
-        glUniform4f(object_offset_uniform, 0.0f, 0.0f, -2.0f, 0.0f);
+        // The cube stands in until the mesh has streamed in. Meshes
+        // converted by obj2mesh keep OBJ's counter-clockwise winding.
+        asset_streamer streamer;
+        streamer.apply_options(argc, argv);
+        if (!mesh_path.empty()) {
+            streamer.request_mesh(mesh_path, *main_program, [&](std::unique_ptr<drawable> mesh) {
+                model = std::move(mesh);
+                glFrontFace(GL_CCW);
+            });
+        }
 
+        main_program->use();
+
+        const vec4 object_offset = {0.0f, 0.0f, -2.0f, 0.0f};
         vec4 camera_offset = {0, 0, 0, 0};
-        uint32_t camera_offset_uniform = main_program.get_uniform_location("camera_offset");
-        glUniform4fv(camera_offset_uniform, 1, (const float*) &camera_offset);
-
-        const mat4 perspective_matrix = {
-            frustum_scale, 0, 0, 0,
-            0, frustum_scale, 0, 0,
-            0, 0, z_mapping_factor, -1,
-            0, 0, z_mapping_offset, 0,
+        const mat4 perspective_matrix = mat4_perspective(frustum_scale, z_near, z_far);
+        uniform<mat4> mvp_uniform(*main_program, "mvp");
+
+        float y_rotation_angle = 0.0f;
+        float z_rotation_angle = 0.0f;
+
+        keyboard_state kb;
+        action_map actions;
+        for (const auto &m : movements) {
+            actions.bind(m.action, m.default_key);
+        }
+        actions.apply_options(argc, argv);
+        std::vector<int> movement_actions;
+        for (const auto &m : movements) {
+            movement_actions.push_back(actions.get_action(m.action));
+        }
+
+        uint32_t last_update_ticks = SDL_GetTicks();
+
+        frame_callbacks callbacks;
+        callbacks.on_event = [&](const SDL_Event &event) {
+            kb.update_state(event);
         };
-        uint32_t perspective_matrix_uniform = main_program.get_uniform_location("perspective_matrix");
-        glUniformMatrix4fv(perspective_matrix_uniform, 1, GL_FALSE, (const float*) &perspective_matrix);
-
-        uint32_t y_rotation_matrix_uniform = main_program.get_uniform_location("y_rotation_matrix");
-        uint32_t z_rotation_matrix_uniform = main_program.get_uniform_location("z_rotation_matrix");
-
-        SDL_Event event;
-        bool done = false;
-        while (!done) {
-            while (SDL_PollEvent(&event)) {
-                switch (event.type) {
-                    case SDL_QUIT:
-                        done = true;
-                        break;
-                    case SDL_KEYDOWN:
-                        switch (event.key.keysym.sym) {
-                            case SDLK_LEFT:  camera_offset.x += 10.0/60.0; break;
-                            case SDLK_RIGHT: camera_offset.x -= 10.0/60.0; break;
-                            case SDLK_UP:    camera_offset.z += 10.0/60.0; break;
-                            case SDLK_DOWN:  camera_offset.z -= 10.0/60.0; break;
-                        }
-                        std::cout << camera_offset.z << std::endl;
-                        break;
+        callbacks.on_update = [&]() {
+            uint32_t now = SDL_GetTicks();
+            float camera_step = camera_speed * fminf((now - last_update_ticks) / 1000.0f, camera_max_step);
+            last_update_ticks = now;
+            for (size_t i = 0; i < movement_actions.size(); i++) {
+                if (actions.is_active(movement_actions[i], kb)) {
+                    camera_offset.x += movements[i].dx * camera_step;
+                    camera_offset.z += movements[i].dz * camera_step;
                 }
             }
+            kb.end_frame();
+
+            y_rotation_angle = get_rotation_angle(y_rotation_period, y_angular_ratio);
+            z_rotation_angle = get_rotation_angle(z_rotation_period, z_angular_ratio);
+        };
+        callbacks.on_draw = [&]() {
+            streamer.pump();
 
             glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
             glClear(GL_COLOR_BUFFER_BIT);
 
-            float y_rotation_angle = get_rotation_angle(y_rotation_period, y_angular_ratio);
-            float z_rotation_angle = get_rotation_angle(z_rotation_period, z_angular_ratio);
-            float y_rotation_sin = sinf(y_rotation_angle);
-            float y_rotation_cos = cosf(y_rotation_angle);
-            float z_rotation_sin = sinf(z_rotation_angle);
-            float z_rotation_cos = cosf(z_rotation_angle);
-            const mat4 y_rotation_matrix = {
-                y_rotation_cos, 0, -y_rotation_sin, 0,
-                0, 1, 0, 0,
-                y_rotation_sin, 0, y_rotation_cos, 0,
-                0, 0, 0, 1,
-            };
-            const mat4 z_rotation_matrix = {
-                z_rotation_cos, z_rotation_sin, 0, 0,
-                -z_rotation_sin, z_rotation_cos, 0, 0,
-                0, 0, 1, 0,
-                0, 0, 0, 1,
-            };
-            glUniformMatrix4fv(y_rotation_matrix_uniform, 1, GL_FALSE, (const float*) &y_rotation_matrix);
-            glUniformMatrix4fv(z_rotation_matrix_uniform, 1, GL_FALSE, (const float*) &z_rotation_matrix);
-
-            glUniform4fv(camera_offset_uniform, 1, (const float*) &camera_offset);
-
-            glDrawArrays(GL_TRIANGLES, 0, vertex_count);
-
-            main_window.swap();
-        }
+            // Composed once per frame on the CPU instead of per vertex.
+            vec4 offset = object_offset + camera_offset;
+            mat4 mvp = perspective_matrix
+                * mat4_translation(offset.x, offset.y, offset.z)
+                * mat4_rotation_y(y_rotation_angle)
+                * mat4_rotation_z(z_rotation_angle);
+            mvp_uniform.set(mvp);
+
+            model->draw({0.0f, 0.0f, 0.0f});
+        };
+        e.run(main_window, callbacks);
 
         return 0;
     }
@@ -1,4 +1,3 @@
-#include <list>
 #include <memory>
 #include <vector>
 
@@ -8,8 +7,14 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_opengles2.h>
 
-#include "engine/shader.hpp"
+#include "engine/basic_shader.hpp"
+#include "engine/engine.hpp"
+#include "engine/gl_functions.hpp"
+#include "engine/gl_state.hpp"
+#include "engine/math.hpp"
 #include "engine/shader_program.hpp"
+#include "engine/shader_variants.hpp"
+#include "engine/uniform.hpp"
 #include "engine/vertex_buffer.hpp"
 #include "engine/window.hpp"
 #include "modules/rotated_square.hpp"
@@ -25,50 +30,6 @@ namespace rotated_square {
 #define Y_ANGULAR_RATIO M_PI * 2.0f / Y_ROTATION_PERIOD
 #define Z_ANGULAR_RATIO M_PI * 2.0f / Z_ROTATION_PERIOD
 
-    const char *vertex_shader_source = R"glsl(
-#version 100
-
-attribute vec4 position;
-attribute vec4 color;
-
-varying vec4 fragment_color;
-
-uniform float y_rotation_sin;
-uniform float y_rotation_cos;
-uniform float z_rotation_sin;
-uniform float z_rotation_cos;
-
-void main() {
-    fragment_color = color;
-
-    mat3 y_rotation = mat3(
-        vec3(y_rotation_cos, 0.0, -y_rotation_sin),
-        vec3(0.0, 1.0, 0.0),
-        vec3(y_rotation_sin, 0.0, y_rotation_cos)
-    );
-
-    mat3 z_rotation = mat3(
-        vec3(z_rotation_cos, z_rotation_sin, 0.0),
-        vec3(-z_rotation_sin, z_rotation_cos, 0.0),
-        vec3(0.0, 0.0, 1.0)
-    );
-
-    gl_Position = vec4(position.xyz * z_rotation * y_rotation, position.w);
-}
-)glsl";
-
-    const char *fragment_shader_source = R"glsl(
-#version 100
-
-precision mediump float;
-
-varying vec4 fragment_color;
-
-void main() {
-   gl_FragColor = fragment_color;
-}
-)glsl";
-
     float get_rotation_angle(float rotation_period, float angular_ratio) {
         float elapsed_time = SDL_GetTicks() / 1000.0f;
         float elapsed_period = fmodf(elapsed_time, rotation_period);
@@ -76,12 +37,11 @@ void main() {
     }
 
     int run(int argc, char **argv) {
+        engine e(argc, argv);
         window main_window;
 
-        std::list<shader> shaders;
-        shaders.emplace_back(GL_VERTEX_SHADER, vertex_shader_source);
-        shaders.emplace_back(GL_FRAGMENT_SHADER, fragment_shader_source);
-        shader_program main_program(shaders);
+        shader_variants shaders(basic_vertex_source, basic_fragment_source);
+        std::shared_ptr<shader_program> main_program = shaders.get(shaders.get_feature("MVP"));
 
         std::vector<float> square_vertex_vector {
             0.5f, 0.5f, 0.0f, 1.0f,
@@ -95,14 +55,14 @@ void main() {
         };
         vertex_buffer square_vertices(square_vertex_vector);
 
-        main_program.use();
+        main_program->use();
         square_vertices.bind();
-        uint32_t position_attrib = main_program.get_attrib_location("position");
-        glEnableVertexAttribArray(position_attrib);
-        glVertexAttribPointer(position_attrib, VERTEX_DEPTH, GL_FLOAT, GL_FALSE, 0, 0);
-        uint32_t color_attrib = main_program.get_attrib_location("color");
-        glEnableVertexAttribArray(color_attrib);
-        glVertexAttribPointer(
+        uint32_t position_attrib = main_program->get_attrib_location("position");
+        get_gl_state().enable_vertex_attrib(position_attrib);
+        get_gl_state().vertex_attrib_pointer(position_attrib, VERTEX_DEPTH, GL_FLOAT, GL_FALSE, 0, 0);
+        uint32_t color_attrib = main_program->get_attrib_location("color");
+        get_gl_state().enable_vertex_attrib(color_attrib);
+        get_gl_state().vertex_attrib_pointer(
                 color_attrib,
                 VERTEX_DEPTH,
                 GL_FLOAT,
@@ -110,34 +70,27 @@ void main() {
                 0,
                 (GLvoid*) (sizeof(float) * VERTEX_DEPTH * VERTEX_COUNT));
 
-        uint32_t y_rotation_sin_uniform = main_program.get_uniform_location("y_rotation_sin");
-        uint32_t y_rotation_cos_uniform = main_program.get_uniform_location("y_rotation_cos");
-        uint32_t z_rotation_sin_uniform = main_program.get_uniform_location("z_rotation_sin");
-        uint32_t z_rotation_cos_uniform = main_program.get_uniform_location("z_rotation_cos");
+        uniform<mat4> mvp_uniform(*main_program, "mvp");
+
+        float y_rotation_angle = 0.0f;
+        float z_rotation_angle = 0.0f;
 
-        SDL_Event event;
-        bool done = false;
-        while (!done) {
+        frame_callbacks callbacks;
+        callbacks.on_update = [&]() {
+            y_rotation_angle = get_rotation_angle(Y_ROTATION_PERIOD, Y_ANGULAR_RATIO);
+            z_rotation_angle = get_rotation_angle(Z_ROTATION_PERIOD, Z_ANGULAR_RATIO);
+        };
+        callbacks.on_draw = [&]() {
             glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
             glClear(GL_COLOR_BUFFER_BIT);
 
-            float y_rotation_angle = get_rotation_angle(Y_ROTATION_PERIOD, Y_ANGULAR_RATIO);
-            float z_rotation_angle = get_rotation_angle(Z_ROTATION_PERIOD, Z_ANGULAR_RATIO);
-            glUniform1f(y_rotation_sin_uniform, sinf(y_rotation_angle));
-            glUniform1f(y_rotation_cos_uniform, cosf(y_rotation_angle));
-            glUniform1f(z_rotation_sin_uniform, sinf(z_rotation_angle));
-            glUniform1f(z_rotation_cos_uniform, cosf(z_rotation_angle));
+            // Negated angles keep the old row-vector rotation direction.
+            mat4 mvp = mat4_rotation_y(-y_rotation_angle) * mat4_rotation_z(-z_rotation_angle);
+            mvp_uniform.set(mvp);
 
             glDrawArrays(GL_TRIANGLE_FAN, 0, VERTEX_COUNT);
-
-            main_window.swap();
-
-            while (SDL_PollEvent(&event)) {
-                if (event.type == SDL_QUIT) {
-                    done = true;
-                }
-            }
-        }
+        };
+        e.run(main_window, callbacks);
 
         return 0;
     }
@@ -0,0 +1,210 @@
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/basic_shader.hpp"
+#include "engine/drawable.hpp"
+#include "engine/engine.hpp"
+#include "engine/gl_functions.hpp"
+#include "engine/image.hpp"
+#include "engine/math.hpp"
+#include "engine/shader_program.hpp"
+#include "engine/shader_variants.hpp"
+#include "engine/texture.hpp"
+#include "engine/texture_atlas.hpp"
+#include "engine/uniform.hpp"
+#include "engine/vertex_layout.hpp"
+#include "engine/window.hpp"
+#include "modules/sprite_atlas.hpp"
+
+namespace sprite_atlas {
+    const std::string module_name("sprite_atlas");
+
+    const int vertex_count = 4;
+    const int image_variants = 64;
+    const float field_extent = 1.8f;
+    const float bob_speed = 0.002f;
+
+    uint8_t to_channel(float value) {
+        return 255 * fmaxf(0.0f, fminf(1.0f, value));
+    }
+
+    // Discs, rings and checkered discs in a spread of sizes and colours,
+    // transparent outside the disc.
+    image make_sprite_image(int variant) {
+        const int size = 8 + (variant * 7) % 41;
+        image result = make_image(size, size, 4);
+        const float hue = (float) variant / image_variants * 6.0f;
+        const uint8_t r = to_channel(fabsf(hue - 3.0f) - 1.0f);
+        const uint8_t g = to_channel(2.0f - fabsf(hue - 2.0f));
+        const uint8_t b = to_channel(2.0f - fabsf(hue - 4.0f));
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                float dx = (x + 0.5f) / size * 2.0f - 1.0f;
+                float dy = (y + 0.5f) / size * 2.0f - 1.0f;
+                float distance = sqrtf(dx * dx + dy * dy);
+                bool inside = distance <= 1.0f;
+                if (variant % 3 == 1) {
+                    inside = inside && distance >= 0.6f;
+                } else if (variant % 3 == 2) {
+                    inside = inside && ((x * 4 / size + y * 4 / size) % 2 == 0);
+                }
+                uint8_t *pixel = &result.pixels[(y * size + x) * 4];
+                pixel[0] = r;
+                pixel[1] = g;
+                pixel[2] = b;
+                pixel[3] = inside ? 255 : 0;
+            }
+        }
+        return result;
+    }
+
+    void print_texture_report(texture_atlas *atlas, const std::vector<std::unique_ptr<texture>> &textures) {
+        std::cout << std::fixed << std::setprecision(1);
+        if (atlas != NULL) {
+            for (int page = 0; page < atlas->get_page_count(); page++) {
+                const texture &page_texture = atlas->get_texture(page);
+                std::cout << "atlas page " << page << ": " << page_texture.get_width() << "x" << page_texture.get_height()
+                    << ", " << atlas->get_occupancy(page) * 100.0f << "% used, "
+                    << atlas->get_memory_bytes(page) / 1024.0 << " KB in " << page_texture.get_level_count() << " levels, "
+                    << "uploaded in " << std::setprecision(3) << atlas->get_upload_ms(page) << std::setprecision(1) << " ms"
+                    << std::endl;
+            }
+        } else {
+            double upload_ms = 0.0;
+            for (const auto &t : textures) {
+                upload_ms += t->get_upload_ms();
+            }
+            std::cout << "textures: " << textures.size() << " separate, uploaded in " << std::setprecision(3) << upload_ms
+                << std::setprecision(1) << " ms" << std::endl;
+        }
+        std::cout << "texture memory: " << get_texture_memory() / 1024.0 << " KB" << std::endl;
+    }
+
+    int run(int argc, char **argv) {
+        int sprite_count = 1000;
+        bool use_atlas = true;
+        int page_size = 256;
+        mipmap_mode mipmaps = mipmap_mode::automatic;
+        for (int i = 2; i < argc; i++) {
+            std::string arg(argv[i]);
+            if (arg == "--count" && i + 1 < argc) {
+                sprite_count = atoi(argv[++i]);
+                if (sprite_count < 1) {
+                    throw std::runtime_error("invalid --count value \"" + std::string(argv[i]) + "\"");
+                }
+            } else if (arg == "--atlas" && i + 1 < argc) {
+                use_atlas = std::string(argv[++i]) != "off";
+            } else if (arg == "--page-size" && i + 1 < argc) {
+                page_size = atoi(argv[++i]);
+                if (page_size < 64) {
+                    throw std::runtime_error("invalid --page-size value \"" + std::string(argv[i]) + "\"");
+                }
+            } else if (arg == "--mipmaps" && i + 1 < argc) {
+                mipmaps = parse_mipmap_mode(argv[++i]);
+            }
+        }
+
+        engine e(argc, argv);
+        window main_window;
+
+        shader_variants shaders(basic_vertex_source, basic_fragment_source);
+        std::shared_ptr<shader_program> main_program = shaders.get(shaders.get_feature("OFFSET") | shaders.get_feature("TEXTURE"));
+        uniform<GLint> sprite_sampler(*main_program, "color_texture");
+
+        // With the atlas every sprite samples one of a few pages; without
+        // it every image is its own texture and each draw rebinds.
+        std::unique_ptr<texture_atlas> atlas;
+        std::vector<std::unique_ptr<texture>> textures;
+        std::vector<atlas_region> regions;
+        if (use_atlas) {
+            atlas.reset(new texture_atlas(page_size, 2, mipmaps));
+        }
+        for (int v = 0; v < image_variants; v++) {
+            image sprite_image = make_sprite_image(v);
+            if (use_atlas) {
+                regions.push_back(atlas->add(sprite_image));
+            } else {
+                textures.emplace_back(new texture(sprite_image, mipmaps));
+                regions.push_back({0, 0, 0, sprite_image.width, sprite_image.height, {0.0f, 0.0f}, {1.0f, 1.0f}});
+            }
+        }
+        if (use_atlas) {
+            atlas->upload();
+        }
+        print_texture_report(atlas.get(), textures);
+
+        vertex_layout sprite_layout;
+        sprite_layout.append("position", 2, GL_FLOAT, GL_FALSE);
+        sprite_layout.append("color", 4, GL_UNSIGNED_BYTE, GL_TRUE);
+        sprite_layout.append("texcoord", 2, GL_FLOAT, GL_FALSE);
+
+        const int side = (int) ceilf(sqrtf(sprite_count));
+        const float cell = field_extent / side;
+        std::vector<std::unique_ptr<drawable>> sprites;
+        std::vector<texture*> sprite_textures;
+        std::vector<vec3> sprite_offsets(sprite_count, vec3{0.0f, 0.0f, 0.0f});
+        for (int i = 0; i < sprite_count; i++) {
+            const int variant = i % image_variants;
+            const atlas_region &region = regions[variant];
+            const float x = -field_extent / 2 + cell * (i % side + 0.5f);
+            const float y = -field_extent / 2 + cell * (i / side + 0.5f);
+            const float half = cell * (0.25f + 0.25f * region.width / 48.0f);
+            std::vector<float> sprite_positions {
+                x + half, y + half,
+                x - half, y + half,
+                x - half, y - half,
+                x + half, y - half
+            };
+            std::vector<float> sprite_colors(vertex_count * 4, 1.0f);
+            std::vector<float> sprite_texcoords {
+                region.uv_max.x, region.uv_min.y,
+                region.uv_min.x, region.uv_min.y,
+                region.uv_min.x, region.uv_max.y,
+                region.uv_max.x, region.uv_max.y
+            };
+            sprites.emplace_back(new drawable(
+                    sprite_layout.pack({sprite_positions, sprite_colors, sprite_texcoords}, vertex_count),
+                    sprite_layout, vertex_count, *main_program));
+            sprite_textures.push_back(use_atlas ? &atlas->get_texture(region.page) : textures[variant].get());
+        }
+
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        main_program->use();
+        sprite_sampler.set(0);
+
+        frame_callbacks callbacks;
+        callbacks.on_update = [&]() {
+            float elapsed_time = SDL_GetTicks() / 1000.0f;
+            for (size_t i = 0; i < sprites.size(); i++) {
+                sprite_offsets[i].y += bob_speed * cosf(elapsed_time * 2.0f + i * 0.1f);
+            }
+        };
+        callbacks.on_draw = [&]() {
+            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            // Binds to the texture that is already bound are elided by
+            // gl_state, so sprites sharing a page cost no texture switches.
+            for (size_t i = 0; i < sprites.size(); i++) {
+                sprite_textures[i]->bind();
+                sprites[i]->draw(sprite_offsets[i]);
+            }
+        };
+        e.run(main_window, callbacks);
+
+        return 0;
+    }
+}
@@ -0,0 +1,11 @@
+#ifndef SPRITE_ATLAS_HPP_
+#define SPRITE_ATLAS_HPP_
+
+#include <string>
+
+namespace sprite_atlas {
+    extern const std::string module_name;
+    int run(int argc, char **argv);
+}
+
+#endif // SPRITE_ATLAS_HPP_
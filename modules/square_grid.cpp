@@ -0,0 +1,140 @@
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_opengles2.h>
+
+#include "engine/basic_shader.hpp"
+#include "engine/buffer_arena.hpp"
+#include "engine/drawable.hpp"
+#include "engine/drawable_store.hpp"
+#include "engine/engine.hpp"
+#include "engine/frustum.hpp"
+#include "engine/gl_functions.hpp"
+#include "engine/job_system.hpp"
+#include "engine/math.hpp"
+#include "engine/scene.hpp"
+#include "engine/shader_program.hpp"
+#include "engine/shader_variants.hpp"
+#include "engine/vertex_layout.hpp"
+#include "engine/window.hpp"
+#include "modules/square_grid.hpp"
+
+namespace square_grid {
+    const std::string module_name("square_grid");
+
+    const int vertex_count = 4;
+    const float grid_extent = 1.8f;
+    const float wobble_speed = 0.002f;
+    const size_t update_grain = 4096;
+
+    int run(int argc, char **argv) {
+        int square_count = 1000;
+        bool batching = true;
+        bool use_arena = true;
+        bool culling = true;
+        float spread = 1.0f;
+        for (int i = 2; i < argc; i++) {
+            std::string arg(argv[i]);
+            if (arg == "--count" && i + 1 < argc) {
+                square_count = atoi(argv[++i]);
+                if (square_count < 1) {
+                    throw std::runtime_error("invalid --count value \"" + std::string(argv[i]) + "\"");
+                }
+            } else if (arg == "--batch" && i + 1 < argc) {
+                batching = std::string(argv[++i]) != "off";
+            } else if (arg == "--arena" && i + 1 < argc) {
+                use_arena = std::string(argv[++i]) != "off";
+            } else if (arg == "--cull" && i + 1 < argc) {
+                culling = std::string(argv[++i]) != "off";
+            } else if (arg == "--spread" && i + 1 < argc) {
+                spread = atof(argv[++i]);
+                if (spread <= 0.0f) {
+                    throw std::runtime_error("invalid --spread value \"" + std::string(argv[i]) + "\"");
+                }
+            }
+        }
+
+        engine e(argc, argv);
+        window main_window;
+
+        shader_variants shaders(basic_vertex_source, basic_fragment_source);
+        std::shared_ptr<shader_program> main_program = shaders.get(shaders.get_feature("OFFSET"));
+
+        const int side = (int) ceilf(sqrtf(square_count));
+        const float extent = grid_extent * spread;
+        const float cell = extent / side;
+        const float half = cell * 0.4f;
+
+        // One shared vertex buffer for all squares rather than one each.
+        buffer_arena arena(GL_ARRAY_BUFFER, 1 << 20);
+
+        vertex_layout square_layout;
+        square_layout.append("position", 2, GL_SHORT, GL_TRUE);
+        square_layout.append("color", 4, GL_UNSIGNED_BYTE, GL_TRUE);
+
+        scene squares(main_program);
+        drawable_store &drawables = squares.get_drawables();
+        drawables.reserve(square_count);
+        for (int i = 0; i < square_count; i++) {
+            float x = -extent / 2 + cell * (i % side + 0.5f);
+            float y = -extent / 2 + cell * (i / side + 0.5f);
+            float r = (float) (i % side) / side;
+            float g = (float) (i / side) / side;
+            std::vector<float> square_positions {
+                half, half,
+                -half, half,
+                -half, -half,
+                half, -half
+            };
+            std::vector<float> square_colors {
+                r, g, 1.0f, 1.0f,
+                r, g, 1.0f, 1.0f,
+                r, g, 1.0f, 1.0f,
+                r, g, 1.0f, 1.0f
+            };
+            std::vector<uint8_t> square_vertices = square_layout.pack({square_positions, square_colors}, vertex_count);
+            if (use_arena) {
+                drawables.add(std::make_unique<drawable>(
+                        square_vertices, square_layout, vertex_count, std::vector<uint16_t>(), *main_program, arena), {x, y, 0});
+            } else {
+                drawables.add(std::make_unique<drawable>(
+                        square_vertices, square_layout, vertex_count, *main_program), {x, y, 0});
+            }
+        }
+        squares.set_batching(batching);
+        if (batching) {
+            squares.set_batch_program(shaders.get(0));
+        }
+        if (culling) {
+            // The squares are positioned directly in clip space.
+            squares.set_frustum(frustum_from_matrix(mat4_identity()));
+        }
+
+        frame_callbacks callbacks;
+        callbacks.on_update = [&]() {
+            float elapsed_time = SDL_GetTicks() / 1000.0f;
+            float *offset_y = drawables.get_offset_y();
+            get_job_system().parallel_for(drawables.size(), update_grain, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    offset_y[i] += wobble_speed * cosf(elapsed_time * 2.0f + i * 0.1f);
+                }
+            });
+        };
+        callbacks.on_draw = [&]() {
+            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            squares.draw();
+        };
+        e.run(main_window, callbacks);
+
+        return 0;
+    }
+}
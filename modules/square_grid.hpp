@@ -0,0 +1,11 @@
+#ifndef SQUARE_GRID_HPP_
+#define SQUARE_GRID_HPP_
+
+#include <string>
+
+namespace square_grid {
+    extern const std::string module_name;
+    int run(int argc, char **argv);
+}
+
+#endif // SQUARE_GRID_HPP_
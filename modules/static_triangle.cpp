@@ -1,4 +1,3 @@
-#include <list>
 #include <memory>
 #include <vector>
 
@@ -7,9 +6,12 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_opengles2.h>
 
+#include "engine/basic_shader.hpp"
 #include "engine/engine.hpp"
-#include "engine/shader.hpp"
+#include "engine/gl_functions.hpp"
+#include "engine/gl_state.hpp"
 #include "engine/shader_program.hpp"
+#include "engine/shader_variants.hpp"
 #include "engine/vertex_buffer.hpp"
 #include "engine/window.hpp"
 #include "modules/static_triangle.hpp"
@@ -17,42 +19,14 @@
 namespace static_triangle {
     const std::string module_name("static_triangle");
 
-    const char *vertex_shader_source = R"glsl(
-#version 100
-
-attribute vec4 position;
-attribute vec4 color;
-
-varying vec4 fragment_color;
-
-void main() {
-    fragment_color = color;
-    gl_Position = position;
-}
-)glsl";
-
-    const char *fragment_shader_source = R"glsl(
-#version 100
-
-precision mediump float;
-
-varying vec4 fragment_color;
-
-void main() {
-   gl_FragColor = fragment_color;
-}
-)glsl";
-
     const int vertex_depth = 4;
 
     int run(int argc, char **argv) {
-        engine e;
+        engine e(argc, argv);
         window main_window;
 
-        std::list<shader> shaders;
-        shaders.emplace_back(GL_VERTEX_SHADER, vertex_shader_source);
-        shaders.emplace_back(GL_FRAGMENT_SHADER, fragment_shader_source);
-        shader_program main_program(shaders);
+        shader_variants shaders(basic_vertex_source, basic_fragment_source);
+        std::shared_ptr<shader_program> main_program = shaders.get(0);
 
         std::vector<float> triangle_vertex_vector {
             0.0f, 0.5f, 0.0f, 1.0f,
@@ -65,14 +39,14 @@ void main() {
         const int vertex_count = triangle_vertex_vector.size() / vertex_depth / 2;
         vertex_buffer triangle_vertices(triangle_vertex_vector);
 
-        main_program.use();
+        main_program->use();
         triangle_vertices.bind();
-        uint32_t position_attrib = main_program.get_attrib_location("position");
-        glEnableVertexAttribArray(position_attrib);
-        glVertexAttribPointer(position_attrib, vertex_depth, GL_FLOAT, GL_FALSE, 0, 0);
-        uint32_t color_attrib = main_program.get_attrib_location("color");
-        glEnableVertexAttribArray(color_attrib);
-        glVertexAttribPointer(
+        uint32_t position_attrib = main_program->get_attrib_location("position");
+        get_gl_state().enable_vertex_attrib(position_attrib);
+        get_gl_state().vertex_attrib_pointer(position_attrib, vertex_depth, GL_FLOAT, GL_FALSE, 0, 0);
+        uint32_t color_attrib = main_program->get_attrib_location("color");
+        get_gl_state().enable_vertex_attrib(color_attrib);
+        get_gl_state().vertex_attrib_pointer(
                 color_attrib,
                 vertex_depth,
                 GL_FLOAT,
@@ -80,22 +54,14 @@ void main() {
                 0,
                 (GLvoid*) (sizeof(float) * vertex_depth * vertex_count));
 
-        SDL_Event event;
-        bool done = false;
-        while (!done) {
+        frame_callbacks callbacks;
+        callbacks.on_draw = [&]() {
             glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
             glClear(GL_COLOR_BUFFER_BIT);
 
             glDrawArrays(GL_TRIANGLES, 0, vertex_count);
-
-            main_window.swap();
-
-            while (SDL_PollEvent(&event)) {
-                if (event.type == SDL_QUIT) {
-                    done = true;
-                }
-            }
-        }
+        };
+        e.run(main_window, callbacks);
 
         return 0;
     }
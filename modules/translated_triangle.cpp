@@ -1,4 +1,3 @@
-#include <list>
 #include <memory>
 #include <vector>
 
@@ -8,9 +7,14 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_opengles2.h>
 
+#include "engine/basic_shader.hpp"
 #include "engine/engine.hpp"
-#include "engine/shader.hpp"
+#include "engine/gl_functions.hpp"
+#include "engine/gl_state.hpp"
+#include "engine/math.hpp"
 #include "engine/shader_program.hpp"
+#include "engine/shader_variants.hpp"
+#include "engine/uniform.hpp"
 #include "engine/vertex_buffer.hpp"
 #include "engine/window.hpp"
 #include "modules/translated_triangle.hpp"
@@ -18,45 +22,12 @@
 namespace translated_triangle {
     const std::string module_name("translated_triangle");
 
-    struct vec2 {
-        float x;
-        float y;
-    };
-
-    const char *vertex_shader_source = R"glsl(
-#version 100
-
-attribute vec4 position;
-attribute vec4 color;
-
-varying vec4 fragment_color;
-
-uniform vec2 offset;
-
-void main() {
-    fragment_color = color;
-    gl_Position = position + vec4(offset.xy, 0.0, 0.0);
-}
-)glsl";
-
-    const char *fragment_shader_source = R"glsl(
-#version 100
-
-precision mediump float;
-
-varying vec4 fragment_color;
-
-void main() {
-   gl_FragColor = fragment_color;
-}
-)glsl";
-
     const int vertex_depth = 4;
     const float cirle_period = 10.0f;
     const float cirle_radius = 0.7f;
     const float angular_ratio = M_PI * 2.0f / cirle_period;
 
-    void get_circular_offsets(vec2 *offsets) {
+    void get_circular_offsets(vec3 *offsets) {
         float elapsed_time = SDL_GetTicks() / 1000.0f;
         float elapsed_period = fmodf(elapsed_time, cirle_period);
         float angle = angular_ratio * elapsed_period;
@@ -65,13 +36,11 @@ void main() {
     }
 
     int run(int argc, char **argv) {
-        engine e;
+        engine e(argc, argv);
         window main_window;
 
-        std::list<shader> shaders;
-        shaders.emplace_back(GL_VERTEX_SHADER, vertex_shader_source);
-        shaders.emplace_back(GL_FRAGMENT_SHADER, fragment_shader_source);
-        shader_program main_program(shaders);
+        shader_variants shaders(basic_vertex_source, basic_fragment_source);
+        std::shared_ptr<shader_program> main_program = shaders.get(shaders.get_feature("OFFSET"));
 
         std::vector<float> triangle_vertex_vector {
             0.0f, 0.5f, 0.0f, 1.0f,
@@ -84,14 +53,14 @@ void main() {
         const int vertex_count = triangle_vertex_vector.size() / vertex_depth / 2;
         vertex_buffer triangle_vertices(triangle_vertex_vector);
 
-        main_program.use();
+        main_program->use();
         triangle_vertices.bind();
-        uint32_t position_attrib = main_program.get_attrib_location("position");
-        glEnableVertexAttribArray(position_attrib);
-        glVertexAttribPointer(position_attrib, vertex_depth, GL_FLOAT, GL_FALSE, 0, 0);
-        uint32_t color_attrib = main_program.get_attrib_location("color");
-        glEnableVertexAttribArray(color_attrib);
-        glVertexAttribPointer(
+        uint32_t position_attrib = main_program->get_attrib_location("position");
+        get_gl_state().enable_vertex_attrib(position_attrib);
+        get_gl_state().vertex_attrib_pointer(position_attrib, vertex_depth, GL_FLOAT, GL_FALSE, 0, 0);
+        uint32_t color_attrib = main_program->get_attrib_location("color");
+        get_gl_state().enable_vertex_attrib(color_attrib);
+        get_gl_state().vertex_attrib_pointer(
                 color_attrib,
                 vertex_depth,
                 GL_FLOAT,
@@ -99,28 +68,21 @@ void main() {
                 0,
                 (GLvoid*) (sizeof(float) * vertex_depth * vertex_count));
 
-        uint32_t offset_uniform = main_program.get_uniform_location("offset");
-        vec2 offsets;
+        uniform<vec3> offset_uniform(*main_program, "offset");
+        vec3 offsets = {0.0f, 0.0f, 0.0f};
 
-        SDL_Event event;
-        bool done = false;
-        while (!done) {
+        frame_callbacks callbacks;
+        callbacks.on_update = [&]() {
+            get_circular_offsets(&offsets);
+        };
+        callbacks.on_draw = [&]() {
             glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
             glClear(GL_COLOR_BUFFER_BIT);
 
-            get_circular_offsets(&offsets);
-            glUniform2f(offset_uniform, offsets.x, offsets.y);
-
+            offset_uniform.set(offsets);
             glDrawArrays(GL_TRIANGLES, 0, vertex_count);
-
-            main_window.swap();
-
-            while (SDL_PollEvent(&event)) {
-                if (event.type == SDL_QUIT) {
-                    done = true;
-                }
-            }
-        }
+        };
+        e.run(main_window, callbacks);
 
         return 0;
     }
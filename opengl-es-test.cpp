@@ -1,13 +1,31 @@
+#include <exception>
+#include <fstream>
 #include <functional>
 #include <iostream>
 #include <string>
 #include <map>
 
+#include <stdlib.h>
+
+#include <SDL2/SDL.h>
+
+#include "benchmarks/arena_bench.hpp"
+#include "benchmarks/drawable_bench.hpp"
+#include "benchmarks/math_bench.hpp"
+#include "benchmarks/mesh_bench.hpp"
+#include "benchmarks/stream_bench.hpp"
+#include "benchmarks/texture_bench.hpp"
+#include "engine/bench.hpp"
+#include "engine/frame_stats.hpp"
+#include "engine/gl_trace.hpp"
+#include "engine/program_cache.hpp"
 #include "modules/movable_square.hpp"
 #include "modules/movable_squares.hpp"
 #include "modules/perspective_cube.hpp"
 #include "modules/perspective_square.hpp"
 #include "modules/rotated_square.hpp"
+#include "modules/sprite_atlas.hpp"
+#include "modules/square_grid.hpp"
 #include "modules/static_triangle.hpp"
 #include "modules/translated_triangle.hpp"
 
@@ -21,6 +39,116 @@ std::string format_module_names(const str_to_func_map &function_map) {
     return module_names;
 }
 
+bool parse_count(const char *str, int *count) {
+    char *end;
+    long value = strtol(str, &end, 10);
+    if (*str == '\0' || *end != '\0' || value < 0 || value > 100000000) {
+        return false;
+    }
+    *count = value;
+    return true;
+}
+
+// Options shared by plain and bench runs; unknown arguments are left for
+// the module to interpret.
+void apply_common_options(int argc, char **argv) {
+    for (int i = 2; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == "--frame-stats" && i + 1 < argc) {
+            get_frame_stats().set_dump_path(argv[++i]);
+        } else if (arg == "--gl-trace" && i + 1 < argc) {
+            get_gl_tracer().set_dump_path(argv[++i]);
+            get_gl_tracer().set_enabled(true);
+        }
+    }
+}
+
+int dump_stats() {
+    try {
+        get_frame_stats().dump();
+        get_gl_tracer().dump();
+    } catch (const std::exception &e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int run_bench(const str_to_func_map &function_map, const str_to_func_map &benchmark_map, int argc, char **argv) {
+    if (argc < 3) {
+        std::cerr << "error: bench needs a module or benchmark name" << std::endl;
+        return 2;
+    }
+
+    auto bench_func = benchmark_map.find(argv[2]);
+    auto module_func = function_map.find(argv[2]);
+    if (bench_func == benchmark_map.end() && module_func == function_map.end()) {
+        std::cerr << "error: couldn't find module or benchmark " << argv[2] << std::endl;
+        return 2;
+    }
+
+    int frames = 300;
+    int warmup = 30;
+    bool headless = true;
+    std::string json_path;
+    for (int i = 3; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == "--frames" && i + 1 < argc) {
+            if (!parse_count(argv[++i], &frames) || frames == 0) {
+                std::cerr << "error: invalid frame count " << argv[i] << std::endl;
+                return 2;
+            }
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            if (!parse_count(argv[++i], &warmup)) {
+                std::cerr << "error: invalid warmup count " << argv[i] << std::endl;
+                return 2;
+            }
+        } else if (arg == "--json" && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (arg == "--windowed") {
+            headless = false;
+        } else if (arg == "--cold") {
+            get_program_cache().set_read_enabled(false);
+        }
+    }
+
+    // Render offscreen through Mesa's software rasterizer unless the
+    // caller already picked a video driver, so the bench runs in CI.
+    if (headless && getenv("SDL_VIDEODRIVER") == NULL) {
+        SDL_setenv("SDL_VIDEODRIVER", "offscreen", 1);
+        SDL_setenv("LIBGL_ALWAYS_SOFTWARE", "1", 0);
+    }
+
+    // Micro-benchmarks parse their own options and print their own report.
+    if (bench_func != benchmark_map.end()) {
+        return bench_func->second(argc - 1, argv + 1);
+    }
+
+    apply_common_options(argc - 1, argv + 1);
+    bench::configure(frames, warmup);
+    int status = module_func->second(argc - 1, argv + 1);
+    if (status != 0) {
+        return status;
+    }
+    if (dump_stats() != 0) {
+        return 1;
+    }
+
+    bench::write_text_report(module_func->first, std::cout);
+    if (json_path.empty()) {
+        bench::write_json_report(module_func->first, std::cout);
+    } else {
+        std::ofstream json_file(json_path);
+        if (!json_file) {
+            std::cerr << "error: couldn't open " << json_path << std::endl;
+            return 1;
+        }
+        bench::write_json_report(module_func->first, json_file);
+    }
+
+    return 0;
+}
+
 int main(int argc, char **argv) {
     str_to_func_map function_map = {
         {movable_square::module_name, movable_square::run},
@@ -28,19 +156,39 @@ int main(int argc, char **argv) {
         {perspective_cube::module_name, perspective_cube::run},
         {perspective_square::module_name, perspective_square::run},
         {rotated_square::module_name, rotated_square::run},
+        {sprite_atlas::module_name, sprite_atlas::run},
+        {square_grid::module_name, square_grid::run},
         {static_triangle::module_name, static_triangle::run},
         {translated_triangle::module_name, translated_triangle::run},
     };
 
+    str_to_func_map benchmark_map = {
+        {arena_bench::bench_name, arena_bench::run},
+        {drawable_bench::bench_name, drawable_bench::run},
+        {math_bench::bench_name, math_bench::run},
+        {mesh_bench::bench_name, mesh_bench::run},
+        {stream_bench::bench_name, stream_bench::run},
+        {texture_bench::bench_name, texture_bench::run},
+    };
+
     std::string help_short_opt("-h");
     std::string help_long_opt("--help");
     if (argc < 2 || argv[1] == help_short_opt || argv[1] == help_long_opt) {
-        std::cout << "usage: " << argv[0] << " <module-name> [args]" << std::endl;
+        std::cout << "usage: " << argv[0] << " <module-name> [--frame-stats FILE.{csv,json}] [--gl-trace FILE[.json]] [args]" << std::endl;
+        std::cout << "       " << argv[0]
+            << " bench <module-name> [--frames N] [--warmup M] [--json FILE] [--windowed] [--cold]" << std::endl;
+        std::cout << "       " << argv[0] << " bench <benchmark-name> [args]" << std::endl;
         std::cout << "available modules:" << std::endl;
         std::cout << format_module_names(function_map);
+        std::cout << "available benchmarks:" << std::endl;
+        std::cout << format_module_names(benchmark_map);
         return 0;
     }
 
+    if (argv[1] == std::string("bench")) {
+        return run_bench(function_map, benchmark_map, argc, argv);
+    }
+
     auto module_func = function_map.find(argv[1]);
 
     if (module_func == function_map.end()) {
@@ -48,5 +196,10 @@ int main(int argc, char **argv) {
         return 2;
     }
 
-    return module_func->second(argc, argv);
+    apply_common_options(argc, argv);
+    int status = module_func->second(argc, argv);
+    if (status != 0) {
+        return status;
+    }
+    return dump_stats();
 }
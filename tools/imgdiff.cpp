@@ -0,0 +1,95 @@
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include <stdlib.h>
+
+#include "engine/image.hpp"
+#include "engine/image_diff.hpp"
+#include "engine/image_file.hpp"
+#include "utils/utils.hpp"
+
+bool parse_number(const char *text, double &value) {
+    char *end;
+    value = strtod(text, &end);
+    return *end == '\0' && value >= 0.0;
+}
+
+bool parse_tolerance(const char *text, int &value) {
+    char *end;
+    long parsed = strtol(text, &end, 10);
+    value = parsed;
+    return end != text && *end == '\0' && parsed >= 0 && parsed <= 255;
+}
+
+// Compares a captured frame against a golden image. Exits with 0 when no
+// more pixels differ by more than the per-channel tolerance than each
+// given limit allows (none at all without limits), 1 when more do and 2 on
+// bad usage or unreadable files, so regression scripts can tell a failure
+// from a broken run.
+int main(int argc, char **argv) {
+    std::string paths[2];
+    std::string diff_path;
+    int tolerance = 0;
+    double max_pixels = 0.0;
+    double max_percent = 0.0;
+    bool have_max_pixels = false;
+    bool have_max_percent = false;
+    bool valid = true;
+    int path_count = 0;
+    for (int i = 1; i < argc && valid; i++) {
+        std::string arg(argv[i]);
+        if (arg == "--tolerance" && i + 1 < argc) {
+            valid = parse_tolerance(argv[++i], tolerance);
+        } else if (arg == "--max-pixels" && i + 1 < argc) {
+            valid = parse_number(argv[++i], max_pixels);
+            have_max_pixels = true;
+        } else if (arg == "--max-percent" && i + 1 < argc) {
+            valid = parse_number(argv[++i], max_percent);
+            have_max_percent = true;
+        } else if (arg == "--diff" && i + 1 < argc) {
+            diff_path = argv[++i];
+        } else if (path_count < 2 && arg.compare(0, 2, "--") != 0) {
+            paths[path_count++] = arg;
+        } else {
+            valid = false;
+        }
+    }
+    if (!valid || path_count != 2) {
+        std::cerr << "usage: " << argv[0]
+            << " A B [--tolerance 0-255] [--max-pixels N] [--max-percent P] [--diff OUTPUT.png|ppm]" << std::endl;
+        return 2;
+    }
+
+    try {
+        // Grey and RGB files compare against RGBA captures with opaque
+        // alpha, and take the vector path.
+        image a = convert_to_rgba(read_image_file(paths[0]));
+        image b = convert_to_rgba(read_image_file(paths[1]));
+        image_difference difference = compare_images(a, b, tolerance);
+
+        size_t pixel_count = (size_t) a.width * a.height;
+        double percent = pixel_count > 0 ? 100.0 * difference.differing_pixels / pixel_count : 0.0;
+        bool passed;
+        if (have_max_pixels || have_max_percent) {
+            passed = (!have_max_pixels || difference.differing_pixels <= max_pixels)
+                && (!have_max_percent || percent <= max_percent);
+        } else {
+            passed = difference.differing_pixels == 0;
+        }
+        std::cout << paths[1] << ": " << difference.differing_pixels << " of " << pixel_count
+            << " pixels (" << percent << "%) differ by more than " << tolerance
+            << ", max difference " << difference.max_difference
+            << (passed ? ", within limits" : ", over limits") << std::endl;
+
+        if (!diff_path.empty()) {
+            bool ppm = has_suffix(diff_path, ".ppm");
+            write_image_file(diff_path, make_difference_image(a, b, tolerance),
+                ppm ? image_file_format::ppm : image_file_format::png);
+        }
+        return passed ? 0 : 1;
+    } catch (const std::exception &e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 2;
+    }
+}
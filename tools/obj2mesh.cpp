@@ -0,0 +1,48 @@
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include "engine/mesh_file.hpp"
+#include "engine/mesh_optimizer.hpp"
+#include "engine/obj_parser.hpp"
+
+// Converts a Wavefront OBJ file into the binary mesh format that
+// mapped_mesh loads, reordering the triangles and vertices for the
+// post-transform cache and fetch locality on the way.
+int main(int argc, char **argv) {
+    std::string input_path;
+    std::string output_path;
+    bool optimize = true;
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == "--no-optimize") {
+            optimize = false;
+        } else if (input_path.empty()) {
+            input_path = arg;
+        } else if (output_path.empty()) {
+            output_path = arg;
+        } else {
+            input_path.clear();
+            break;
+        }
+    }
+    if (input_path.empty() || output_path.empty()) {
+        std::cerr << "usage: " << argv[0] << " INPUT.obj OUTPUT.mesh [--no-optimize]" << std::endl;
+        return 2;
+    }
+
+    try {
+        obj_mesh mesh = parse_obj(input_path);
+        if (optimize) {
+            optimize_vertex_cache(mesh.indices, mesh.vertex_count);
+            mesh.vertex_count = optimize_vertex_fetch(mesh.vertices, mesh.layout.get_vertex_size(), mesh.indices);
+        }
+        write_mesh_file(output_path, mesh.layout, mesh.vertices, mesh.vertex_count, mesh.indices, mesh.bounds);
+        std::cout << output_path << ": " << mesh.vertex_count << " vertices, " << mesh.indices.size() / 3
+            << " triangles, " << (mesh.vertex_count <= 65536 ? 16 : 32) << "-bit indices" << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,7 +1,10 @@
 #ifndef UTILS_HPP_
 #define UTILS_HPP_
 
+#include <memory>
+#include <string>
+
 std::unique_ptr<std::string> get_file_contents(const char *filename);
-std::unique_ptr<std::string> get_gl_error_str(const char *function_name);
+bool has_suffix(const std::string &text, const std::string &suffix);
 
 #endif // UTILS_HPP_